@@ -1,5 +1,6 @@
 ﻿using UnityEngine;
 using UnityEngine.Events;
+using System.Runtime.InteropServices;
 
 namespace uWindowCapture
 {
@@ -56,6 +57,16 @@ public class UwcWindowTextureEvent : UnityEvent<UwcWindowTexture>
 {
 }
 
+[System.Serializable]
+[StructLayout(LayoutKind.Sequential, CharSet = CharSet.Unicode)]
+public struct WindowFilterPattern
+{
+    public WindowFilterTarget target;
+    public WindowFilterMode mode;
+    [MarshalAs(UnmanagedType.LPWStr)]
+    public string pattern;
+}
+
 public struct RayCastResult
 {
     public bool hit;
@@ -1,300 +1,523 @@
-﻿using UnityEngine;
-using System;
-using System.Runtime.InteropServices;
-
-#pragma warning disable 114, 465
-
-namespace uWindowCapture
-{
-
-public enum DebugMode
-{
-    None = 0,
-    File = 1,
-    UnityLog = 2, /* currently has bug when app exits. */
-}
-
-public enum CaptureMode
-{
-    None = -1,
-    PrintWindow = 0,
-    BitBlt = 1,
-    WindowsGraphicsCapture = 2,
-    Auto = 3,
-}
-
-public enum CapturePriority
-{
-    Auto = -1,
-    High = 0,
-    Middle = 1,
-    Low = 2,
-}
-
-public enum MessageType
-{
-    None = -1,
-    WindowAdded = 0,
-    WindowRemoved = 1,
-    WindowCaptured = 2,
-    WindowSizeChanged = 3,
-    IconCaptured = 4,
-    CursorCaptured = 5,
-    Error = 1000,
-    TextureNullError = 1001,
-    TextureSizeError = 1002,
-}
-
-[StructLayout(LayoutKind.Sequential)]
-public struct Message
-{
-    [MarshalAs(UnmanagedType.I4)]
-    public MessageType type;
-    [MarshalAs(UnmanagedType.I4)]
-    public int windowId;
-    [MarshalAs(UnmanagedType.I8)]
-    public IntPtr userData;
-}
-
-[StructLayout(LayoutKind.Sequential)]
-public struct Point
-{
-    [MarshalAs(UnmanagedType.I4)]
-    public int x;
-    [MarshalAs(UnmanagedType.I4)]
-    public int y;
-}
-
-public static class Lib
-{
-    public const string name = "uWindowCapture";
-
-    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
-    public delegate void DebugLogDelegate(string str);
-
-    [DllImport(name, EntryPoint = "UwcInitialize")]
-    public static extern void Initialize();
-    [DllImport(name, EntryPoint = "UwcFinalize")]
-    public static extern void Finalize();
-    [DllImport(name, EntryPoint = "UwcSetDebugMode")]
-    public static extern void SetDebugMode(DebugMode mode);
-    [DllImport(name, EntryPoint = "UwcSetLogFunc")]
-    public static extern void SetLogFunc(DebugLogDelegate func);
-    [DllImport(name, EntryPoint = "UwcSetErrorFunc")]
-    public static extern void SetErrorFunc(DebugLogDelegate func);
-    [DllImport(name, EntryPoint = "UwcGetRenderEventFunc")]
-    public static extern IntPtr GetRenderEventFunc();
-    [DllImport(name, EntryPoint = "UwcUpdate")]
-    public static extern void Update(float dt);
-    [DllImport(name, EntryPoint = "UwcGetMessageCount")]
-    private static extern int GetMessageCount();
-    [DllImport(name, EntryPoint = "UwcGetMessages")]
-    private static extern IntPtr GetMessages_Internal();
-    [DllImport(name, EntryPoint = "UwcClearMessages")]
-    private static extern void ClearMessages();
-    [DllImport(name, EntryPoint = "UwcExcludeRemovedWindowEvents")]
-    private static extern void ExcludeRemovedWindowEvents();
-    [DllImport(name, EntryPoint = "UwcCheckWindowExistence")]
-    public static extern bool CheckWindowExistence(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowHandle")]
-    public static extern IntPtr GetWindowHandle(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowParentId")]
-    public static extern int GetWindowParentId(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowOwnerHandle")]
-    public static extern IntPtr GetWindowOwnerHandle(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowParentHandle")]
-    public static extern IntPtr GetWindowParentHandle(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowInstance")]
-    public static extern IntPtr GetWindowInstance(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowProcessId")]
-    public static extern int GetWindowProcessId(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowThreadId")]
-    public static extern int GetWindowThreadId(int id);
-    [DllImport(name, EntryPoint = "UwcRequestUpdateWindowTitle")]
-    public static extern void RequestUpdateWindowTitle(int id);
-    [DllImport(name, EntryPoint = "UwcRequestCaptureWindow")]
-    public static extern void RequestCaptureWindow(int id, CapturePriority priority);
-    [DllImport(name, EntryPoint = "UwcRequestCaptureIcon")]
-    public static extern void RequestCaptureIcon(int id);
-    [DllImport(name, EntryPoint = "StartCaptureWindow")]
-    public static extern void StartCaptureWindow(int id, CapturePriority priority);
-    [DllImport(name, EntryPoint = "StopCaptureWindow")]
-    public static extern void StopCaptureWindow(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowX")]
-    public static extern int GetWindowX(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowY")]
-    public static extern int GetWindowY(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowWidth")]
-    public static extern int GetWindowWidth(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowHeight")]
-    public static extern int GetWindowHeight(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowZOrder")]
-    public static extern int GetWindowZOrder(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowBuffer")]
-    public static extern IntPtr GetWindowBuffer(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowTextureWidth")]
-    public static extern int GetWindowTextureWidth(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowTextureHeight")]
-    public static extern int GetWindowTextureHeight(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowTextureOffsetX")]
-    public static extern int GetWindowTextureOffsetX(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowTextureOffsetY")]
-    public static extern int GetWindowTextureOffsetY(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowIconWidth")]
-    public static extern int GetWindowIconWidth(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowIconHeight")]
-    public static extern int GetWindowIconHeight(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowTitleLength")]
-    private static extern int GetWindowTitleLength(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowTitle", CharSet = CharSet.Unicode)]
-    private static extern IntPtr GetWindowTitle_Internal(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowClassNameLength")]
-    private static extern int GetWindowClassNameLength(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowClassName", CharSet = CharSet.Ansi)]
-    private static extern IntPtr GetWindowClassName_Internal(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowTexturePtr")]
-    public static extern IntPtr GetWindowTexturePtr(int id);
-    [DllImport(name, EntryPoint = "UwcSetWindowTexturePtr")]
-    public static extern void SetWindowTexturePtr(int id, IntPtr texturePtr);
-    [DllImport(name, EntryPoint = "UwcGetWindowIconTexturePtr")]
-    public static extern IntPtr GetWindowIconTexturePtr(int id);
-    [DllImport(name, EntryPoint = "UwcSetWindowIconTexturePtr")]
-    public static extern void SetWindowIconTexturePtr(int id, IntPtr texturePtr);
-    [DllImport(name, EntryPoint = "UwcGetWindowCaptureMode")]
-    public static extern CaptureMode GetWindowCaptureMode(int id);
-    [DllImport(name, EntryPoint = "UwcSetWindowCaptureMode")]
-    public static extern void SetWindowCaptureMode(int id, CaptureMode mode);
-    [DllImport(name, EntryPoint = "UwcGetWindowCursorDraw")]
-    public static extern bool GetWindowCursorDraw(int id);
-    [DllImport(name, EntryPoint = "UwcSetWindowCursorDraw")]
-    public static extern void SetWindowCursorDraw(int id, bool draw);
-    [DllImport(name, EntryPoint = "UwcIsWindow")]
-    public static extern bool IsWindow(int id);
-    [DllImport(name, EntryPoint = "UwcIsWindowVisible")]
-    public static extern bool IsWindowVisible(int id);
-    [DllImport(name, EntryPoint = "UwcIsAltTabWindow")]
-    public static extern bool IsAltTabWindow(int id);
-    [DllImport(name, EntryPoint = "UwcIsDesktop")]
-    public static extern bool IsDesktop(int id);
-    [DllImport(name, EntryPoint = "UwcIsWindowEnabled")]
-    public static extern bool IsWindowEnabled(int id);
-    [DllImport(name, EntryPoint = "UwcIsWindowUnicode")]
-    public static extern bool IsWindowUnicode(int id);
-    [DllImport(name, EntryPoint = "UwcIsWindowZoomed")]
-    public static extern bool IsWindowZoomed(int id);
-    [DllImport(name, EntryPoint = "UwcIsWindowIconic")]
-    public static extern bool IsWindowIconic(int id);
-    [DllImport(name, EntryPoint = "UwcIsWindowHungUp")]
-    public static extern bool IsWindowHungUp(int id);
-    [DllImport(name, EntryPoint = "UwcIsWindowTouchable")]
-    public static extern bool IsWindowTouchable(int id);
-    [DllImport(name, EntryPoint = "UwcIsWindowApplicationFrameWindow")]
-    public static extern bool IsApplicationFrameWindow(int id);
-    [DllImport(name, EntryPoint = "UwcIsWindowUWP")]
-    public static extern bool IsWindowUWP(int id);
-    [DllImport(name, EntryPoint = "UwcIsWindowBackground")]
-    public static extern bool IsWindowBackground(int id);
-    [DllImport(name, EntryPoint = "UwcGetWindowPixel")]
-    public static extern Color32 GetWindowPixel(int id, int x, int y);
-    [DllImport(name, EntryPoint = "UwcGetWindowPixels")]
-    private static extern bool GetWindowPixels_Internal(int id, IntPtr output, int x, int y, int width, int height);
-    [DllImport(name, EntryPoint = "UwcRequestCaptureCursor")]
-    public static extern void RequestCaptureCursor();
-    [DllImport(name, EntryPoint = "UwcGetCursorPosition")]
-    public static extern Point GetCursorPosition();
-    [DllImport(name, EntryPoint = "UwcGetWindowIdFromPoint")]
-    public static extern int GetWindowIdFromPoint(int x, int y);
-    [DllImport(name, EntryPoint = "UwcGetWindowIdUnderCursor")]
-    public static extern int GetWindowIdUnderCursor();
-    [DllImport(name, EntryPoint = "UwcGetCursorX")]
-    public static extern int GetCursorX();
-    [DllImport(name, EntryPoint = "UwcGetCursorY")]
-    public static extern int GetCursorY();
-    [DllImport(name, EntryPoint = "UwcGetCursorWidth")]
-    public static extern int GetCursorWidth();
-    [DllImport(name, EntryPoint = "UwcGetCursorHeight")]
-    public static extern int GetCursorHeight();
-    [DllImport(name, EntryPoint = "UwcSetCursorTexturePtr")]
-    public static extern void SetCursorTexturePtr(IntPtr ptr);
-    [DllImport(name, EntryPoint = "UwcGetScreenX")]
-    public static extern int GetScreenX();
-    [DllImport(name, EntryPoint = "UwcGetScreenY")]
-    public static extern int GetScreenY();
-    [DllImport(name, EntryPoint = "UwcGetScreenWidth")]
-    public static extern int GetScreenWidth();
-    [DllImport(name, EntryPoint = "UwcGetScreenHeight")]
-    public static extern int GetScreenHeight();
-    [DllImport(name, EntryPoint = "UwcIsWindowsGraphicsCaptureSupported")]
-    public static extern bool IsWindowsGraphicsCaptureSupported();
-    [DllImport(name, EntryPoint = "UwcIsWindowsGraphicsCaptureCursorCaptureEnabledApiSupported")]
-    public static extern bool IsWindowsGraphicsCaptureCursorCaptureEnabledApiSupported();
-
-    public static Message[] GetMessages()
-    {
-        ExcludeRemovedWindowEvents();
-
-        var count = GetMessageCount();
-        var messages = new Message[count];
-
-        if (count == 0) return messages;
-
-        var ptr = GetMessages_Internal();
-        var size = Marshal.SizeOf(typeof(Message));
-
-        for (int i = 0; i < count; ++i) {
-            var data = new IntPtr(ptr.ToInt64() + (size * i));
-            messages[i] = (Message)Marshal.PtrToStructure(data, typeof(Message));
-        }
-
-        ClearMessages();
-
-        return messages;
-    }
-
-    public static string GetWindowTitle(int id)
-    {
-        var len = GetWindowTitleLength(id);
-        var ptr = GetWindowTitle_Internal(id);
-        if (ptr != IntPtr.Zero) {
-            return Marshal.PtrToStringUni(ptr, len);
-        } else {
-            return "";
-        }
-    }
-
-    public static string GetWindowClassName(int id)
-    {
-        var len = GetWindowClassNameLength(id);
-        var ptr = GetWindowClassName_Internal(id);
-        if (ptr != IntPtr.Zero) {
-            return Marshal.PtrToStringAnsi(ptr, len);
-        } else {
-            return "";
-        }
-    }
-
-    public static Color32[] GetWindowPixels(int id, int x, int y, int width, int height)
-    {
-        var color = new Color32[width * height];       
-        GetWindowPixels(id, color, x, y, width, height);
-        return color;
-    }
-
-    public static bool GetWindowPixels(int id, Color32[] colors, int x, int y, int width, int height)
-    {
-        if (colors.Length < width * height) {
-            Debug.LogErrorFormat("colors is smaller than (width * height).", id, x, y, width, height);
-            return false;
-        }
-		var handle = GCHandle.Alloc(colors, GCHandleType.Pinned);
-		var ptr = handle.AddrOfPinnedObject();
-        if (!GetWindowPixels_Internal(id, ptr, x, y, width, height)) {
-            Debug.LogErrorFormat("GetWindowPixels({0}, {1}, {2}, {3}, {4}) failed.", id, x, y, width, height);
-            return false;
-        }
-        handle.Free();
-        return true;
-    }
-}
-
+﻿using UnityEngine;
+using System;
+using System.Runtime.InteropServices;
+
+#pragma warning disable 114, 465
+
+namespace uWindowCapture
+{
+
+public enum DebugMode
+{
+    None = 0,
+    File = 1,
+    UnityLog = 2, /* currently has bug when app exits. */
+}
+
+public enum DebugLevel
+{
+    Log = 0,
+    Error = 1,
+    None = 2,
+}
+
+public enum TraceMode
+{
+    Off = 0,
+    Recording = 1,
+    FlightRecorder = 2,
+}
+
+public enum CaptureMode
+{
+    None = -1,
+    PrintWindow = 0,
+    BitBlt = 1,
+    WindowsGraphicsCapture = 2,
+    Auto = 3,
+}
+
+public enum CapturePixelFormat
+{
+    B8G8R8A8UIntNormalized = 0,
+    R16G16B16A16Float = 1,
+}
+
+public enum CaptureFrameArrivalMode
+{
+    Polling = 0,
+    Mailbox = 1,
+}
+
+public enum CapturePriority
+{
+    Auto = -1,
+    High = 0,
+    Middle = 1,
+    Low = 2,
+}
+
+public enum MessageType
+{
+    None = -1,
+    WindowAdded = 0,
+    WindowRemoved = 1,
+    WindowCaptured = 2,
+    WindowSizeChanged = 3,
+    IconCaptured = 4,
+    CursorCaptured = 5,
+    WindowTitleChanged = 6,
+    WindowMoved = 7,
+    WindowResized = 8,
+    WindowZOrderChanged = 9,
+    Error = 1000,
+    TextureNullError = 1001,
+    TextureSizeError = 1002,
+}
+
+public enum MessageCallbackMode
+{
+    Immediate = 0,
+    Dispatched = 1,
+}
+
+public enum WindowFilterTarget
+{
+    ClassName = 0,
+    Title = 1,
+    ProcessName = 2,
+}
+
+public enum WindowFilterMode
+{
+    Include = 0,
+    Exclude = 1,
+}
+
+public enum MessageWindowFilter
+{
+    All = 0,
+    Subscribed = 1,
+    TextureBound = 2,
+}
+
+[StructLayout(LayoutKind.Sequential)]
+public struct Message
+{
+    [MarshalAs(UnmanagedType.I4)]
+    public MessageType type;
+    [MarshalAs(UnmanagedType.I4)]
+    public int windowId;
+    [MarshalAs(UnmanagedType.I8)]
+    public IntPtr userData;
+}
+
+public enum CaptureTicketState
+{
+    Invalid = -1,
+    Pending = 0,
+    Completed = 1,
+    Failed = 2,
+}
+
+[StructLayout(LayoutKind.Sequential)]
+public struct CaptureTicketResult
+{
+    [MarshalAs(UnmanagedType.I4)]
+    public int ticketId;
+    [MarshalAs(UnmanagedType.I4)]
+    public int windowId;
+    [MarshalAs(UnmanagedType.I4)]
+    public CaptureTicketState state;
+    [MarshalAs(UnmanagedType.U8)]
+    public ulong frameId;
+    [MarshalAs(UnmanagedType.I8)]
+    public long requestedTime;
+    [MarshalAs(UnmanagedType.I8)]
+    public long capturedTime;
+    [MarshalAs(UnmanagedType.I8)]
+    public long uploadedTime;
+}
+
+[System.Flags]
+public enum WindowInfoFlags
+{
+    None = 0,
+    Desktop = 1 << 0,
+    AltTabWindow = 1 << 1,
+    ApplicationFrameWindow = 1 << 2,
+    UWP = 1 << 3,
+    Background = 1 << 4,
+}
+
+[System.Flags]
+public enum WindowInfoDirtyFlags
+{
+    None = 0,
+    Added = 1 << 0,
+    Moved = 1 << 1,
+    Resized = 1 << 2,
+    ZOrderChanged = 1 << 3,
+    ParentChanged = 1 << 4,
+    TextureSizeChanged = 1 << 5,
+    FrameUpdated = 1 << 6,
+}
+
+[StructLayout(LayoutKind.Sequential)]
+public struct WindowInfo
+{
+    [MarshalAs(UnmanagedType.I4)]
+    public int id;
+    [MarshalAs(UnmanagedType.I4)]
+    public int parentId;
+    [MarshalAs(UnmanagedType.I4)]
+    public int x;
+    [MarshalAs(UnmanagedType.I4)]
+    public int y;
+    [MarshalAs(UnmanagedType.I4)]
+    public int width;
+    [MarshalAs(UnmanagedType.I4)]
+    public int height;
+    [MarshalAs(UnmanagedType.U4)]
+    public uint zOrder;
+    [MarshalAs(UnmanagedType.U4)]
+    public WindowInfoFlags flags;
+    [MarshalAs(UnmanagedType.U4)]
+    public WindowInfoDirtyFlags dirtyFlags;
+    [MarshalAs(UnmanagedType.U4)]
+    public uint textureWidth;
+    [MarshalAs(UnmanagedType.U4)]
+    public uint textureHeight;
+    [MarshalAs(UnmanagedType.U4)]
+    public uint textureOffsetX;
+    [MarshalAs(UnmanagedType.U4)]
+    public uint textureOffsetY;
+    [MarshalAs(UnmanagedType.U4)]
+    public uint processId;
+    [MarshalAs(UnmanagedType.U8)]
+    public ulong frameId;
+}
+
+[StructLayout(LayoutKind.Sequential)]
+public struct CaptureFrameStats
+{
+    [MarshalAs(UnmanagedType.U8)]
+    public ulong arrivedFrameCount;
+    [MarshalAs(UnmanagedType.U8)]
+    public ulong droppedFrameCount;
+    [MarshalAs(UnmanagedType.U8)]
+    public ulong uploadedFrameCount;
+    [MarshalAs(UnmanagedType.U8)]
+    public ulong totalLatency;
+    [MarshalAs(UnmanagedType.U8)]
+    public ulong lastLatency;
+}
+
+[StructLayout(LayoutKind.Sequential)]
+public struct Point
+{
+    [MarshalAs(UnmanagedType.I4)]
+    public int x;
+    [MarshalAs(UnmanagedType.I4)]
+    public int y;
+}
+
+public static class Lib
+{
+    public const string name = "uWindowCapture";
+
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    public delegate void DebugLogDelegate(string str);
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    public delegate void MessageCallbackDelegate(IntPtr messages, uint count, IntPtr userData);
+
+    [DllImport(name, EntryPoint = "UwcInitialize")]
+    public static extern void Initialize();
+    [DllImport(name, EntryPoint = "UwcFinalize")]
+    public static extern void Finalize();
+    [DllImport(name, EntryPoint = "UwcSetDebugMode")]
+    public static extern void SetDebugMode(DebugMode mode);
+    [DllImport(name, EntryPoint = "UwcSetDebugLevel")]
+    public static extern void SetDebugLevel(DebugLevel level);
+    [DllImport(name, EntryPoint = "UwcSetTraceMode")]
+    public static extern void SetTraceMode(TraceMode mode);
+    [DllImport(name, EntryPoint = "UwcSetTraceFlightRecorderDuration")]
+    public static extern void SetTraceFlightRecorderDuration(int durationMs);
+    [DllImport(name, EntryPoint = "UwcClearTrace")]
+    public static extern void ClearTrace();
+    [DllImport(name, EntryPoint = "UwcExportTrace", CharSet = CharSet.Unicode)]
+    public static extern bool ExportTrace(string path);
+    [DllImport(name, EntryPoint = "UwcSetLogFunc")]
+    public static extern void SetLogFunc(DebugLogDelegate func);
+    [DllImport(name, EntryPoint = "UwcSetErrorFunc")]
+    public static extern void SetErrorFunc(DebugLogDelegate func);
+    [DllImport(name, EntryPoint = "UwcGetRenderEventFunc")]
+    public static extern IntPtr GetRenderEventFunc();
+    [DllImport(name, EntryPoint = "UwcUpdate")]
+    public static extern void Update(float dt);
+    [DllImport(name, EntryPoint = "UwcGetMessageCount")]
+    private static extern int GetMessageCount();
+    [DllImport(name, EntryPoint = "UwcGetMessages")]
+    private static extern IntPtr GetMessages_Internal();
+    [DllImport(name, EntryPoint = "UwcSwapMessages")]
+    private static extern IntPtr SwapMessages(out int count);
+    [DllImport(name, EntryPoint = "UwcClearMessages")]
+    private static extern void ClearMessages();
+    [DllImport(name, EntryPoint = "UwcExcludeRemovedWindowEvents")]
+    private static extern void ExcludeRemovedWindowEvents();
+    [DllImport(name, EntryPoint = "UwcSubscribeMessageType")]
+    public static extern void SubscribeMessageType(MessageType type, bool subscribe);
+    [DllImport(name, EntryPoint = "UwcIsMessageTypeSubscribed")]
+    public static extern bool IsMessageTypeSubscribed(MessageType type);
+    [DllImport(name, EntryPoint = "UwcSetMessageWindowFilter")]
+    public static extern void SetMessageWindowFilter(MessageWindowFilter filter);
+    [DllImport(name, EntryPoint = "UwcGetMessageWindowFilter")]
+    public static extern MessageWindowFilter GetMessageWindowFilter();
+    [DllImport(name, EntryPoint = "UwcSubscribeWindowMessages")]
+    public static extern void SubscribeWindowMessages(int id, bool subscribe);
+    [DllImport(name, EntryPoint = "UwcGetProducedMessageCount")]
+    public static extern ulong GetProducedMessageCount(MessageType type);
+    [DllImport(name, EntryPoint = "UwcGetDeliveredMessageCount")]
+    public static extern ulong GetDeliveredMessageCount(MessageType type);
+    [DllImport(name, EntryPoint = "UwcSetMessageCallback")]
+    public static extern void SetMessageCallback(MessageType type, MessageCallbackDelegate func, IntPtr userData, MessageCallbackMode mode);
+    [DllImport(name, EntryPoint = "UwcGetWindowInfos")]
+    public static extern int GetWindowInfos([Out] WindowInfo[] buffer, int capacity);
+    [DllImport(name, EntryPoint = "UwcSetWindowFilter")]
+    public static extern void SetWindowFilter(bool isAltTabOnly, int minWidth, int minHeight, [In] WindowFilterPattern[] patterns, int patternCount);
+    [DllImport(name, EntryPoint = "UwcSetWindowFilterAltTabOnly")]
+    public static extern void SetWindowFilterAltTabOnly(bool isAltTabOnly);
+    [DllImport(name, EntryPoint = "UwcSetWindowFilterMinSize")]
+    public static extern void SetWindowFilterMinSize(int width, int height);
+    [DllImport(name, EntryPoint = "UwcAddWindowFilterPattern", CharSet = CharSet.Unicode)]
+    public static extern void AddWindowFilterPattern(WindowFilterTarget target, WindowFilterMode mode, string pattern);
+    [DllImport(name, EntryPoint = "UwcClearWindowFilter")]
+    public static extern void ClearWindowFilter();
+    [DllImport(name, EntryPoint = "UwcCheckWindowExistence")]
+    public static extern bool CheckWindowExistence(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowHandle")]
+    public static extern IntPtr GetWindowHandle(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowParentId")]
+    public static extern int GetWindowParentId(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowOwnerHandle")]
+    public static extern IntPtr GetWindowOwnerHandle(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowParentHandle")]
+    public static extern IntPtr GetWindowParentHandle(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowInstance")]
+    public static extern IntPtr GetWindowInstance(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowProcessId")]
+    public static extern int GetWindowProcessId(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowThreadId")]
+    public static extern int GetWindowThreadId(int id);
+    [DllImport(name, EntryPoint = "UwcRequestUpdateWindowTitle")]
+    public static extern void RequestUpdateWindowTitle(int id);
+    [DllImport(name, EntryPoint = "UwcRequestCaptureWindow")]
+    public static extern void RequestCaptureWindow(int id, CapturePriority priority);
+    [DllImport(name, EntryPoint = "UwcRequestCaptureIcon")]
+    public static extern void RequestCaptureIcon(int id);
+    [DllImport(name, EntryPoint = "UwcRequestCaptureWindowTicket")]
+    public static extern int RequestCaptureWindowTicket(int id, CapturePriority priority);
+    [DllImport(name, EntryPoint = "UwcGetCaptureTicketResult")]
+    public static extern CaptureTicketState GetCaptureTicketResult(int ticketId, out CaptureTicketResult result);
+    [DllImport(name, EntryPoint = "UwcWaitCaptureTicket")]
+    public static extern CaptureTicketState WaitCaptureTicket(int ticketId, uint timeout, out CaptureTicketResult result);
+    [DllImport(name, EntryPoint = "UwcReleaseCaptureTicket")]
+    public static extern void ReleaseCaptureTicket(int ticketId);
+    [DllImport(name, EntryPoint = "StartCaptureWindow")]
+    public static extern void StartCaptureWindow(int id, CapturePriority priority);
+    [DllImport(name, EntryPoint = "StopCaptureWindow")]
+    public static extern void StopCaptureWindow(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowX")]
+    public static extern int GetWindowX(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowY")]
+    public static extern int GetWindowY(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowWidth")]
+    public static extern int GetWindowWidth(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowHeight")]
+    public static extern int GetWindowHeight(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowZOrder")]
+    public static extern int GetWindowZOrder(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowBuffer")]
+    public static extern IntPtr GetWindowBuffer(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowTextureWidth")]
+    public static extern int GetWindowTextureWidth(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowTextureHeight")]
+    public static extern int GetWindowTextureHeight(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowTextureOffsetX")]
+    public static extern int GetWindowTextureOffsetX(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowTextureOffsetY")]
+    public static extern int GetWindowTextureOffsetY(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowIconWidth")]
+    public static extern int GetWindowIconWidth(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowIconHeight")]
+    public static extern int GetWindowIconHeight(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowTitleLength")]
+    private static extern int GetWindowTitleLength(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowTitle", CharSet = CharSet.Unicode)]
+    private static extern IntPtr GetWindowTitle_Internal(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowClassNameLength")]
+    private static extern int GetWindowClassNameLength(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowClassName", CharSet = CharSet.Ansi)]
+    private static extern IntPtr GetWindowClassName_Internal(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowTexturePtr")]
+    public static extern IntPtr GetWindowTexturePtr(int id);
+    [DllImport(name, EntryPoint = "UwcSetWindowTexturePtr")]
+    public static extern void SetWindowTexturePtr(int id, IntPtr texturePtr);
+    [DllImport(name, EntryPoint = "UwcGetWindowIconTexturePtr")]
+    public static extern IntPtr GetWindowIconTexturePtr(int id);
+    [DllImport(name, EntryPoint = "UwcSetWindowIconTexturePtr")]
+    public static extern void SetWindowIconTexturePtr(int id, IntPtr texturePtr);
+    [DllImport(name, EntryPoint = "UwcGetWindowCaptureMode")]
+    public static extern CaptureMode GetWindowCaptureMode(int id);
+    [DllImport(name, EntryPoint = "UwcSetWindowCaptureMode")]
+    public static extern void SetWindowCaptureMode(int id, CaptureMode mode);
+    [DllImport(name, EntryPoint = "UwcGetWindowCursorDraw")]
+    public static extern bool GetWindowCursorDraw(int id);
+    [DllImport(name, EntryPoint = "UwcSetWindowCursorDraw")]
+    public static extern void SetWindowCursorDraw(int id, bool draw);
+    [DllImport(name, EntryPoint = "UwcGetWindowCapturePoolDepth")]
+    public static extern int GetWindowCapturePoolDepth(int id);
+    [DllImport(name, EntryPoint = "UwcSetWindowCapturePoolDepth")]
+    public static extern void SetWindowCapturePoolDepth(int id, int depth);
+    [DllImport(name, EntryPoint = "UwcGetWindowCapturePixelFormat")]
+    public static extern CapturePixelFormat GetWindowCapturePixelFormat(int id);
+    [DllImport(name, EntryPoint = "UwcSetWindowCapturePixelFormat")]
+    public static extern void SetWindowCapturePixelFormat(int id, CapturePixelFormat format);
+    [DllImport(name, EntryPoint = "UwcGetWindowCaptureFrameArrivalMode")]
+    public static extern CaptureFrameArrivalMode GetWindowCaptureFrameArrivalMode(int id);
+    [DllImport(name, EntryPoint = "UwcSetWindowCaptureFrameArrivalMode")]
+    public static extern void SetWindowCaptureFrameArrivalMode(int id, CaptureFrameArrivalMode mode);
+    [DllImport(name, EntryPoint = "UwcGetWindowCaptureFrameStats")]
+    public static extern bool GetWindowCaptureFrameStats(int id, out CaptureFrameStats stats);
+    [DllImport(name, EntryPoint = "UwcIsWindow")]
+    public static extern bool IsWindow(int id);
+    [DllImport(name, EntryPoint = "UwcIsWindowVisible")]
+    public static extern bool IsWindowVisible(int id);
+    [DllImport(name, EntryPoint = "UwcIsAltTabWindow")]
+    public static extern bool IsAltTabWindow(int id);
+    [DllImport(name, EntryPoint = "UwcIsDesktop")]
+    public static extern bool IsDesktop(int id);
+    [DllImport(name, EntryPoint = "UwcIsWindowEnabled")]
+    public static extern bool IsWindowEnabled(int id);
+    [DllImport(name, EntryPoint = "UwcIsWindowUnicode")]
+    public static extern bool IsWindowUnicode(int id);
+    [DllImport(name, EntryPoint = "UwcIsWindowZoomed")]
+    public static extern bool IsWindowZoomed(int id);
+    [DllImport(name, EntryPoint = "UwcIsWindowIconic")]
+    public static extern bool IsWindowIconic(int id);
+    [DllImport(name, EntryPoint = "UwcIsWindowHungUp")]
+    public static extern bool IsWindowHungUp(int id);
+    [DllImport(name, EntryPoint = "UwcIsWindowTouchable")]
+    public static extern bool IsWindowTouchable(int id);
+    [DllImport(name, EntryPoint = "UwcIsWindowApplicationFrameWindow")]
+    public static extern bool IsApplicationFrameWindow(int id);
+    [DllImport(name, EntryPoint = "UwcIsWindowUWP")]
+    public static extern bool IsWindowUWP(int id);
+    [DllImport(name, EntryPoint = "UwcIsWindowBackground")]
+    public static extern bool IsWindowBackground(int id);
+    [DllImport(name, EntryPoint = "UwcGetWindowPixel")]
+    public static extern Color32 GetWindowPixel(int id, int x, int y);
+    [DllImport(name, EntryPoint = "UwcGetWindowPixels")]
+    private static extern bool GetWindowPixels_Internal(int id, IntPtr output, int x, int y, int width, int height);
+    [DllImport(name, EntryPoint = "UwcRequestCaptureCursor")]
+    public static extern void RequestCaptureCursor();
+    [DllImport(name, EntryPoint = "UwcGetCursorPosition")]
+    public static extern Point GetCursorPosition();
+    [DllImport(name, EntryPoint = "UwcGetWindowIdFromPoint")]
+    public static extern int GetWindowIdFromPoint(int x, int y);
+    [DllImport(name, EntryPoint = "UwcGetWindowIdUnderCursor")]
+    public static extern int GetWindowIdUnderCursor();
+    [DllImport(name, EntryPoint = "UwcGetCursorX")]
+    public static extern int GetCursorX();
+    [DllImport(name, EntryPoint = "UwcGetCursorY")]
+    public static extern int GetCursorY();
+    [DllImport(name, EntryPoint = "UwcGetCursorWidth")]
+    public static extern int GetCursorWidth();
+    [DllImport(name, EntryPoint = "UwcGetCursorHeight")]
+    public static extern int GetCursorHeight();
+    [DllImport(name, EntryPoint = "UwcSetCursorTexturePtr")]
+    public static extern void SetCursorTexturePtr(IntPtr ptr);
+    [DllImport(name, EntryPoint = "UwcGetScreenX")]
+    public static extern int GetScreenX();
+    [DllImport(name, EntryPoint = "UwcGetScreenY")]
+    public static extern int GetScreenY();
+    [DllImport(name, EntryPoint = "UwcGetScreenWidth")]
+    public static extern int GetScreenWidth();
+    [DllImport(name, EntryPoint = "UwcGetScreenHeight")]
+    public static extern int GetScreenHeight();
+    [DllImport(name, EntryPoint = "UwcGetSharedTextureCreationCountPerSecond")]
+    public static extern int GetSharedTextureCreationCountPerSecond();
+    [DllImport(name, EntryPoint = "UwcIsWindowsGraphicsCaptureSupported")]
+    public static extern bool IsWindowsGraphicsCaptureSupported();
+    [DllImport(name, EntryPoint = "UwcIsWindowsGraphicsCaptureCursorCaptureEnabledApiSupported")]
+    public static extern bool IsWindowsGraphicsCaptureCursorCaptureEnabledApiSupported();
+    [DllImport(name, EntryPoint = "UwcSetWindowsGraphicsCaptureSessionTimeouts")]
+    public static extern void SetWindowsGraphicsCaptureSessionTimeouts(int idleTimeoutMs, int warmTimeoutMs, int frameTimeoutMs, int minRestartIntervalMs);
+    [DllImport(name, EntryPoint = "UwcSetWindowsGraphicsCaptureWarmSessionCount")]
+    public static extern void SetWindowsGraphicsCaptureWarmSessionCount(int count);
+
+    public static Message[] GetMessages()
+    {
+        int count;
+        var ptr = SwapMessages(out count);
+        var messages = new Message[count];
+
+        if (count == 0) return messages;
+
+        var size = Marshal.SizeOf(typeof(Message));
+
+        for (int i = 0; i < count; ++i) {
+            var data = new IntPtr(ptr.ToInt64() + (size * i));
+            messages[i] = (Message)Marshal.PtrToStructure(data, typeof(Message));
+        }
+
+        return messages;
+    }
+
+    public static string GetWindowTitle(int id)
+    {
+        var len = GetWindowTitleLength(id);
+        var ptr = GetWindowTitle_Internal(id);
+        if (ptr != IntPtr.Zero) {
+            return Marshal.PtrToStringUni(ptr, len);
+        } else {
+            return "";
+        }
+    }
+
+    public static string GetWindowClassName(int id)
+    {
+        var len = GetWindowClassNameLength(id);
+        var ptr = GetWindowClassName_Internal(id);
+        if (ptr != IntPtr.Zero) {
+            return Marshal.PtrToStringAnsi(ptr, len);
+        } else {
+            return "";
+        }
+    }
+
+    public static Color32[] GetWindowPixels(int id, int x, int y, int width, int height)
+    {
+        var color = new Color32[width * height];       
+        GetWindowPixels(id, color, x, y, width, height);
+        return color;
+    }
+
+    public static bool GetWindowPixels(int id, Color32[] colors, int x, int y, int width, int height)
+    {
+        if (colors.Length < width * height) {
+            Debug.LogErrorFormat("colors is smaller than (width * height).", id, x, y, width, height);
+            return false;
+        }
+		var handle = GCHandle.Alloc(colors, GCHandleType.Pinned);
+		var ptr = handle.AddrOfPinnedObject();
+        if (!GetWindowPixels_Internal(id, ptr, x, y, width, height)) {
+            Debug.LogErrorFormat("GetWindowPixels({0}, {1}, {2}, {3}, {4}) failed.", id, x, y, width, height);
+            return false;
+        }
+        handle.Free();
+        return true;
+    }
+}
+
 }
\ No newline at end of file
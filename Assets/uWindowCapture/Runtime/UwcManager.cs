@@ -66,6 +66,12 @@ public class UwcManager : MonoBehaviour
 
     public WindowTitlesUpdateTiming windowTitlesUpdateTiming = WindowTitlesUpdateTiming.Manual;
 
+    public MessageWindowFilter messageWindowFilter = MessageWindowFilter.All;
+
+    public bool altTabWindowsOnly = false;
+    public Vector2Int minimumWindowSize = Vector2Int.zero;
+    public WindowFilterPattern[] windowFilterPatterns = new WindowFilterPattern[0];
+
     private UwcWindowEvent onWindowAdded_ = new UwcWindowEvent();
     public static UwcWindowEvent onWindowAdded
     {
@@ -104,6 +110,11 @@ public class UwcManager : MonoBehaviour
         get { return instance.windows_; }
     }
 
+    List<UwcWindow> iconTextureRequestedWindows_ = new List<UwcWindow>();
+
+    WindowInfo[] windowInfos_ = new WindowInfo[256];
+    Dictionary<int, int> windowInfoIndices_ = new Dictionary<int, int>();
+
     int cursorWindowId_ = -1;
     static public UwcWindow cursorWindow
     {
@@ -135,6 +146,7 @@ public class UwcManager : MonoBehaviour
     void Awake()
     {
         Lib.SetDebugMode(debugMode);
+        ApplyWindowFilter();
         Lib.Initialize();
         renderEventFunc_ = Lib.GetRenderEventFunc();
     }
@@ -176,11 +188,47 @@ public class UwcManager : MonoBehaviour
         UpdateWindowInfo();
         UpdateMessages();
         UpdateWindowTitles();
+        UpdateIconTextures();
     }
 
     void UpdateWindowInfo()
     {
         cursorWindowId_ = Lib.GetWindowIdUnderCursor();
+
+        var count = Lib.GetWindowInfos(windowInfos_, windowInfos_.Length);
+        if (count > windowInfos_.Length) {
+            windowInfos_ = new WindowInfo[count * 2];
+            count = Lib.GetWindowInfos(windowInfos_, windowInfos_.Length);
+        }
+        count = Mathf.Min(count, windowInfos_.Length);
+
+        windowInfoIndices_.Clear();
+        for (int i = 0; i < count; ++i) {
+            windowInfoIndices_[windowInfos_[i].id] = i;
+        }
+    }
+
+    static public bool TryGetWindowInfo(int id, out WindowInfo info)
+    {
+        int index;
+        if (instance.windowInfoIndices_.TryGetValue(id, out index)) {
+            info = instance.windowInfos_[index];
+            return true;
+        }
+        info = new WindowInfo();
+        return false;
+    }
+
+    static public void RequestIconTexture(UwcWindow window)
+    {
+        if (!instance.iconTextureRequestedWindows_.Contains(window)) {
+            instance.iconTextureRequestedWindows_.Add(window);
+        }
+    }
+
+    void UpdateIconTextures()
+    {
+        iconTextureRequestedWindows_.RemoveAll(window => !window.isAlive || window.CreateIconTexture());
     }
 
     UwcWindow AddWindow(int id)
@@ -192,6 +240,8 @@ public class UwcManager : MonoBehaviour
 
     void UpdateMessages()
     {
+        Lib.SetMessageWindowFilter(messageWindowFilter);
+
         var messages = Lib.GetMessages();
 
         for (int i = 0; i < messages.Length; ++i) {
@@ -246,6 +296,34 @@ public class UwcManager : MonoBehaviour
                     }
                     break;
                 }
+                case MessageType.WindowTitleChanged: {
+                    var window = Find(id);
+                    if (window != null) {
+                        window.onTitleChanged.Invoke();
+                    }
+                    break;
+                }
+                case MessageType.WindowMoved: {
+                    var window = Find(id);
+                    if (window != null) {
+                        window.onMoved.Invoke();
+                    }
+                    break;
+                }
+                case MessageType.WindowResized: {
+                    var window = Find(id);
+                    if (window != null) {
+                        window.onResized.Invoke();
+                    }
+                    break;
+                }
+                case MessageType.WindowZOrderChanged: {
+                    var window = Find(id);
+                    if (window != null) {
+                        window.onZOrderChanged.Invoke();
+                    }
+                    break;
+                }
                 case MessageType.CursorCaptured: {
                     cursor.onCaptured.Invoke();
                     break;
@@ -361,6 +439,18 @@ public class UwcManager : MonoBehaviour
         return Find(id);
     }
 
+    static public void ApplyWindowFilter()
+    {
+        var manager = instance;
+        var patterns = manager.windowFilterPatterns ?? new WindowFilterPattern[0];
+        Lib.SetWindowFilter(
+            manager.altTabWindowsOnly,
+            manager.minimumWindowSize.x,
+            manager.minimumWindowSize.y,
+            patterns,
+            patterns.Length);
+    }
+
     static public void UpdateAllWindowTitles()
     {
         foreach (var kv in windows) {
@@ -15,7 +15,7 @@ public class UwcWindow
         onSizeChanged.AddListener(OnSizeChanged);
         onIconCaptured.AddListener(OnIconCaptured);
 
-        CreateIconTexture();
+        errorIconTexture_ = Resources.Load<Texture2D>("uWindowCapture/Textures/uWC_No_Image");
 
         parentWindow = UwcManager.FindParent(id);
         if (parentWindow != null) {
@@ -29,6 +29,16 @@ public class UwcWindow
         private set; 
     }
 
+    public WindowInfo info
+    {
+        get
+        {
+            WindowInfo info;
+            UwcManager.TryGetWindowInfo(id, out info);
+            return info;
+        }
+    }
+
     public UwcWindow parentWindow
     {
         get;
@@ -57,7 +67,11 @@ public class UwcWindow
 
     public int processId
     {
-        get { return Lib.GetWindowProcessId(id); }
+        get
+        {
+            WindowInfo info;
+            return UwcManager.TryGetWindowInfo(id, out info) ? (int)info.processId : Lib.GetWindowProcessId(id);
+        }
     }
 
     public int threadId
@@ -93,12 +107,24 @@ public class UwcWindow
 
     public bool isAltTabWindow
     {
-        get { return Lib.IsAltTabWindow(id); }
+        get
+        {
+            WindowInfo info;
+            return UwcManager.TryGetWindowInfo(id, out info) ?
+                (info.flags & WindowInfoFlags.AltTabWindow) != 0 :
+                Lib.IsAltTabWindow(id);
+        }
     }
 
     public bool isDesktop
     {
-        get { return Lib.IsDesktop(id); }
+        get
+        {
+            WindowInfo info;
+            return UwcManager.TryGetWindowInfo(id, out info) ?
+                (info.flags & WindowInfoFlags.Desktop) != 0 :
+                Lib.IsDesktop(id);
+        }
     }
 
     public bool isEnabled
@@ -143,7 +169,13 @@ public class UwcWindow
 
     public bool isApplicationFrameWindow
     {
-        get { return Lib.IsApplicationFrameWindow(id); }
+        get
+        {
+            WindowInfo info;
+            return UwcManager.TryGetWindowInfo(id, out info) ?
+                (info.flags & WindowInfoFlags.ApplicationFrameWindow) != 0 :
+                Lib.IsApplicationFrameWindow(id);
+        }
     }
 
     public bool isUWP
@@ -153,7 +185,13 @@ public class UwcWindow
 
     public bool isBackground
     {
-        get { return Lib.IsWindowBackground(id); }
+        get
+        {
+            WindowInfo info;
+            return UwcManager.TryGetWindowInfo(id, out info) ?
+                (info.flags & WindowInfoFlags.Background) != 0 :
+                Lib.IsWindowBackground(id);
+        }
     }
 
     public string title
@@ -168,22 +206,38 @@ public class UwcWindow
 
     public int rawX
     {
-        get { return Lib.GetWindowX(id); }
+        get
+        {
+            WindowInfo info;
+            return UwcManager.TryGetWindowInfo(id, out info) ? info.x : Lib.GetWindowX(id);
+        }
     }
 
     public int rawY
     {
-        get { return Lib.GetWindowY(id); }
+        get
+        {
+            WindowInfo info;
+            return UwcManager.TryGetWindowInfo(id, out info) ? info.y : Lib.GetWindowY(id);
+        }
     }
 
     public int rawWidth
     {
-        get { return Lib.GetWindowWidth(id); }
+        get
+        {
+            WindowInfo info;
+            return UwcManager.TryGetWindowInfo(id, out info) ? info.width : Lib.GetWindowWidth(id);
+        }
     }
 
     public int rawHeight
     {
-        get { return Lib.GetWindowHeight(id); }
+        get
+        {
+            WindowInfo info;
+            return UwcManager.TryGetWindowInfo(id, out info) ? info.height : Lib.GetWindowHeight(id);
+        }
     }
 
     public int x
@@ -208,7 +262,11 @@ public class UwcWindow
 
     public int zOrder
     {
-        get { return Lib.GetWindowZOrder(id); }
+        get
+        {
+            WindowInfo info;
+            return UwcManager.TryGetWindowInfo(id, out info) ? (int)info.zOrder : Lib.GetWindowZOrder(id);
+        }
     }
 
     public System.IntPtr buffer
@@ -269,6 +327,42 @@ public class UwcWindow
         set { Lib.SetWindowCursorDraw(id, value); }
     }
 
+    public int capturePoolDepth
+    {
+        get { return Lib.GetWindowCapturePoolDepth(id); }
+        set { Lib.SetWindowCapturePoolDepth(id, value); }
+    }
+
+    // R16G16B16A16Float is available only with CaptureMode.WindowsGraphicsCapture.
+    public CapturePixelFormat capturePixelFormat
+    {
+        get { return Lib.GetWindowCapturePixelFormat(id); }
+        set 
+        { 
+            if (capturePixelFormat == value) return;
+            Lib.SetWindowCapturePixelFormat(id, value); 
+            if (texture) {
+                ResetWindowTexture();
+            }
+        }
+    }
+
+    public CaptureFrameArrivalMode captureFrameArrivalMode
+    {
+        get { return Lib.GetWindowCaptureFrameArrivalMode(id); }
+        set { Lib.SetWindowCaptureFrameArrivalMode(id, value); }
+    }
+
+    public CaptureFrameStats captureFrameStats
+    {
+        get 
+        { 
+            CaptureFrameStats stats;
+            Lib.GetWindowCaptureFrameStats(id, out stats);
+            return stats;
+        }
+    }
+
     private UnityEvent onCaptured_ = new UnityEvent();
     public UnityEvent onCaptured 
     { 
@@ -288,6 +382,30 @@ public class UwcWindow
         get { return onIconCaptured_; } 
     }
 
+    private UnityEvent onTitleChanged_ = new UnityEvent();
+    public UnityEvent onTitleChanged 
+    { 
+        get { return onTitleChanged_; } 
+    }
+
+    private UnityEvent onMoved_ = new UnityEvent();
+    public UnityEvent onMoved 
+    { 
+        get { return onMoved_; } 
+    }
+
+    private UnityEvent onResized_ = new UnityEvent();
+    public UnityEvent onResized 
+    { 
+        get { return onResized_; } 
+    }
+
+    private UnityEvent onZOrderChanged_ = new UnityEvent();
+    public UnityEvent onZOrderChanged 
+    { 
+        get { return onZOrderChanged_; } 
+    }
+
     public class ChildAddedEvent : UnityEvent<UwcWindow> {}
     private ChildAddedEvent onChildAdded_ = new ChildAddedEvent();
     public ChildAddedEvent onChildAdded
@@ -309,7 +427,12 @@ public class UwcWindow
 
     public void RequestCaptureIcon()
     {
+        // The native icon is resolved in the capture thread, so the texture
+        // is created by UwcManager once its size becomes available.
         Lib.RequestCaptureIcon(id);
+        if (!iconTexture_) {
+            UwcManager.RequestIconTexture(this);
+        }
     }
 
     public void RequestCapture(CapturePriority priority = CapturePriority.High)
@@ -351,7 +474,10 @@ public class UwcWindow
                 Object.DestroyImmediate(backTexture_);
             }
             try {
-                backTexture_ = new Texture2D(w, h, TextureFormat.BGRA32, false);
+                var format = (capturePixelFormat == CapturePixelFormat.R16G16B16A16Float) ?
+                    TextureFormat.RGBAHalf :
+                    TextureFormat.BGRA32;
+                backTexture_ = new Texture2D(w, h, format, false);
                 Lib.SetWindowTexturePtr(id, backTexture_.GetNativeTexturePtr());
                 willTextureSizeChange_ = true;
             } catch (System.Exception e) {
@@ -378,16 +504,17 @@ public class UwcWindow
         CreateWindowTexture(true);
     }
 
-    void CreateIconTexture()
+    internal bool CreateIconTexture()
     {
+        if (iconTexture_) return true;
         var w = iconWidth;
         var h = iconHeight;
-        if (w == 0 || h == 0) return;
+        if (w == 0 || h == 0) return false;
         iconTexture_ = new Texture2D(w, h, TextureFormat.BGRA32, false);
         iconTexture_.filterMode = FilterMode.Bilinear;
         iconTexture_.wrapMode = TextureWrapMode.Clamp;
         Lib.SetWindowIconTexturePtr(id, iconTexture_.GetNativeTexturePtr());
-        errorIconTexture_ = Resources.Load<Texture2D>("uWindowCapture/Textures/uWC_No_Image");
+        return true;
     }
 
     public Color32[] GetPixels(int x, int y, int width, int height)
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <vector>
+
+
+// Minimal benchmark runner: UWC_BENCHMARK() defines a case which passes the
+// measured operation to Benchmark::Run(). Iterations are doubled until the
+// run takes long enough, or run only a few times with --quick (used by ctest).
+class Benchmark
+{
+public:
+    Benchmark(const char* name, bool isQuick)
+        : name_(name)
+        , isQuick_(isQuick)
+    {
+    }
+
+    // Reports the throughput too when an operation processes this many bytes.
+    void SetBytesPerOperation(uint64_t bytes) { bytesPerOperation_ = bytes; }
+
+    template <class Func>
+    void Run(Func&& func)
+    {
+        using clock = std::chrono::steady_clock;
+        const auto minDuration = isQuick_ ? std::chrono::milliseconds(1) : std::chrono::milliseconds(500);
+
+        uint64_t iterations = 1;
+        for (;;)
+        {
+            const auto start = clock::now();
+            for (uint64_t i = 0; i < iterations; ++i)
+            {
+                func();
+            }
+            const auto elapsed = clock::now() - start;
+
+            if (elapsed >= minDuration || iterations >= (1ull << 40))
+            {
+                Report(std::chrono::duration<double, std::nano>(elapsed).count() / iterations);
+                return;
+            }
+            iterations *= 2;
+        }
+    }
+
+    // For cases measuring a whole batch at once, e.g. with multiple threads.
+    void Report(double nanosecondsPerOperation) const
+    {
+        if (bytesPerOperation_ > 0)
+        {
+            const double bytesPerSecond = bytesPerOperation_ * 1e9 / nanosecondsPerOperation;
+            std::printf("%-56s %14.1f ns/op %10.1f MB/s\n", name_, nanosecondsPerOperation, bytesPerSecond / (1024 * 1024));
+        }
+        else
+        {
+            std::printf("%-56s %14.1f ns/op\n", name_, nanosecondsPerOperation);
+        }
+    }
+
+    // Reports a per-operation count the timing alone does not show, e.g. system calls.
+    void ReportCounter(const char* counterName, double valuePerOperation) const
+    {
+        ReportValue(counterName, valuePerOperation, "/op");
+    }
+
+    // Reports a value of the whole run, e.g. a latency percentile.
+    void ReportValue(const char* valueName, double value, const char* unit) const
+    {
+        std::printf("  %-54s %14.1f %s\n", valueName, value, unit);
+    }
+
+    bool IsQuick() const { return isQuick_; }
+
+    // Stores a result of the measured operation so that the compiler cannot remove it.
+    void Consume(uint64_t value) { sink_ = value; }
+
+private:
+    const char* const name_;
+    const bool isQuick_;
+    uint64_t bytesPerOperation_ = 0;
+    volatile uint64_t sink_ = 0;
+};
+
+
+struct BenchmarkCase
+{
+    const char* name;
+    void (*func)(Benchmark&);
+};
+
+
+std::vector<BenchmarkCase>& GetBenchmarkCases();
+
+
+struct BenchmarkRegistrar
+{
+    BenchmarkRegistrar(const char* name, void (*func)(Benchmark&))
+    {
+        GetBenchmarkCases().push_back({ name, func });
+    }
+};
+
+
+#define UWC_BENCHMARK(Name) \
+    static void Name(Benchmark& benchmark); \
+    static BenchmarkRegistrar Name##_registrar(#Name, &Name); \
+    static void Name(Benchmark& benchmark)
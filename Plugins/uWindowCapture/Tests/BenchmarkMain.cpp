@@ -0,0 +1,39 @@
+#include <cstring>
+#include "Benchmark.h"
+
+
+
+std::vector<BenchmarkCase>& GetBenchmarkCases()
+{
+    static std::vector<BenchmarkCase> benchmarkCases;
+    return benchmarkCases;
+}
+
+
+int main(int argc, char** argv)
+{
+    // Usage: uWindowCaptureBenchmarks [--quick] [name filter]
+    bool isQuick = false;
+    const char* filter = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--quick") == 0)
+        {
+            isQuick = true;
+        }
+        else
+        {
+            filter = argv[i];
+        }
+    }
+
+    for (const auto& benchmarkCase : GetBenchmarkCases())
+    {
+        if (filter && !std::strstr(benchmarkCase.name, filter)) continue;
+
+        Benchmark benchmark(benchmarkCase.name, isQuick);
+        benchmarkCase.func(benchmark);
+    }
+
+    return 0;
+}
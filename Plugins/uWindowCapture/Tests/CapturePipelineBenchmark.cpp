@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+#include "RequestQueue.h"
+#include "UploadDevice.h"
+
+
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int kWindowCount = 8;
+    constexpr UINT kWidth = 1280;
+    constexpr UINT kHeight = 720;
+    constexpr UINT kBytesPerPixel = 4;
+
+
+    // A window as seen by the plugin threads: the capture thread writes its buffer,
+    // the upload thread writes the shared texture and the render thread copies the
+    // shared texture into Unity's one.
+    struct SyntheticWindow
+    {
+        std::vector<BYTE> buffer;
+        std::mutex bufferMutex;
+        Clock::time_point captureTime;
+        Clock::time_point uploadedCaptureTime;
+        std::atomic<bool> isUploadRequested = false;
+        std::atomic<bool> isRenderRequested = false;
+        ID3D11Texture2D* unityTexture = nullptr;
+        ID3D11Texture2D* sharedTexture = nullptr;
+        HANDLE sharedHandle = nullptr;
+    };
+
+
+    // The plugin uploads with its own device context while Unity renders with another;
+    // the CPU device stands for both here, so its calls are serialized.
+    class PipelineDevice
+    {
+    public:
+        explicit PipelineDevice(std::vector<std::unique_ptr<SyntheticWindow>>& windows)
+        {
+            for (size_t i = 0; i < windows.size(); ++i)
+            {
+                auto& window = *windows[i];
+                window.buffer.assign(static_cast<size_t>(kWidth) * kHeight * kBytesPerPixel, 0);
+                window.unityTexture = reinterpret_cast<ID3D11Texture2D*>(i + 1);
+                device_.AddTexture(window.unityTexture, kWidth, kHeight, kBytesPerPixel);
+                device_.CreateSharedTexture(window.unityTexture, &window.sharedTexture, &window.sharedHandle);
+            }
+        }
+
+        void Upload(SyntheticWindow& window)
+        {
+            std::scoped_lock lock(window.bufferMutex, mutex_);
+            device_.UpdateTexture(window.sharedTexture, window.buffer.data(), kWidth * kBytesPerPixel);
+            window.uploadedCaptureTime = window.captureTime;
+        }
+
+        // Returns the time since the rendered pixels were captured.
+        Clock::duration Render(SyntheticWindow& window)
+        {
+            std::scoped_lock lock(mutex_);
+            device_.CopyTexture(window.unityTexture, device_.OpenSharedTexture(window.sharedHandle));
+            return Clock::now() - window.uploadedCaptureTime;
+        }
+
+    private:
+        CpuUploadDevice device_;
+        std::mutex mutex_;
+    };
+}
+
+
+// Synthetic windows go through capture, upload and render threads as fast as they can,
+// with requests coalesced per window as in the plugin. Reports the time per rendered
+// window frame, the rendered frames per second and the capture-to-render latency.
+UWC_BENCHMARK(CapturePipeline_8Windows_720p)
+{
+    std::vector<std::unique_ptr<SyntheticWindow>> windows;
+    for (int i = 0; i < kWindowCount; ++i)
+    {
+        windows.push_back(std::make_unique<SyntheticWindow>());
+    }
+    PipelineDevice device(windows);
+
+    RequestQueue<int> uploadQueue;
+    RequestQueue<int> renderQueue;
+    std::atomic<bool> isRunning = true;
+
+    std::thread captureThread([&]
+    {
+        for (int frame = 0; isRunning; ++frame)
+        {
+            for (int i = 0; i < kWindowCount; ++i)
+            {
+                auto& window = *windows[i];
+                {
+                    std::scoped_lock lock(window.bufferMutex);
+                    std::memset(window.buffer.data(), frame & 0xff, window.buffer.size());
+                    window.captureTime = Clock::now();
+                }
+                if (!window.isUploadRequested.exchange(true))
+                {
+                    uploadQueue.Post(i);
+                }
+            }
+            std::this_thread::yield();
+        }
+    });
+
+    std::thread uploadThread([&]
+    {
+        std::vector<int> requests;
+        while (isRunning)
+        {
+            if (!uploadQueue.TakeAll(requests))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (const auto i : requests)
+            {
+                auto& window = *windows[i];
+                window.isUploadRequested = false;
+                device.Upload(window);
+                if (!window.isRenderRequested.exchange(true))
+                {
+                    renderQueue.Post(i);
+                }
+            }
+        }
+    });
+
+    const auto duration = benchmark.IsQuick() ? std::chrono::milliseconds(20) : std::chrono::milliseconds(2000);
+    std::vector<float> latencies;
+    std::vector<int> requests;
+
+    const auto start = Clock::now();
+    while (Clock::now() - start < duration)
+    {
+        if (!renderQueue.TakeAll(requests))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        for (const auto i : requests)
+        {
+            auto& window = *windows[i];
+            window.isRenderRequested = false;
+            const auto latency = device.Render(window);
+            latencies.push_back(std::chrono::duration<float, std::milli>(latency).count());
+        }
+    }
+    const auto elapsed = Clock::now() - start;
+
+    isRunning = false;
+    captureThread.join();
+    uploadThread.join();
+
+    if (latencies.empty()) return;
+
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    benchmark.SetBytesPerOperation(static_cast<uint64_t>(kWidth) * kHeight * kBytesPerPixel);
+    benchmark.Report(seconds * 1e9 / latencies.size());
+
+    const double averageLatency = std::accumulate(latencies.begin(), latencies.end(), 0.0) / latencies.size();
+    const auto p99 = latencies.begin() + latencies.size() * 99 / 100;
+    std::nth_element(latencies.begin(), p99, latencies.end());
+    benchmark.ReportValue("rendered window frames", latencies.size() / seconds, "frames/s");
+    benchmark.ReportValue("capture-to-render latency (average)", averageLatency, "ms");
+    benchmark.ReportValue("capture-to-render latency (p99)", *p99, "ms");
+}
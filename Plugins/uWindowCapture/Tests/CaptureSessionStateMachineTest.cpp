@@ -0,0 +1,236 @@
+#include <vector>
+#include "Test.h"
+#include "CaptureSessionStateMachine.h"
+
+
+
+namespace
+{
+    CaptureSessionTimeouts CreateTimeouts()
+    {
+        CaptureSessionTimeouts timeouts;
+        timeouts.idleTimeout = 1'000;
+        timeouts.warmTimeout = 10'000;
+        timeouts.frameTimeout = 1'000;
+        timeouts.minRestartInterval = 3'000;
+        timeouts.startRetryInterval = 2'000;
+        return timeouts;
+    }
+
+
+    // Performs the actions of the state machine as WindowsGraphicsCapture does,
+    // driven by a virtual clock.
+    class FakeSession
+    {
+    public:
+        CaptureSessionAction Tick(int64_t deltaTime)
+        {
+            now += deltaTime;
+            const auto action = stateMachine.Update(now, timeouts);
+            switch (action)
+            {
+                case CaptureSessionAction::Start:
+                    ++startCount;
+                    stateMachine.OnStarted(canStart, now);
+                    break;
+                case CaptureSessionAction::Stop:
+                    ++stopCount;
+                    stateMachine.OnStopped();
+                    break;
+                case CaptureSessionAction::Restart:
+                    ++restartCount;
+                    break;
+                default:
+                    break;
+            }
+            return action;
+        }
+
+        void Request() { stateMachine.OnRequested(now); }
+        void ReceiveFrame() { stateMachine.OnFrameReceived(now); }
+        CaptureSessionState GetState() const { return stateMachine.GetState(); }
+
+        CaptureSessionStateMachine stateMachine;
+        CaptureSessionTimeouts timeouts = CreateTimeouts();
+        int64_t now = 100'000;
+        bool canStart = true;
+        int startCount = 0;
+        int stopCount = 0;
+        int restartCount = 0;
+    };
+}
+
+
+UWC_TEST(CaptureSessionStateMachine_StartsOnRequest)
+{
+    FakeSession session;
+    UWC_EXPECT(session.Tick(100) == CaptureSessionAction::None);
+    UWC_EXPECT(session.GetState() == CaptureSessionState::Stopped);
+
+    session.Request();
+    UWC_EXPECT(session.Tick(100) == CaptureSessionAction::Start);
+    UWC_EXPECT(session.GetState() == CaptureSessionState::Active);
+    UWC_EXPECT(session.Tick(100) == CaptureSessionAction::None);
+    UWC_EXPECT(session.startCount == 1);
+}
+
+
+UWC_TEST(CaptureSessionStateMachine_RetriesFailedStartAfterInterval)
+{
+    FakeSession session;
+    session.canStart = false;
+
+    session.Request();
+    UWC_EXPECT(session.Tick(100) == CaptureSessionAction::Start);
+    UWC_EXPECT(session.GetState() == CaptureSessionState::Stopped);
+
+    // Requests within the retry interval do not start it again.
+    session.Request();
+    UWC_EXPECT(session.Tick(1'000) == CaptureSessionAction::None);
+    UWC_EXPECT(session.GetState() == CaptureSessionState::Stopped);
+
+    session.canStart = true;
+    UWC_EXPECT(session.Tick(1'001) == CaptureSessionAction::Start);
+    UWC_EXPECT(session.GetState() == CaptureSessionState::Active);
+    UWC_EXPECT(session.startCount == 2);
+}
+
+
+UWC_TEST(CaptureSessionStateMachine_BecomesWarmOnIdleAndActiveOnRequest)
+{
+    FakeSession session;
+    session.Request();
+    session.Tick(100);
+
+    // Frames keep the session active even without new requests.
+    for (int i = 0; i < 5; ++i)
+    {
+        session.Tick(500);
+        session.ReceiveFrame();
+        UWC_EXPECT(session.GetState() == CaptureSessionState::Active);
+    }
+
+    UWC_EXPECT(session.Tick(1'001) == CaptureSessionAction::None);
+    UWC_EXPECT(session.GetState() == CaptureSessionState::Warm);
+
+    // A new request reuses the running session instead of starting it again.
+    session.Tick(5'000);
+    session.Request();
+    UWC_EXPECT(session.Tick(100) == CaptureSessionAction::None);
+    UWC_EXPECT(session.GetState() == CaptureSessionState::Active);
+    UWC_EXPECT(session.startCount == 1);
+    UWC_EXPECT(session.stopCount == 0);
+}
+
+
+UWC_TEST(CaptureSessionStateMachine_RestartsOnFrameTimeout)
+{
+    FakeSession session;
+    session.Request();
+    session.Tick(100);
+
+    // Requested but no frames arrive.
+    session.Tick(600);
+    session.Request();
+    session.Tick(600);
+    session.Request();
+    UWC_EXPECT(session.restartCount == 1);
+
+    // Restarts are throttled by the minimum interval.
+    for (int i = 0; i < 5; ++i)
+    {
+        session.Tick(500);
+        session.Request();
+    }
+    UWC_EXPECT(session.restartCount == 1);
+
+    session.Tick(500);
+    session.Request();
+    session.Tick(100);
+    UWC_EXPECT(session.restartCount == 2);
+    UWC_EXPECT(session.GetState() == CaptureSessionState::Active);
+}
+
+
+UWC_TEST(CaptureSessionStateMachine_RestartsOnRequest)
+{
+    FakeSession session;
+    session.Request();
+    session.Tick(100);
+
+    session.stateMachine.RequestRestart();
+    UWC_EXPECT(session.Tick(100) == CaptureSessionAction::Restart);
+    UWC_EXPECT(session.Tick(100) == CaptureSessionAction::None);
+}
+
+
+UWC_TEST(CaptureSessionStateMachine_StopsWhenWarmExpires)
+{
+    FakeSession session;
+    session.Request();
+    session.Tick(100);
+    session.Tick(1'001);
+    UWC_EXPECT(session.GetState() == CaptureSessionState::Warm);
+
+    UWC_EXPECT(session.Tick(10'000) == CaptureSessionAction::None);
+    UWC_EXPECT(session.Tick(1) == CaptureSessionAction::Stop);
+    UWC_EXPECT(session.GetState() == CaptureSessionState::Stopped);
+
+    // A request after the expiry pays the start again.
+    session.Request();
+    UWC_EXPECT(session.Tick(100) == CaptureSessionAction::Start);
+    UWC_EXPECT(session.startCount == 2);
+}
+
+
+UWC_TEST(CaptureSessionStateMachine_StopsWarmOnRestartRequest)
+{
+    FakeSession session;
+    session.Request();
+    session.Tick(100);
+    session.Tick(1'001);
+    UWC_EXPECT(session.GetState() == CaptureSessionState::Warm);
+
+    session.stateMachine.RequestRestart();
+    UWC_EXPECT(session.Tick(100) == CaptureSessionAction::Stop);
+    UWC_EXPECT(session.GetState() == CaptureSessionState::Stopped);
+}
+
+
+UWC_TEST(CaptureSessionStateMachine_EvictsLeastRecentlyRequestedWarmSessions)
+{
+    const auto timeouts = CreateTimeouts();
+    std::vector<CaptureSessionStateMachine> stateMachines(6);
+
+    // Sessions requested at different times; the last one is kept active.
+    const int64_t requestTimes[] = { 300, 100, 500, 200, 400, 50'000 };
+    for (size_t i = 0; i < stateMachines.size(); ++i)
+    {
+        auto& stateMachine = stateMachines[i];
+        stateMachine.OnRequested(requestTimes[i]);
+        stateMachine.Update(requestTimes[i], timeouts);
+        stateMachine.OnStarted(true, requestTimes[i]);
+        stateMachine.Update(50'000, timeouts);
+    }
+
+    std::vector<CaptureSessionStateMachine*> sessions;
+    for (auto& stateMachine : stateMachines)
+    {
+        sessions.push_back(&stateMachine);
+    }
+    UWC_EXPECT(stateMachines[5].GetState() == CaptureSessionState::Active);
+
+    // Within the capacity nothing is evicted.
+    UWC_EXPECT(SelectWarmSessionsToEvict(sessions, 5).empty());
+
+    const auto evicted = SelectWarmSessionsToEvict(sessions, 2);
+    UWC_EXPECT(evicted.size() == 3);
+    if (evicted.size() == 3)
+    {
+        UWC_EXPECT(evicted[0] == &stateMachines[0]);
+        UWC_EXPECT(evicted[1] == &stateMachines[3]);
+        UWC_EXPECT(evicted[2] == &stateMachines[1]);
+    }
+
+    UWC_EXPECT(SelectWarmSessionsToEvict(sessions, 0).size() == 5);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+// Subset of the Windows types used by the platform-neutral units,
+// for building the tests on hosts other than Windows.
+
+#include <cstdint>
+#include <cstring>
+
+typedef int BOOL;
+typedef unsigned char BYTE;
+typedef char CHAR;
+typedef wchar_t WCHAR;
+typedef long LONG;
+typedef unsigned int UINT;
+typedef unsigned long DWORD;
+typedef int64_t INT64;
+typedef uint64_t UINT64;
+typedef void* HANDLE;
+typedef struct HWND__* HWND;
+typedef struct HMONITOR__* HMONITOR;
+typedef struct HINSTANCE__* HINSTANCE;
+
+struct RECT
+{
+    LONG left;
+    LONG top;
+    LONG right;
+    LONG bottom;
+};
+
+struct POINT
+{
+    LONG x;
+    LONG y;
+};
+
+#define TRUE 1
+#define FALSE 0
+#define CALLBACK
+#define ZeroMemory(Destination, Length) memset((Destination), 0, (Length))
+
+inline BOOL EqualRect(const RECT* a, const RECT* b)
+{
+    return a->left == b->left && a->top == b->top && a->right == b->right && a->bottom == b->bottom;
+}
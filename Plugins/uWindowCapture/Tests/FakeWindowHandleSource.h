@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include "WindowHandleList.h"
+
+
+
+// A synthetic top-level window stack which answers the window list queries
+// like the window API would and records the events a WinEvent hook would report.
+class FakeWindowHandleSource : public IWindowHandleSource
+{
+public:
+    struct State
+    {
+        bool isVisible = false;
+        bool isCloaked = false;
+        bool isExcluded = false; // rejected by the window filter
+        RECT rect = { 0, 0, 640, 480 };
+    };
+
+    HWND Create(size_t zIndex, bool isExcluded = false)
+    {
+        const auto hWnd = NewHandle();
+        State state;
+        state.isExcluded = isExcluded;
+        windows_.emplace(hWnd, state);
+        order_.insert(order_.begin() + (std::min)(zIndex, order_.size()), hWnd);
+        Push(WindowEventType::Created, hWnd);
+        return hWnd;
+    }
+
+    void Destroy(HWND hWnd)
+    {
+        windows_.erase(hWnd);
+        order_.erase(std::find(order_.begin(), order_.end(), hWnd));
+        Push(WindowEventType::Destroyed, hWnd);
+    }
+
+    // Child windows are not in the stack; only their destruction reaches the hook.
+    void DestroyChild()
+    {
+        Push(WindowEventType::Destroyed, NewHandle());
+    }
+
+    void SetVisible(HWND hWnd, bool isVisible)
+    {
+        windows_[hWnd].isVisible = isVisible;
+        Push(isVisible ? WindowEventType::Shown : WindowEventType::Hidden, hWnd);
+    }
+
+    void SetCloaked(HWND hWnd, bool isCloaked)
+    {
+        windows_[hWnd].isCloaked = isCloaked;
+        Push(isCloaked ? WindowEventType::Hidden : WindowEventType::Shown, hWnd);
+    }
+
+    void Minimize(HWND hWnd)
+    {
+        // A minimized window stays visible and moves off screen.
+        windows_[hWnd].rect = { -32000, -32000, -31840, -31972 };
+        Push(WindowEventType::Hidden, hWnd);
+        Push(WindowEventType::Moved, hWnd);
+    }
+
+    void Move(HWND hWnd, LONG dx, LONG dy)
+    {
+        auto& rect = windows_[hWnd].rect;
+        rect = { rect.left + dx, rect.top + dy, rect.right + dx, rect.bottom + dy };
+        Push(WindowEventType::Moved, hWnd);
+    }
+
+    void BringToTop(HWND hWnd)
+    {
+        order_.erase(std::find(order_.begin(), order_.end(), hWnd));
+        order_.insert(order_.begin(), hWnd);
+        Push(WindowEventType::Reordered, hWnd);
+    }
+
+    const std::vector<HWND>& GetOrder() const { return order_; }
+
+    bool IsVisible(HWND hWnd) const
+    {
+        const auto it = windows_.find(hWnd);
+        return it != windows_.end() && it->second.isVisible;
+    }
+
+    const std::vector<WindowEvent>& GetEvents() const { return events_; }
+    void ClearEvents() { events_.clear(); }
+    int GetWalkCount() const { return walkCount_; }
+    int GetQueryCount() const { return queryCount_; }
+
+    void ForEachTopLevelWindow(const std::function<void(HWND hWnd, bool isVisible)>& func) override
+    {
+        ++walkCount_;
+
+        // EnumWindows() takes the list of handles first, so a window destroyed
+        // during the walk is still visited but is no longer visible.
+        const auto order = order_;
+        for (const auto hWnd : order)
+        {
+            func(hWnd, IsVisible(hWnd));
+        }
+    }
+
+    bool GetWindowData(HWND hWnd, WindowHandleData& data) override
+    {
+        ++queryCount_;
+        const auto it = windows_.find(hWnd);
+        if (it == windows_.end()) return false;
+
+        const auto& state = it->second;
+        if (!state.isVisible || state.isExcluded) return false;
+
+        data = {};
+        data.hWnd = hWnd;
+        data.hMonitor = reinterpret_cast<HMONITOR>(1);
+        data.windowRect = state.rect;
+        data.clientRect = { 0, 0, state.rect.right - state.rect.left, state.rect.bottom - state.rect.top };
+        data.isHitTestVisible = !state.isCloaked;
+        return true;
+    }
+
+    void UpdateWindowRect(WindowHandleData& data) override
+    {
+        const auto& rect = windows_[data.hWnd].rect;
+        data.windowRect = rect;
+        data.clientRect = { 0, 0, rect.right - rect.left, rect.bottom - rect.top };
+    }
+
+    void GetDesktopData(std::vector<WindowHandleData>& dataList) override
+    {
+        WindowHandleData data = {};
+        data.isDesktop = TRUE;
+        data.hMonitor = reinterpret_cast<HMONITOR>(1);
+        data.windowRect = { 0, 0, 1920, 1080 };
+        data.clientRect = data.windowRect;
+        data.isHitTestVisible = TRUE;
+        dataList.push_back(data);
+    }
+
+private:
+    HWND NewHandle()
+    {
+        // Spread like real handles so that the sorted order differs from the creation order.
+        return reinterpret_cast<HWND>((0x10000 + (++lastHandle_ * 7919) % 100003) * 4);
+    }
+
+    void Push(WindowEventType type, HWND hWnd)
+    {
+        events_.push_back({ type, hWnd });
+    }
+
+    std::unordered_map<HWND, State> windows_;
+    std::vector<HWND> order_; // from the top
+    std::vector<WindowEvent> events_;
+    uintptr_t lastHandle_ = 0;
+    int walkCount_ = 0;
+    int queryCount_ = 0;
+};
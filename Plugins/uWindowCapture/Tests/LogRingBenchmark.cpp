@@ -0,0 +1,166 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+#include "LogRing.h"
+
+
+
+namespace
+{
+    constexpr int kProducerCount = 4;
+
+
+    std::string CreateMessage(size_t length)
+    {
+        std::string message = "WindowTexture::Upload() => Texture size is wrong.";
+        message.resize(length, '.');
+        return message;
+    }
+}
+
+
+UWC_BENCHMARK(LogRing_PushAndDrain_80Bytes)
+{
+    LogRing ring;
+    const auto message = CreateMessage(80);
+    std::vector<LogEntry> entries;
+    entries.reserve(LogRing::kCapacity);
+
+    UINT64 sequence = 0;
+    benchmark.SetBytesPerOperation(message.size());
+    benchmark.Run([&]
+    {
+        // Drain as the writer does once the ring is full.
+        if (!ring.Push(Debug::Level::Error, sequence++, std::string(message)))
+        {
+            ring.PopAll([&](LogEntry& entry)
+            {
+                entries.push_back(std::move(entry));
+            });
+            entries.clear();
+        }
+    });
+}
+
+
+UWC_BENCHMARK(LogRing_PushAndDrain_1KB)
+{
+    // Longer than the 256 bytes at which messages used to be truncated.
+    LogRing ring;
+    const auto message = CreateMessage(1024);
+    std::vector<LogEntry> entries;
+    entries.reserve(LogRing::kCapacity);
+
+    UINT64 sequence = 0;
+    benchmark.SetBytesPerOperation(message.size());
+    benchmark.Run([&]
+    {
+        if (!ring.Push(Debug::Level::Error, sequence++, std::string(message)))
+        {
+            ring.PopAll([&](LogEntry& entry)
+            {
+                entries.push_back(std::move(entry));
+            });
+            entries.clear();
+        }
+    });
+}
+
+
+UWC_BENCHMARK(LogRateLimiter_Check_SameCallSite)
+{
+    // After the burst every message from the site is suppressed.
+    LogRateLimiter limiter;
+    uint32_t suppressedCount = 0;
+
+    benchmark.Run([&]
+    {
+        limiter.Check(1, 0, &suppressedCount);
+    });
+}
+
+
+UWC_BENCHMARK(LogRateLimiter_Check_DistinctCallSites)
+{
+    LogRateLimiter limiter;
+    uint32_t suppressedCount = 0;
+
+    uintptr_t key = 0;
+    INT64 now = 0;
+    benchmark.Run([&]
+    {
+        limiter.Check(key++ % LogRateLimiter::kSlotCount, now += 10, &suppressedCount);
+    });
+}
+
+
+UWC_BENCHMARK(LogRing_Throughput_4Producers)
+{
+    // Each producer owns a ring and a writer thread keeps draining all of them,
+    // as Debug does. Producers retry instead of dropping messages on a full ring
+    // so that this reports the time per message written by the writer.
+    const int messageCount = benchmark.IsQuick() ? 1000 : 1'000'000;
+    const auto message = CreateMessage(80);
+
+    std::vector<std::unique_ptr<LogRing>> rings;
+    for (int i = 0; i < kProducerCount; ++i)
+    {
+        rings.push_back(std::make_unique<LogRing>());
+    }
+
+    std::atomic<bool> isProducing = true;
+    std::atomic<UINT64> sequence = 0;
+    UINT64 writtenCount = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::thread writer([&]
+    {
+        std::vector<LogEntry> entries;
+        for (bool isLast = false; !isLast;)
+        {
+            isLast = !isProducing;
+            for (const auto& ring : rings)
+            {
+                ring->PopAll([&](LogEntry& entry)
+                {
+                    entries.push_back(std::move(entry));
+                });
+            }
+            writtenCount += entries.size();
+            entries.clear();
+            std::this_thread::yield();
+        }
+    });
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducerCount; ++p)
+    {
+        producers.emplace_back([&, p]
+        {
+            for (int i = 0; i < messageCount; ++i)
+            {
+                const auto messageSequence = sequence++;
+                while (!rings[p]->Push(Debug::Level::Log, messageSequence, std::string(message)))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+    isProducing = false;
+    writer.join();
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    benchmark.SetBytesPerOperation(message.size());
+    benchmark.Report(std::chrono::duration<double, std::nano>(elapsed).count() / writtenCount);
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+#include "Message.h"
+
+
+
+namespace
+{
+    constexpr int kProducerCount = 4;
+    constexpr size_t kRingSize = 4096;
+    constexpr int kBurstSize = 256;
+
+
+    // The previous queue: producers append to a vector under a mutex
+    // and the consumer swaps it out under the same mutex.
+    class LockedMessageQueue
+    {
+    public:
+        void Push(const Message& message)
+        {
+            std::scoped_lock lock(mutex_);
+            messages_.push_back(message);
+        }
+
+        void PopAll(std::vector<Message>& outMessages)
+        {
+            std::scoped_lock lock(mutex_);
+            outMessages.insert(outMessages.end(), messages_.begin(), messages_.end());
+            messages_.clear();
+        }
+
+    private:
+        std::vector<Message> messages_;
+        std::mutex mutex_;
+    };
+
+
+    // Producers push bursts of messages, as window events and capture threads
+    // do, while a consumer collects them into a batch as MessageManager::Swap() does; reports the time per message and the
+    // push latency, which includes waiting for the consumer holding the lock.
+    template <class Queue>
+    void RunProducersAndConsumer(Benchmark& benchmark, Queue& queue)
+    {
+        const int messageCount = benchmark.IsQuick() ? 1000 : 500'000;
+        std::atomic<int> runningProducerCount = kProducerCount;
+        uint64_t consumedCount = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        std::thread consumer([&]
+        {
+            std::vector<Message> batch;
+            for (;;)
+            {
+                // Read the count first so that the last pop sees every message.
+                const bool isProducing = runningProducerCount > 0;
+                batch.clear();
+                queue.PopAll(batch);
+                consumedCount += batch.size();
+                if (!isProducing) break;
+                std::this_thread::yield();
+            }
+        });
+
+        std::vector<std::vector<float>> latencies(kProducerCount);
+        std::vector<std::thread> producers;
+        for (int p = 0; p < kProducerCount; ++p)
+        {
+            producers.emplace_back([&, p]
+            {
+                auto& producerLatencies = latencies[p];
+                producerLatencies.reserve(messageCount);
+                for (int i = 0; i < messageCount; ++i)
+                {
+                    const auto pushStart = std::chrono::steady_clock::now();
+                    queue.Push(Message(MessageType::WindowCaptured, i, reinterpret_cast<void*>(static_cast<intptr_t>(p))));
+                    producerLatencies.push_back(std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - pushStart).count());
+                    if (i % kBurstSize == kBurstSize - 1)
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+                --runningProducerCount;
+            });
+        }
+        for (auto& producer : producers)
+        {
+            producer.join();
+        }
+        consumer.join();
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        benchmark.Consume(consumedCount);
+        benchmark.Report(std::chrono::duration<double, std::nano>(elapsed).count() / (static_cast<double>(messageCount) * kProducerCount));
+
+        std::vector<float> allLatencies;
+        for (const auto& producerLatencies : latencies)
+        {
+            allLatencies.insert(allLatencies.end(), producerLatencies.begin(), producerLatencies.end());
+        }
+        const auto p99 = allLatencies.begin() + allLatencies.size() * 99 / 100;
+        std::nth_element(allLatencies.begin(), p99, allLatencies.end());
+        benchmark.ReportValue("p99 push latency", *p99, "ns");
+        benchmark.ReportValue("max push latency", *std::max_element(allLatencies.begin(), allLatencies.end()), "ns");
+    }
+}
+
+
+UWC_BENCHMARK(MessageRing_4Producers_ConcurrentSwap)
+{
+    MessageRing<Message> ring(kRingSize);
+    RunProducersAndConsumer(benchmark, ring);
+}
+
+
+UWC_BENCHMARK(LockedMessageQueue_4Producers_ConcurrentSwap)
+{
+    LockedMessageQueue queue;
+    RunProducersAndConsumer(benchmark, queue);
+}
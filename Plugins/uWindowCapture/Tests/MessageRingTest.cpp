@@ -0,0 +1,121 @@
+#include <thread>
+#include <vector>
+#include "Test.h"
+#include "Message.h"
+
+
+
+namespace
+{
+    Message MakeMessage(int producer, int index)
+    {
+        return Message(MessageType::WindowCaptured, index, reinterpret_cast<void*>(static_cast<intptr_t>(producer)));
+    }
+
+
+    int GetProducer(const Message& message)
+    {
+        return static_cast<int>(reinterpret_cast<intptr_t>(message.userData));
+    }
+}
+
+
+UWC_TEST(MessageRing_KeepsOrderWithinCapacity)
+{
+    MessageRing<Message> ring(16);
+    std::vector<Message> messages;
+
+    for (int round = 0; round < 3; ++round)
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            ring.Push(MakeMessage(0, round * 16 + i));
+        }
+        UWC_EXPECT(!ring.HasOverflowed());
+        ring.PopAll(messages);
+    }
+
+    UWC_EXPECT(messages.size() == 48);
+    for (int i = 0; i < static_cast<int>(messages.size()); ++i)
+    {
+        UWC_EXPECT(messages[i].windowId == i);
+    }
+}
+
+
+UWC_TEST(MessageRing_KeepsOrderOnOverflow)
+{
+    MessageRing<Message> ring(8);
+    std::vector<Message> messages;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        ring.Push(MakeMessage(0, i));
+    }
+    UWC_EXPECT(ring.HasOverflowed());
+
+    ring.PopAll(messages);
+    UWC_EXPECT(!ring.HasOverflowed());
+    UWC_EXPECT(messages.size() == 100);
+    for (int i = 0; i < static_cast<int>(messages.size()); ++i)
+    {
+        UWC_EXPECT(messages[i].windowId == i);
+    }
+
+    // The ring is used again once the overflow buffer has been drained.
+    messages.clear();
+    ring.Push(MakeMessage(0, 100));
+    UWC_EXPECT(!ring.HasOverflowed());
+    ring.PopAll(messages);
+    UWC_EXPECT(messages.size() == 1 && messages[0].windowId == 100);
+}
+
+
+UWC_TEST(MessageRing_KeepsOrderPerProducerWithConcurrentConsumer)
+{
+    constexpr int kProducerCount = 4;
+    constexpr int kMessageCount = 20000;
+
+    MessageRing<Message> ring(64);
+    std::atomic<int> finishedProducerCount = 0;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducerCount; ++p)
+    {
+        producers.emplace_back([&, p]
+        {
+            for (int i = 0; i < kMessageCount; ++i)
+            {
+                ring.Push(MakeMessage(p, i));
+            }
+            ++finishedProducerCount;
+        });
+    }
+
+    std::vector<Message> messages;
+    while (finishedProducerCount < kProducerCount)
+    {
+        ring.PopAll(messages);
+    }
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+    ring.PopAll(messages);
+
+    UWC_EXPECT(messages.size() == static_cast<size_t>(kProducerCount) * kMessageCount);
+
+    int nextIndices[kProducerCount] = {};
+    bool isOrdered = true;
+    for (const auto& message : messages)
+    {
+        auto& next = nextIndices[GetProducer(message)];
+        isOrdered = isOrdered && message.windowId == next;
+        ++next;
+    }
+    UWC_EXPECT(isOrdered);
+    for (int p = 0; p < kProducerCount; ++p)
+    {
+        UWC_EXPECT(nextIndices[p] == kMessageCount);
+    }
+}
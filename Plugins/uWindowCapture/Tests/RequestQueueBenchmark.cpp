@@ -0,0 +1,152 @@
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Benchmark.h"
+#include "RequestQueue.h"
+
+
+
+namespace
+{
+    constexpr int kInstanceCount = 500;
+
+
+    struct FakeInstance
+    {
+        std::atomic<bool> isStartRequested = { false };
+        std::atomic<bool> isUpdateRequested = { false };
+    };
+
+
+    std::vector<std::shared_ptr<FakeInstance>> CreateInstances()
+    {
+        std::vector<std::shared_ptr<FakeInstance>> instances;
+        for (int i = 0; i < kInstanceCount; ++i)
+        {
+            instances.push_back(std::make_shared<FakeInstance>());
+        }
+        return instances;
+    }
+
+
+    // The previous update: every iteration of the capture loop scanned
+    // all the instances under the lock to find start requests.
+    class ScanningManager
+    {
+    public:
+        explicit ScanningManager(const std::vector<std::shared_ptr<FakeInstance>>& instances)
+            : instances_(instances.begin(), instances.end())
+        {
+        }
+
+        int Update()
+        {
+            std::scoped_lock lock(mutex_);
+
+            int count = 0;
+            for (const auto& instance : instances_)
+            {
+                if (instance->isStartRequested.exchange(false)) ++count;
+            }
+            return count;
+        }
+
+    private:
+        std::list<std::shared_ptr<FakeInstance>> instances_;
+        std::mutex mutex_;
+    };
+
+
+    // Posts a request once per instance as WindowsGraphicsCapture::RequestStart() does.
+    void Request(RequestQueue<std::weak_ptr<FakeInstance>>& queue, const std::shared_ptr<FakeInstance>& instance)
+    {
+        if (!instance->isUpdateRequested.exchange(true))
+        {
+            queue.Post(instance);
+        }
+    }
+
+
+    int Process(const std::vector<std::weak_ptr<FakeInstance>>& requests)
+    {
+        int count = 0;
+        for (const auto& weakInstance : requests)
+        {
+            if (const auto instance = weakInstance.lock())
+            {
+                instance->isUpdateRequested = false;
+                ++count;
+            }
+        }
+        return count;
+    }
+}
+
+
+UWC_BENCHMARK(RequestQueue_Idle_500Instances)
+{
+    // Most capture loop iterations have no request at all.
+    const auto instances = CreateInstances();
+    RequestQueue<std::weak_ptr<FakeInstance>> queue;
+    std::vector<std::weak_ptr<FakeInstance>> requests;
+
+    benchmark.Run([&]
+    {
+        if (queue.TakeAll(requests))
+        {
+            Process(requests);
+        }
+    });
+}
+
+
+UWC_BENCHMARK(ScanAllInstances_Idle_500Instances)
+{
+    const auto instances = CreateInstances();
+    ScanningManager manager(instances);
+
+    benchmark.Run([&]
+    {
+        manager.Update();
+    });
+}
+
+
+UWC_BENCHMARK(RequestQueue_10Requests_500Instances)
+{
+    const auto instances = CreateInstances();
+    RequestQueue<std::weak_ptr<FakeInstance>> queue;
+    std::vector<std::weak_ptr<FakeInstance>> requests;
+
+    size_t next = 0;
+    benchmark.Run([&]
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            Request(queue, instances[next++ % kInstanceCount]);
+        }
+        if (queue.TakeAll(requests))
+        {
+            Process(requests);
+        }
+    });
+}
+
+
+UWC_BENCHMARK(ScanAllInstances_10Requests_500Instances)
+{
+    const auto instances = CreateInstances();
+    ScanningManager manager(instances);
+
+    size_t next = 0;
+    benchmark.Run([&]
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            instances[next++ % kInstanceCount]->isStartRequested = true;
+        }
+        manager.Update();
+    });
+}
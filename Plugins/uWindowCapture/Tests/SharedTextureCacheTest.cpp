@@ -0,0 +1,124 @@
+#include <vector>
+#include <algorithm>
+#include "Test.h"
+#include "SharedTextureCache.h"
+
+
+
+namespace
+{
+    // Counts the calls and hands out distinct fake texture pointers.
+    class CountingSharedTextureDevice : public ISharedTextureDevice
+    {
+    public:
+        ID3D11Texture2D* OpenSharedTexture(HANDLE sharedHandle) override
+        {
+            ++openCount;
+            if (sharedHandle == failingHandle) return nullptr;
+
+            const auto texture = reinterpret_cast<ID3D11Texture2D*>(++lastTextureId);
+            openedTextures.push_back(texture);
+            return texture;
+        }
+
+        void ReleaseSharedTexture(ID3D11Texture2D* texture) override
+        {
+            ++releaseCount;
+            const auto it = std::find(openedTextures.begin(), openedTextures.end(), texture);
+            if (it != openedTextures.end())
+            {
+                openedTextures.erase(it);
+            }
+        }
+
+        int openCount = 0;
+        int releaseCount = 0;
+        HANDLE failingHandle = nullptr;
+        uintptr_t lastTextureId = 0;
+        std::vector<ID3D11Texture2D*> openedTextures;
+    };
+
+
+    HANDLE ToHandle(uintptr_t value)
+    {
+        return reinterpret_cast<HANDLE>(value);
+    }
+}
+
+
+UWC_TEST(SharedTextureCache_OpensHandleOnceAndReusesIt)
+{
+    const auto device = std::make_shared<CountingSharedTextureDevice>();
+    SharedTextureCache cache(device);
+
+    const auto texture = cache.Open(ToHandle(1));
+    UWC_EXPECT(texture != nullptr);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        UWC_EXPECT(cache.Open(ToHandle(1)) == texture);
+    }
+
+    UWC_EXPECT(device->openCount == 1);
+    UWC_EXPECT(device->releaseCount == 0);
+}
+
+
+UWC_TEST(SharedTextureCache_ReopensWhenHandleChangesOnResize)
+{
+    const auto device = std::make_shared<CountingSharedTextureDevice>();
+    SharedTextureCache cache(device);
+
+    const auto texture1 = cache.Open(ToHandle(1));
+    cache.Open(ToHandle(1));
+
+    // Resizing recreates the shared texture, which comes with a new handle.
+    const auto texture2 = cache.Open(ToHandle(2));
+    UWC_EXPECT(texture2 != nullptr);
+    UWC_EXPECT(texture2 != texture1);
+    UWC_EXPECT(device->openCount == 2);
+    UWC_EXPECT(device->releaseCount == 1);
+    UWC_EXPECT(device->openedTextures.size() == 1);
+
+    UWC_EXPECT(cache.Open(ToHandle(2)) == texture2);
+    UWC_EXPECT(device->openCount == 2);
+}
+
+
+UWC_TEST(SharedTextureCache_ReleasesOnResetAndDestruction)
+{
+    const auto device = std::make_shared<CountingSharedTextureDevice>();
+
+    {
+        SharedTextureCache cache(device);
+        cache.Open(ToHandle(1));
+        cache.Reset();
+        UWC_EXPECT(device->releaseCount == 1);
+
+        cache.Open(ToHandle(1));
+        UWC_EXPECT(device->openCount == 2);
+    }
+
+    UWC_EXPECT(device->releaseCount == 2);
+    UWC_EXPECT(device->openedTextures.empty());
+}
+
+
+UWC_TEST(SharedTextureCache_RetriesAfterFailure)
+{
+    const auto device = std::make_shared<CountingSharedTextureDevice>();
+    SharedTextureCache cache(device);
+
+    UWC_EXPECT(cache.Open(nullptr) == nullptr);
+    UWC_EXPECT(device->openCount == 0);
+
+    device->failingHandle = ToHandle(1);
+    UWC_EXPECT(cache.Open(ToHandle(1)) == nullptr);
+    UWC_EXPECT(cache.Open(ToHandle(1)) == nullptr);
+    UWC_EXPECT(device->openCount == 2);
+
+    device->failingHandle = nullptr;
+    UWC_EXPECT(cache.Open(ToHandle(1)) != nullptr);
+    UWC_EXPECT(device->openCount == 3);
+    UWC_EXPECT(device->releaseCount == 0);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+
+// Minimal test registry: UWC_TEST() defines a test case and UWC_EXPECT()
+// records a failure without stopping the case.
+struct TestCase
+{
+    const char* name;
+    void (*func)();
+};
+
+
+std::vector<TestCase>& GetTestCases();
+void AddTestFailure(const char* file, int line, const char* expr);
+
+
+struct TestRegistrar
+{
+    TestRegistrar(const char* name, void (*func)())
+    {
+        GetTestCases().push_back({ name, func });
+    }
+};
+
+
+#define UWC_TEST(Name) \
+    static void Name(); \
+    static TestRegistrar Name##_registrar(#Name, &Name); \
+    static void Name()
+
+#define UWC_EXPECT(Expr) \
+    do { if (!(Expr)) AddTestFailure(__FILE__, __LINE__, #Expr); } while (0)
@@ -0,0 +1,50 @@
+#include <cstring>
+#include "Test.h"
+
+
+
+namespace
+{
+    int g_failureCount = 0;
+}
+
+
+std::vector<TestCase>& GetTestCases()
+{
+    static std::vector<TestCase> testCases;
+    return testCases;
+}
+
+
+void AddTestFailure(const char* file, int line, const char* expr)
+{
+    ++g_failureCount;
+    std::printf("%s(%d): UWC_EXPECT(%s) failed\n", file, line, expr);
+}
+
+
+int main(int argc, char** argv)
+{
+    // An optional argument runs only the cases whose name contains it.
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+
+    int runCount = 0;
+    int failedCaseCount = 0;
+
+    for (const auto& testCase : GetTestCases())
+    {
+        if (filter && !std::strstr(testCase.name, filter)) continue;
+
+        const auto failureCount = g_failureCount;
+        testCase.func();
+        ++runCount;
+
+        const bool isPassed = g_failureCount == failureCount;
+        if (!isPassed) ++failedCaseCount;
+        std::printf("[%s] %s\n", isPassed ? "  OK  " : "FAILED", testCase.name);
+    }
+
+    std::printf("%d / %d test cases passed.\n", runCount - failedCaseCount, runCount);
+
+    return failedCaseCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#include <memory>
+#include "Benchmark.h"
+#include "UploadDevice.h"
+
+
+
+namespace
+{
+    constexpr UINT kWidth = 1920;
+    constexpr UINT kHeight = 1080;
+
+
+    ID3D11Texture2D* ToTexture(uintptr_t value)
+    {
+        return reinterpret_cast<ID3D11Texture2D*>(value);
+    }
+
+
+    // Runs through the interface as UploadManager does.
+    std::unique_ptr<IUploadDevice> CreateDevice()
+    {
+        auto device = std::make_unique<CpuUploadDevice>();
+        device->AddTexture(ToTexture(1), kWidth, kHeight, 4);
+        device->AddTexture(ToTexture(2), kWidth, kHeight, 4);
+        return device;
+    }
+}
+
+
+UWC_BENCHMARK(UploadDevice_UpdateTexture_1080p)
+{
+    const auto device = CreateDevice();
+    const std::vector<BYTE> buffer(kWidth * kHeight * 4, 0x80);
+
+    benchmark.SetBytesPerOperation(buffer.size());
+    benchmark.Run([&]
+    {
+        device->UpdateTexture(ToTexture(1), buffer.data(), kWidth * 4);
+    });
+}
+
+
+UWC_BENCHMARK(UploadDevice_UpdateTexture_1080p_CroppedRows)
+{
+    // Win32 captures upload the client area out of a larger window buffer.
+    constexpr UINT kBufferWidth = kWidth + 16;
+    const auto device = CreateDevice();
+    const std::vector<BYTE> buffer(kBufferWidth * (kHeight + 40) * 4, 0x80);
+
+    benchmark.SetBytesPerOperation(static_cast<uint64_t>(kWidth) * kHeight * 4);
+    benchmark.Run([&]
+    {
+        device->UpdateTexture(ToTexture(1), buffer.data() + (8 + 32 * kBufferWidth) * 4, kBufferWidth * 4);
+    });
+}
+
+
+UWC_BENCHMARK(UploadDevice_CopyTexture_1080p)
+{
+    const auto device = CreateDevice();
+
+    benchmark.SetBytesPerOperation(static_cast<uint64_t>(kWidth) * kHeight * 4);
+    benchmark.Run([&]
+    {
+        device->CopyTexture(ToTexture(2), ToTexture(1));
+    });
+}
@@ -0,0 +1,90 @@
+#include "Test.h"
+#include "UploadDevice.h"
+
+
+
+namespace
+{
+    ID3D11Texture2D* ToTexture(uintptr_t value)
+    {
+        return reinterpret_cast<ID3D11Texture2D*>(value);
+    }
+}
+
+
+UWC_TEST(CpuUploadDevice_UpdatesTextureFromPitchedRows)
+{
+    CpuUploadDevice device;
+    const auto texture = ToTexture(1);
+    device.AddTexture(texture, 2, 2, 4);
+
+    // 2x2 pixels cropped from a 3 pixels wide buffer.
+    std::vector<BYTE> buffer(3 * 2 * 4);
+    for (size_t i = 0; i < buffer.size(); ++i)
+    {
+        buffer[i] = static_cast<BYTE>(i);
+    }
+
+    UWC_EXPECT(device.UpdateTexture(texture, buffer.data(), 3 * 4));
+
+    const auto pixels = device.GetPixels(texture);
+    UWC_EXPECT(pixels[0] == 0);
+    UWC_EXPECT(pixels[7] == 7);
+    UWC_EXPECT(pixels[8] == 12);
+    UWC_EXPECT(pixels[15] == 19);
+}
+
+
+UWC_TEST(CpuUploadDevice_FailsWithoutWriting)
+{
+    CpuUploadDevice device;
+    const auto texture = ToTexture(1);
+    device.AddTexture(texture, 2, 2, 4);
+
+    const std::vector<BYTE> buffer(2 * 2 * 4, 0xff);
+    UWC_EXPECT(!device.UpdateTexture(ToTexture(2), buffer.data(), 2 * 4));
+    UWC_EXPECT(!device.UpdateTexture(texture, nullptr, 2 * 4));
+    UWC_EXPECT(!device.UpdateTexture(texture, buffer.data(), 4));
+    UWC_EXPECT(device.GetPixels(texture)[0] == 0);
+
+    device.AddTexture(ToTexture(3), 4, 1, 4);
+    UWC_EXPECT(!device.CopyTexture(ToTexture(3), texture));
+    UWC_EXPECT(!device.CopyTexture(texture, nullptr));
+}
+
+
+UWC_TEST(CpuUploadDevice_CopiesTexture)
+{
+    CpuUploadDevice device;
+    device.AddTexture(ToTexture(1), 2, 2, 4);
+    device.AddTexture(ToTexture(2), 2, 2, 4);
+
+    const std::vector<BYTE> buffer(2 * 2 * 4, 0x7f);
+    UWC_EXPECT(device.UpdateTexture(ToTexture(1), buffer.data(), 2 * 4));
+    UWC_EXPECT(device.CopyTexture(ToTexture(2), ToTexture(1)));
+    UWC_EXPECT(device.GetPixels(ToTexture(2))[15] == 0x7f);
+}
+
+
+UWC_TEST(CpuUploadDevice_CreatesSharedTextureInSourceLayout)
+{
+    CpuUploadDevice device;
+    device.AddTexture(ToTexture(1), 2, 2, 4);
+
+    ID3D11Texture2D* shared = nullptr;
+    HANDLE handle = nullptr;
+    UWC_EXPECT(device.CreateSharedTexture(ToTexture(1), &shared, &handle));
+    UWC_EXPECT(shared && shared != ToTexture(1));
+    UWC_EXPECT(device.OpenSharedTexture(handle) == shared);
+
+    // Unity's texture is updated from the opened shared texture in the render thread.
+    const std::vector<BYTE> buffer(2 * 2 * 4, 0x7f);
+    UWC_EXPECT(device.UpdateTexture(shared, buffer.data(), 2 * 4));
+    UWC_EXPECT(device.CopyTexture(ToTexture(1), device.OpenSharedTexture(handle)));
+    UWC_EXPECT(device.GetPixels(ToTexture(1))[15] == 0x7f);
+
+    UWC_EXPECT(!device.CreateSharedTexture(ToTexture(2), &shared, &handle));
+
+    device.RemoveTexture(shared);
+    UWC_EXPECT(device.OpenSharedTexture(handle) == nullptr);
+}
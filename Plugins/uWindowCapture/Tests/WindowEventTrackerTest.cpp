@@ -0,0 +1,208 @@
+#include <vector>
+#include <algorithm>
+#include "Test.h"
+#include "WindowEventTracker.h"
+
+
+
+namespace
+{
+    constexpr INT64 kFullUpdateInterval = 1'000'000;
+
+
+    HWND MakeWindow(uintptr_t id)
+    {
+        return reinterpret_cast<HWND>(id);
+    }
+
+
+    // One line of a recorded WinEvent stream: either an event or a window list update.
+    struct ReplayStep
+    {
+        INT64 time; // [us]
+        bool isUpdate;
+        WindowEvent event;
+    };
+
+
+    ReplayStep Event(INT64 time, WindowEventType type, uintptr_t id)
+    {
+        return { time, false, { type, MakeWindow(id) } };
+    }
+
+
+    ReplayStep Update(INT64 time)
+    {
+        return { time, true, { WindowEventType::Moved, nullptr } };
+    }
+
+
+    std::vector<WindowEventTracker::Changes> Replay(WindowEventTracker& tracker, const std::vector<ReplayStep>& steps)
+    {
+        std::vector<WindowEventTracker::Changes> results;
+        for (const auto& step : steps)
+        {
+            if (step.isUpdate)
+            {
+                auto changes = tracker.Consume(step.time, kFullUpdateInterval);
+                std::sort(changes.shownWindows.begin(), changes.shownWindows.end());
+                std::sort(changes.hiddenWindows.begin(), changes.hiddenWindows.end());
+                std::sort(changes.movedWindows.begin(), changes.movedWindows.end());
+                std::sort(changes.renamedWindows.begin(), changes.renamedWindows.end());
+                results.push_back(changes);
+            }
+            else
+            {
+                tracker.Push(step.event);
+            }
+        }
+        return results;
+    }
+
+
+    bool Equals(const std::vector<HWND>& windows, std::vector<uintptr_t> ids)
+    {
+        std::vector<HWND> expected;
+        for (const auto id : ids) expected.push_back(MakeWindow(id));
+        std::sort(expected.begin(), expected.end());
+        return windows == expected;
+    }
+}
+
+
+UWC_TEST(WindowEventTracker_StartsWithFullUpdate)
+{
+    WindowEventTracker tracker;
+    const auto results = Replay(tracker, {
+        Update(0),
+        Update(16'000),
+    });
+
+    UWC_EXPECT(results[0].needsFullUpdate);
+    UWC_EXPECT(!results[1].needsFullUpdate);
+    UWC_EXPECT(results[1].movedWindows.empty());
+    UWC_EXPECT(results[1].renamedWindows.empty());
+}
+
+
+UWC_TEST(WindowEventTracker_ReplaysMovesAndRenames)
+{
+    WindowEventTracker tracker;
+    const auto results = Replay(tracker, {
+        Update(0),
+        // Dragging a window reports many location changes for the same handle.
+        Event(1'000, WindowEventType::Moved, 1),
+        Event(2'000, WindowEventType::Moved, 1),
+        Event(3'000, WindowEventType::Moved, 2),
+        Event(4'000, WindowEventType::NameChanged, 3),
+        Event(5'000, WindowEventType::NameChanged, 3),
+        Update(16'000),
+        Update(32'000),
+    });
+
+    UWC_EXPECT(!results[1].needsFullUpdate);
+    UWC_EXPECT(Equals(results[1].movedWindows, { 1, 2 }));
+    UWC_EXPECT(Equals(results[1].renamedWindows, { 3 }));
+
+    UWC_EXPECT(!results[2].needsFullUpdate);
+    UWC_EXPECT(results[2].movedWindows.empty());
+    UWC_EXPECT(results[2].renamedWindows.empty());
+}
+
+
+UWC_TEST(WindowEventTracker_ReplaysListChanges)
+{
+    WindowEventTracker tracker;
+    const auto results = Replay(tracker, {
+        Update(0),
+        Event(1'000, WindowEventType::Created, 1),
+        Event(2'000, WindowEventType::Shown, 1),
+        Event(3'000, WindowEventType::Hidden, 2),
+        // The last state of a window wins.
+        Event(4'000, WindowEventType::Shown, 3),
+        Event(5'000, WindowEventType::Destroyed, 3),
+        Update(16'000),
+        Event(17'000, WindowEventType::Created, 4),
+        Update(32'000),
+        Event(33'000, WindowEventType::Reordered, 5),
+        Update(48'000),
+    });
+
+    UWC_EXPECT(!results[1].needsFullUpdate);
+    UWC_EXPECT(results[1].needsZOrderUpdate);
+    UWC_EXPECT(Equals(results[1].shownWindows, { 1 }));
+    UWC_EXPECT(Equals(results[1].hiddenWindows, { 2, 3 }));
+
+    // A created window does not change the z-order until it is shown.
+    UWC_EXPECT(!results[2].needsFullUpdate);
+    UWC_EXPECT(!results[2].needsZOrderUpdate);
+    UWC_EXPECT(Equals(results[2].shownWindows, { 4 }));
+
+    UWC_EXPECT(!results[3].needsFullUpdate);
+    UWC_EXPECT(results[3].needsZOrderUpdate);
+    UWC_EXPECT(results[3].shownWindows.empty());
+    UWC_EXPECT(results[3].hiddenWindows.empty());
+}
+
+
+UWC_TEST(WindowEventTracker_ManyShownWindowsRequestFullUpdate)
+{
+    std::vector<ReplayStep> steps = { Update(0) };
+    for (uintptr_t id = 1; id <= WindowEventTracker::kMaxIncrementalShownWindows + 1; ++id)
+    {
+        steps.push_back(Event(1'000, WindowEventType::Shown, id));
+    }
+    // Destroyed windows are only looked up, so they do not count.
+    for (uintptr_t id = 1'000; id < 2'000; ++id)
+    {
+        steps.push_back(Event(1'000, WindowEventType::Destroyed, id));
+    }
+    steps.push_back(Update(16'000));
+
+    WindowEventTracker tracker;
+    const auto results = Replay(tracker, steps);
+
+    UWC_EXPECT(results[1].needsFullUpdate);
+    UWC_EXPECT(results[1].shownWindows.empty());
+    UWC_EXPECT(results[1].hiddenWindows.empty());
+}
+
+
+UWC_TEST(WindowEventTracker_ResyncsPeriodically)
+{
+    WindowEventTracker tracker;
+    const auto results = Replay(tracker, {
+        Update(0),
+        Event(500'000, WindowEventType::Moved, 1),
+        Update(kFullUpdateInterval - 1),
+        Event(kFullUpdateInterval - 1, WindowEventType::Moved, 2),
+        Update(kFullUpdateInterval),
+        Update(kFullUpdateInterval + 16'000),
+        Update(kFullUpdateInterval * 2),
+    });
+
+    UWC_EXPECT(!results[1].needsFullUpdate);
+    UWC_EXPECT(Equals(results[1].movedWindows, { 1 }));
+    UWC_EXPECT(results[2].needsFullUpdate);
+    UWC_EXPECT(results[2].movedWindows.empty());
+    UWC_EXPECT(!results[3].needsFullUpdate);
+    UWC_EXPECT(results[4].needsFullUpdate);
+}
+
+
+UWC_TEST(WindowEventTracker_RequestFullUpdate)
+{
+    WindowEventTracker tracker;
+    Replay(tracker, { Update(0) });
+
+    // Requested by the hook thread when it stops and may have missed events.
+    tracker.RequestFullUpdate();
+
+    const auto results = Replay(tracker, {
+        Update(16'000),
+        Update(32'000),
+    });
+
+    UWC_EXPECT(results[0].needsFullUpdate);
+    UWC_EXPECT(!results[1].needsFullUpdate);
+}
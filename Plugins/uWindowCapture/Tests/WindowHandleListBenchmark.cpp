@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Benchmark.h"
+#include "WindowHandleList.h"
+#include "FakeWindowHandleSource.h"
+
+
+
+namespace
+{
+    struct FakeWindow
+    {
+        int id;
+        HWND hWnd;
+    };
+
+
+    struct Entry
+    {
+        WindowHandleData data;
+        std::shared_ptr<FakeWindow> window;
+    };
+
+
+    HWND MakeHandle(int i)
+    {
+        // Handles are spread like real ones so that the sorted order differs from the z-order.
+        return reinterpret_cast<HWND>(static_cast<uintptr_t>(0x10000 + (i * 7919) % 100003) * 2);
+    }
+
+
+    // Data of a window list update; every 50th window has moved since the previous one.
+    std::vector<WindowHandleData> CreateDataList(int count, int frame)
+    {
+        std::vector<WindowHandleData> dataList(count);
+        for (int i = 0; i < count; ++i)
+        {
+            auto& data = dataList[i];
+            data = {};
+            data.hWnd = MakeHandle(i);
+            const LONG offset = (i % 50 == 0) ? frame % 2 : 0;
+            data.windowRect = { offset, 0, 640 + offset, 480 };
+            data.zOrder = static_cast<UINT>(i);
+            data.isHitTestVisible = TRUE;
+        }
+        std::sort(dataList.begin(), dataList.end(), IsWindowHandleDataOrderedBefore);
+        return dataList;
+    }
+
+
+    std::vector<Entry> CreateEntries(const std::vector<WindowHandleData>& dataList)
+    {
+        std::vector<Entry> entries;
+        int id = 0;
+        for (const auto& data : dataList)
+        {
+            entries.push_back({ data, std::make_shared<FakeWindow>(FakeWindow { id++, data.hWnd }) });
+        }
+        return entries;
+    }
+
+
+    void RunMerge(Benchmark& benchmark, int count)
+    {
+        const std::vector<WindowHandleData> dataLists[] = { CreateDataList(count, 0), CreateDataList(count, 1) };
+        auto entries = CreateEntries(dataLists[0]);
+
+        int frame = 0;
+        int changedCount = 0;
+        benchmark.Run([&]
+        {
+            entries = MergeWindowHandleData(
+                std::move(entries),
+                dataLists[++frame % 2],
+                [&](Entry&) {},
+                [&](const WindowHandleData& data)
+                {
+                    return Entry { data, nullptr };
+                },
+                [&](Entry& entry, const WindowHandleData& data)
+                {
+                    if (entry.data.windowRect.left != data.windowRect.left)
+                    {
+                        entry.data = data;
+                        ++changedCount;
+                    }
+                });
+            benchmark.Consume(changedCount);
+        });
+    }
+
+
+    // The previous update: every enumerated window was looked up with find_if over the id map.
+    void RunFindIf(Benchmark& benchmark, int count)
+    {
+        const std::vector<WindowHandleData> dataLists[] = { CreateDataList(count, 0), CreateDataList(count, 1) };
+        std::map<int, std::shared_ptr<FakeWindow>> windows;
+        for (const auto& entry : CreateEntries(dataLists[0]))
+        {
+            windows.emplace(entry.window->id, entry.window);
+        }
+
+        int frame = 0;
+        int foundCount = 0;
+        benchmark.Run([&]
+        {
+            for (const auto& data : dataLists[++frame % 2])
+            {
+                const auto it = std::find_if(
+                    windows.begin(),
+                    windows.end(),
+                    [&](const auto& pair)
+                    {
+                        return pair.second->hWnd == data.hWnd;
+                    });
+                if (it != windows.end()) ++foundCount;
+            }
+            benchmark.Consume(foundCount);
+        });
+    }
+
+
+    enum class Activity
+    {
+        Drag, // a window is dragged
+        Tooltip, // a window is shown or hidden, which shifts the z-order below it
+        Activate, // a window is brought to the front
+    };
+
+
+    void Simulate(FakeWindowHandleSource& source, Activity activity, int frame)
+    {
+        const auto& order = source.GetOrder();
+        switch (activity)
+        {
+            case Activity::Drag: source.Move(order[1], 1, 0); break;
+            case Activity::Tooltip: source.SetVisible(order[order.size() / 2], frame % 2 == 0); break;
+            case Activity::Activate: source.BringToTop(order.back()); break;
+        }
+    }
+
+
+    // The fake answers queries much faster than the window API does, so the number
+    // of windows queried per update is reported along with the time.
+    void RunWindowListUpdate(Benchmark& benchmark, int count, Activity activity, bool isIncremental)
+    {
+        FakeWindowHandleSource source;
+        for (int i = 0; i < count; ++i)
+        {
+            source.SetVisible(source.Create(static_cast<size_t>(i)), true);
+        }
+        source.ClearEvents();
+
+        WindowEventTracker tracker;
+        std::vector<WindowHandleData> dataList;
+        EnumerateWindowHandleData(source, dataList);
+        tracker.Consume(0, INT64_MAX);
+
+        const int initialQueryCount = source.GetQueryCount();
+        int frame = 0;
+        benchmark.Run([&]
+        {
+            Simulate(source, activity, frame++);
+
+            if (isIncremental)
+            {
+                for (const auto& event : source.GetEvents())
+                {
+                    tracker.Push(event);
+                }
+                ApplyWindowChanges(source, tracker.Consume(0, INT64_MAX), dataList);
+            }
+            else
+            {
+                EnumerateWindowHandleData(source, dataList);
+            }
+            source.ClearEvents();
+
+            benchmark.Consume(dataList.size());
+        });
+
+        benchmark.ReportCounter("windows queried", static_cast<double>(source.GetQueryCount() - initialQueryCount) / frame);
+        benchmark.ReportCounter("z-order walks", static_cast<double>(source.GetWalkCount() - 1) / frame);
+    }
+}
+
+
+UWC_BENCHMARK(WindowHandleList_FullEnumeration_1000Windows)
+{
+    RunWindowListUpdate(benchmark, 1000, Activity::Drag, false);
+}
+
+
+UWC_BENCHMARK(WindowHandleList_FullEnumeration_4000Windows)
+{
+    RunWindowListUpdate(benchmark, 4000, Activity::Drag, false);
+}
+
+
+UWC_BENCHMARK(WindowHandleList_Incremental_Drag_1000Windows)
+{
+    RunWindowListUpdate(benchmark, 1000, Activity::Drag, true);
+}
+
+
+UWC_BENCHMARK(WindowHandleList_Incremental_Drag_4000Windows)
+{
+    RunWindowListUpdate(benchmark, 4000, Activity::Drag, true);
+}
+
+
+UWC_BENCHMARK(WindowHandleList_Incremental_Tooltip_4000Windows)
+{
+    RunWindowListUpdate(benchmark, 4000, Activity::Tooltip, true);
+}
+
+
+UWC_BENCHMARK(WindowHandleList_Incremental_Activate_4000Windows)
+{
+    RunWindowListUpdate(benchmark, 4000, Activity::Activate, true);
+}
+
+
+UWC_BENCHMARK(WindowHandleList_Merge_1000Windows)
+{
+    RunMerge(benchmark, 1000);
+}
+
+
+UWC_BENCHMARK(WindowHandleList_Merge_4000Windows)
+{
+    RunMerge(benchmark, 4000);
+}
+
+
+UWC_BENCHMARK(WindowHandleList_FindIf_1000Windows)
+{
+    RunFindIf(benchmark, 1000);
+}
+
+
+UWC_BENCHMARK(WindowHandleList_FindIf_4000Windows)
+{
+    RunFindIf(benchmark, 4000);
+}
+
+
+UWC_BENCHMARK(WindowHandleList_HandleLookup_HashIndex_4000Windows)
+{
+    const auto entries = CreateEntries(CreateDataList(4000, 0));
+    std::unordered_map<HWND, std::shared_ptr<FakeWindow>> windowsByHandle;
+    for (const auto& entry : entries)
+    {
+        windowsByHandle.emplace(entry.data.hWnd, entry.window);
+    }
+
+    int i = 0;
+    benchmark.Run([&]
+    {
+        const auto it = windowsByHandle.find(MakeHandle(i++ % 4000));
+        benchmark.Consume(it->second->id);
+    });
+}
+
+
+UWC_BENCHMARK(WindowHandleList_HandleLookup_FindIf_4000Windows)
+{
+    const auto entries = CreateEntries(CreateDataList(4000, 0));
+    std::map<int, std::shared_ptr<FakeWindow>> windows;
+    for (const auto& entry : entries)
+    {
+        windows.emplace(entry.window->id, entry.window);
+    }
+
+    int i = 0;
+    benchmark.Run([&]
+    {
+        const auto hWnd = MakeHandle(i++ % 4000);
+        const auto it = std::find_if(
+            windows.begin(),
+            windows.end(),
+            [&](const auto& pair)
+            {
+                return pair.second->hWnd == hWnd;
+            });
+        benchmark.Consume(it->second->id);
+    });
+}
@@ -0,0 +1,286 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "Test.h"
+#include "FakeWindowHandleSource.h"
+
+
+
+namespace
+{
+    bool Equals(const std::vector<WindowHandleData>& a, const std::vector<WindowHandleData>& b)
+    {
+        if (a.size() != b.size()) return false;
+
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            const auto& x = a[i];
+            const auto& y = b[i];
+            if (x.isDesktop != y.isDesktop ||
+                x.hWnd != y.hWnd ||
+                x.hMonitor != y.hMonitor ||
+                x.zOrder != y.zOrder ||
+                x.isHitTestVisible != y.isHitTestVisible ||
+                !::EqualRect(&x.windowRect, &y.windowRect) ||
+                !::EqualRect(&x.clientRect, &y.clientRect))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    // Feeds the events recorded by the source to the tracker and updates the list
+    // the way the window handle list thread does.
+    WindowEventTracker::Changes Update(
+        FakeWindowHandleSource& source,
+        WindowEventTracker& tracker,
+        std::vector<WindowHandleData>& dataList)
+    {
+        for (const auto& event : source.GetEvents())
+        {
+            tracker.Push(event);
+        }
+        source.ClearEvents();
+
+        const auto changes = tracker.Consume(0, INT64_MAX);
+        if (changes.needsFullUpdate)
+        {
+            EnumerateWindowHandleData(source, dataList);
+        }
+        else
+        {
+            ApplyWindowChanges(source, changes, dataList);
+        }
+        return changes;
+    }
+}
+
+
+UWC_TEST(WindowHandleList_IncrementalUpdateMatchesEnumeration)
+{
+    std::mt19937 random(1234);
+    const auto randomIndex = [&](size_t count)
+    {
+        return std::uniform_int_distribution<size_t>(0, count - 1)(random);
+    };
+
+    FakeWindowHandleSource source;
+    for (int i = 0; i < 100; ++i)
+    {
+        const auto hWnd = source.Create(static_cast<size_t>(i), i % 10 == 0);
+        if (i % 4 != 0) source.SetVisible(hWnd, true);
+    }
+
+    WindowEventTracker tracker;
+    std::vector<WindowHandleData> dataList;
+    UWC_EXPECT(Update(source, tracker, dataList).needsFullUpdate);
+
+    bool isAlwaysIncremental = true;
+    bool isAlwaysEqual = true;
+
+    for (int step = 0; step < 500; ++step)
+    {
+        const int eventCount = 1 + static_cast<int>(randomIndex(5));
+        for (int i = 0; i < eventCount; ++i)
+        {
+            const auto& order = source.GetOrder();
+            const auto hWnd = order[randomIndex(order.size())];
+
+            switch (randomIndex(10))
+            {
+                case 0: source.SetVisible(source.Create(randomIndex(order.size() + 1), randomIndex(10) == 0), true); break;
+                case 1: if (order.size() > 20) source.Destroy(hWnd); break;
+                case 2: source.SetVisible(hWnd, true); break;
+                case 3: source.SetVisible(hWnd, false); break;
+                case 4: source.SetCloaked(hWnd, randomIndex(2) == 0); break;
+                case 5: source.Minimize(hWnd); break;
+                case 6: source.BringToTop(hWnd); break;
+                case 7: source.DestroyChild(); break;
+                default: source.Move(hWnd, 10, -5); break;
+            }
+        }
+
+        const auto changes = Update(source, tracker, dataList);
+        isAlwaysIncremental &= !changes.needsFullUpdate;
+
+        std::vector<WindowHandleData> expected;
+        EnumerateWindowHandleData(source, expected);
+        isAlwaysEqual &= Equals(dataList, expected);
+    }
+
+    UWC_EXPECT(isAlwaysIncremental);
+    UWC_EXPECT(isAlwaysEqual);
+}
+
+
+UWC_TEST(WindowHandleList_IgnoresUnknownDestroys)
+{
+    FakeWindowHandleSource source;
+    for (int i = 0; i < 10; ++i)
+    {
+        source.SetVisible(source.Create(static_cast<size_t>(i)), true);
+    }
+
+    WindowEventTracker tracker;
+    std::vector<WindowHandleData> dataList;
+    Update(source, tracker, dataList);
+    const auto expected = dataList;
+
+    // Closing an application destroys its child windows first.
+    const int walkCount = source.GetWalkCount();
+    const int queryCount = source.GetQueryCount();
+    for (int i = 0; i < 100; ++i)
+    {
+        source.DestroyChild();
+    }
+
+    const auto changes = Update(source, tracker, dataList);
+    UWC_EXPECT(!changes.needsFullUpdate);
+    UWC_EXPECT(source.GetWalkCount() == walkCount);
+    UWC_EXPECT(source.GetQueryCount() == queryCount);
+    UWC_EXPECT(Equals(dataList, expected));
+}
+
+
+UWC_TEST(WindowHandleList_HiddenFilteredWindowShiftsZOrder)
+{
+    FakeWindowHandleSource source;
+    const auto excluded = source.Create(0, true);
+    const auto listed = source.Create(1);
+    source.SetVisible(excluded, true);
+    source.SetVisible(listed, true);
+
+    WindowEventTracker tracker;
+    std::vector<WindowHandleData> dataList;
+    Update(source, tracker, dataList);
+
+    // Only the listed window and the desktop are in the list.
+    UWC_EXPECT(dataList.size() == 2);
+    UWC_EXPECT(dataList[0].hWnd == listed && dataList[0].zOrder == 1);
+
+    // The window above is not listed but still counts in the z-order.
+    source.SetVisible(excluded, false);
+    Update(source, tracker, dataList);
+    UWC_EXPECT(dataList[0].hWnd == listed && dataList[0].zOrder == 0);
+}
+
+
+namespace
+{
+    // The z-order before it was derived from the enumeration: the visible windows above
+    // counted by walking GW_HWNDPREV from the window at the time it was enumerated.
+    UINT GetBaselineZOrder(const FakeWindowHandleSource& source, HWND hWnd)
+    {
+        const auto& order = source.GetOrder();
+        const auto it = std::find(order.begin(), order.end(), hWnd);
+        return static_cast<UINT>(std::count_if(order.begin(), it, [&](HWND above)
+        {
+            return source.IsVisible(above);
+        }));
+    }
+
+
+    FakeWindowHandleSource CreateStack(int count)
+    {
+        FakeWindowHandleSource source;
+        for (int i = 0; i < count; ++i)
+        {
+            const auto hWnd = source.Create(static_cast<size_t>(i));
+            if (i % 3 != 0) source.SetVisible(hWnd, true);
+        }
+        return source;
+    }
+}
+
+
+UWC_TEST(WindowZOrderCounter_MatchesBaselineWithHiddenWindows)
+{
+    auto source = CreateStack(300);
+
+    bool isAlwaysEqual = true;
+    WindowZOrderCounter zOrderCounter;
+    source.ForEachTopLevelWindow([&](HWND hWnd, bool isVisible)
+    {
+        const UINT zOrder = zOrderCounter.Visit(isVisible);
+        if (isVisible)
+        {
+            isAlwaysEqual &= zOrder == GetBaselineZOrder(source, hWnd);
+        }
+    });
+
+    UWC_EXPECT(isAlwaysEqual);
+}
+
+
+UWC_TEST(WindowZOrderCounter_WindowsDestroyedDuringWalk)
+{
+    auto source = CreateStack(300);
+    const auto order = source.GetOrder();
+
+    struct Result
+    {
+        HWND hWnd;
+        UINT zOrder;
+        UINT baselineZOrder;
+        UINT destroyedAboveCount; // visible when visited, destroyed before this visit
+    };
+    std::vector<Result> results;
+    std::vector<HWND> destroyedWindows;
+    UINT destroyedAboveCount = 0;
+
+    WindowZOrderCounter zOrderCounter;
+    size_t index = 0;
+    source.ForEachTopLevelWindow([&](HWND hWnd, bool isVisible)
+    {
+        const UINT zOrder = zOrderCounter.Visit(isVisible);
+        if (isVisible)
+        {
+            results.push_back({ hWnd, zOrder, GetBaselineZOrder(source, hWnd), destroyedAboveCount });
+        }
+
+        // Every 7th window destroys a visited window above and one not visited yet below.
+        if (++index % 7 == 0 && index + 5 < order.size())
+        {
+            const auto above = order[index - 4];
+            const auto below = order[index + 5];
+            for (const auto target : { above, below })
+            {
+                if (std::find(destroyedWindows.begin(), destroyedWindows.end(), target) != destroyedWindows.end()) continue;
+                if (target == above && source.IsVisible(target)) ++destroyedAboveCount;
+                destroyedWindows.push_back(target);
+                source.Destroy(target);
+            }
+        }
+    });
+
+    UWC_EXPECT(!destroyedWindows.empty());
+
+    // The counter keeps the visited windows which were destroyed afterwards, so it is
+    // ahead of the baseline by exactly those, and windows destroyed before their visit
+    // are skipped by both.
+    bool isDeltaBounded = true;
+    bool isOrderPreserved = true;
+    bool hasBaselineTie = false;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& result = results[i];
+        isDeltaBounded &= result.zOrder == result.baselineZOrder + result.destroyedAboveCount;
+        if (i > 0)
+        {
+            isOrderPreserved &=
+                results[i - 1].zOrder < result.zOrder &&
+                results[i - 1].baselineZOrder <= result.baselineZOrder;
+            hasBaselineTie |= results[i - 1].baselineZOrder == result.baselineZOrder;
+        }
+    }
+
+    UWC_EXPECT(isDeltaBounded);
+    UWC_EXPECT(isOrderPreserved);
+
+    // The baseline walks a stack which changes between visits, so two windows may
+    // get the same z-order; the counter keeps them distinct in the walk order.
+    UWC_EXPECT(hasBaselineTie);
+}
@@ -0,0 +1,195 @@
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+#include "WindowSnapshot.h"
+
+
+
+namespace
+{
+    constexpr int kWindowCount = 200;
+    constexpr int kReaderCount = 4;
+    const auto kWriteInterval = std::chrono::milliseconds(1);
+
+
+    std::vector<WindowSnapshot> CreateWindows(int frame)
+    {
+        std::vector<WindowSnapshot> windows(kWindowCount);
+        for (int i = 0; i < kWindowCount; ++i)
+        {
+            auto& window = windows[i];
+            window = {};
+            window.id = i + 1;
+            window.windowRect = { i + frame % 2, i, i + 640, i + 480 };
+            window.zOrder = static_cast<UINT>(i);
+            window.textureWidth = 640;
+            window.textureHeight = 480;
+            window.frameId = static_cast<UINT64>(frame);
+        }
+        return windows;
+    }
+
+
+    // Readers call the getter concurrently while a writer publishes window
+    // list updates far more often than the enumeration does; reports the time per read.
+    // A read returns a field of the window as the plugin getters do.
+    template <class ReadFunc, class WriteFunc>
+    void RunContention(Benchmark& benchmark, const ReadFunc& read, const WriteFunc& write)
+    {
+        const int readCount = benchmark.IsQuick() ? 1000 : 1'000'000;
+        std::atomic<bool> isReading = true;
+
+        std::thread writer([&]
+        {
+            for (int frame = 0; isReading; ++frame)
+            {
+                write(frame);
+                std::this_thread::sleep_for(kWriteInterval);
+            }
+        });
+
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<uint64_t> sums(kReaderCount);
+        std::vector<std::thread> readers;
+        for (int r = 0; r < kReaderCount; ++r)
+        {
+            readers.emplace_back([&, r]
+            {
+                uint64_t sum = 0;
+                for (int i = 0; i < readCount; ++i)
+                {
+                    sum += read((r * 31 + i) % kWindowCount + 1);
+                }
+                sums[r] = sum;
+            });
+        }
+        for (auto& reader : readers)
+        {
+            reader.join();
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        isReading = false;
+        writer.join();
+
+        for (const auto sum : sums)
+        {
+            benchmark.Consume(sum);
+        }
+        benchmark.Report(std::chrono::duration<double, std::nano>(elapsed).count() / readCount);
+    }
+
+
+    // The previous design: a window map guarded by a mutex which readers
+    // lock to copy the shared pointer of a window.
+    class LockedWindowList
+    {
+    public:
+        void Update(std::vector<WindowSnapshot>&& windows)
+        {
+            std::map<int, std::shared_ptr<WindowSnapshot>> newWindows;
+            for (auto& window : windows)
+            {
+                newWindows.emplace(window.id, std::make_shared<WindowSnapshot>(window));
+            }
+
+            std::scoped_lock lock(mutex_);
+            windows_.swap(newWindows);
+        }
+
+        std::shared_ptr<WindowSnapshot> Get(int id)
+        {
+            std::scoped_lock lock(mutex_);
+            const auto it = windows_.find(id);
+            return it != windows_.end() ? it->second : nullptr;
+        }
+
+    private:
+        std::map<int, std::shared_ptr<WindowSnapshot>> windows_;
+        std::mutex mutex_;
+    };
+}
+
+
+UWC_BENCHMARK(WindowSnapshotPublisher_GetAndFind)
+{
+    WindowSnapshotPublisher publisher;
+    publisher.Publish(CreateWindows(0));
+
+    int id = 0;
+    benchmark.Run([&]
+    {
+        const WindowSnapshotPublisher::ReadGuard guard(publisher);
+        benchmark.Consume(guard.Get()->Find(id++ % kWindowCount + 1)->zOrder);
+    });
+}
+
+
+UWC_BENCHMARK(WindowSnapshotPublisher_Publish_200Windows)
+{
+    WindowSnapshotPublisher publisher;
+
+    int frame = 0;
+    benchmark.Run([&]
+    {
+        publisher.Publish(CreateWindows(frame++));
+    });
+}
+
+
+UWC_BENCHMARK(WindowSnapshotPublisher_CopyWindowInfos_200Windows)
+{
+    WindowSnapshotPublisher publisher;
+    std::vector<WindowInfo> buffer(kWindowCount);
+
+    int frame = 0;
+    benchmark.Run([&]
+    {
+        // Every window has dirty flags to be consumed, as in a busy frame.
+        publisher.Publish(CreateWindows(frame++));
+        publisher.CopyWindowInfos(buffer.data(), kWindowCount);
+    });
+}
+
+
+UWC_BENCHMARK(WindowSnapshotPublisher_Contention_4Readers)
+{
+    WindowSnapshotPublisher publisher;
+    publisher.Publish(CreateWindows(0));
+
+    RunContention(
+        benchmark,
+        [&](int id) -> UINT
+        {
+            const WindowSnapshotPublisher::ReadGuard guard(publisher);
+            return guard.Get()->Find(id)->zOrder;
+        },
+        [&](int frame)
+        {
+            publisher.Publish(CreateWindows(frame));
+        });
+}
+
+
+UWC_BENCHMARK(LockedWindowList_Contention_4Readers)
+{
+    LockedWindowList list;
+    list.Update(CreateWindows(0));
+
+    RunContention(
+        benchmark,
+        [&](int id) -> UINT
+        {
+            return list.Get(id)->zOrder;
+        },
+        [&](int frame)
+        {
+            list.Update(CreateWindows(frame));
+        });
+}
@@ -0,0 +1,193 @@
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "WindowSpatialIndex.h"
+
+
+
+// The index only holds weak pointers, so a stand-in is enough for the benchmarks.
+class Window
+{
+};
+
+
+namespace
+{
+    constexpr int kWindowCount = 300;
+    constexpr int kPointCount = 1024;
+
+
+    struct Layout
+    {
+        std::vector<std::shared_ptr<Window>> windows;
+        std::vector<WindowSpatialIndex::Entry> entries;
+        std::vector<POINT> points;
+    };
+
+
+    // Two monitors with overlapping windows, queried at random points.
+    Layout CreateLayout(int windowCount = kWindowCount)
+    {
+        std::mt19937 random(12345);
+        const auto uniform = [&](int min, int max)
+        {
+            return std::uniform_int_distribution<int>(min, max)(random);
+        };
+
+        Layout layout;
+        const auto add = [&](RECT rect, UINT zOrder, bool isDesktop)
+        {
+            layout.windows.push_back(std::make_shared<Window>());
+            const int id = static_cast<int>(layout.entries.size());
+            layout.entries.push_back({ id, rect, zOrder, isDesktop, layout.windows.back() });
+        };
+
+        add({ 0, 0, 2560, 1440 }, 0, true);
+        add({ 2560, 0, 4480, 1080 }, 1, true);
+        for (int i = 0; i < windowCount; ++i)
+        {
+            const LONG x = uniform(-200, 4200);
+            const LONG y = uniform(-100, 1200);
+            add({ x, y, x + uniform(200, 1600), y + uniform(150, 1000) }, static_cast<UINT>(i), false);
+        }
+
+        for (int i = 0; i < kPointCount; ++i)
+        {
+            layout.points.push_back({ uniform(0, 4479), uniform(0, 1439) });
+        }
+
+        return layout;
+    }
+
+
+    // Updates the index for a window dragged by a pixel per frame, or for a window
+    // brought to the front, which changes the z-order of every window above it.
+    void RunUpdate(Benchmark& benchmark, int windowCount, bool isIncremental, bool isReordered)
+    {
+        const auto layout = CreateLayout(windowCount);
+        auto entries = layout.entries;
+        auto index = std::make_shared<WindowSpatialIndex>(std::move(entries));
+
+        auto current = layout.entries;
+        int frame = 0;
+        benchmark.Run([&]
+        {
+            std::vector<WindowSpatialIndex::Entry> changedEntries;
+            if (isReordered)
+            {
+                auto& front = current[2 + frame % windowCount];
+                for (auto& entry : current)
+                {
+                    if (!entry.isDesktop && entry.zOrder < front.zOrder)
+                    {
+                        ++entry.zOrder;
+                        changedEntries.push_back(entry);
+                    }
+                }
+                front.zOrder = 0;
+                changedEntries.push_back(front);
+            }
+            else
+            {
+                auto& dragged = current[2];
+                const LONG dx = (frame % 2 == 0) ? 1 : -1;
+                dragged.rect = { dragged.rect.left + dx, dragged.rect.top, dragged.rect.right + dx, dragged.rect.bottom };
+                changedEntries.push_back(dragged);
+            }
+            ++frame;
+
+            if (isIncremental)
+            {
+                index = std::make_shared<WindowSpatialIndex>(*index, std::move(changedEntries), std::vector<int>());
+            }
+            else
+            {
+                auto entries = current;
+                index = std::make_shared<WindowSpatialIndex>(std::move(entries));
+            }
+            benchmark.Consume(index->Find(layout.points[frame % kPointCount]) != nullptr);
+        });
+    }
+
+
+    // What a hit-test costs without the index: a scan of every window in z-order.
+    std::shared_ptr<Window> FindLinear(const std::vector<WindowSpatialIndex::Entry>& entries, POINT point)
+    {
+        for (const bool isDesktop : { false, true })
+        {
+            for (const auto& entry : entries)
+            {
+                if (entry.isDesktop != isDesktop) continue;
+
+                const auto& rect = entry.rect;
+                if (point.x < rect.left || point.x >= rect.right || point.y < rect.top || point.y >= rect.bottom) continue;
+
+                if (auto window = entry.window.lock()) return window;
+            }
+        }
+        return nullptr;
+    }
+}
+
+
+UWC_BENCHMARK(WindowSpatialIndex_Find_300Windows)
+{
+    const auto layout = CreateLayout();
+    auto entries = layout.entries;
+    const WindowSpatialIndex index(std::move(entries));
+
+    size_t i = 0;
+    benchmark.Run([&]
+    {
+        index.Find(layout.points[i++ % kPointCount]);
+    });
+}
+
+
+UWC_BENCHMARK(WindowSpatialIndex_LinearScan_300Windows)
+{
+    // Entries are already in z-order, as the index sorts them.
+    const auto layout = CreateLayout();
+
+    size_t i = 0;
+    benchmark.Run([&]
+    {
+        FindLinear(layout.entries, layout.points[i++ % kPointCount]);
+    });
+}
+
+
+UWC_BENCHMARK(WindowSpatialIndex_Build_300Windows)
+{
+    const auto layout = CreateLayout();
+
+    benchmark.Run([&]
+    {
+        auto entries = layout.entries;
+        const WindowSpatialIndex index(std::move(entries));
+    });
+}
+
+
+UWC_BENCHMARK(WindowSpatialIndex_RebuildOnDrag_2000Windows)
+{
+    RunUpdate(benchmark, 2000, false, false);
+}
+
+
+UWC_BENCHMARK(WindowSpatialIndex_IncrementalDrag_2000Windows)
+{
+    RunUpdate(benchmark, 2000, true, false);
+}
+
+
+UWC_BENCHMARK(WindowSpatialIndex_RebuildOnActivate_2000Windows)
+{
+    RunUpdate(benchmark, 2000, false, true);
+}
+
+
+UWC_BENCHMARK(WindowSpatialIndex_IncrementalActivate_2000Windows)
+{
+    RunUpdate(benchmark, 2000, true, true);
+}
@@ -0,0 +1,513 @@
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <random>
+#include <vector>
+#include "Test.h"
+#include "WindowSpatialIndex.h"
+
+
+
+// The index only holds weak pointers, so a stand-in is enough for the tests. The
+// fields are those the former WindowFromPoint() resolution looked at.
+class Window
+{
+public:
+    HWND hWnd = NULL;
+    DWORD threadId = 0;
+    DWORD processId = 0;
+    int zOrder = 0;
+    bool isDesktop = false;
+};
+
+
+namespace
+{
+    bool Contains(const RECT& rect, POINT point)
+    {
+        return
+            point.x >= rect.left && point.x < rect.right &&
+            point.y >= rect.top  && point.y < rect.bottom;
+    }
+
+
+    // Reference hit-test: the topmost live window containing the point,
+    // then the desktops, and nothing outside of the bounds of the desktops.
+    std::shared_ptr<Window> FindLinear(const std::vector<WindowSpatialIndex::Entry>& entries, POINT point)
+    {
+        bool hasBounds = false;
+        RECT bounds = { 0, 0, 0, 0 };
+        for (const auto& entry : entries)
+        {
+            if (!entry.isDesktop) continue;
+            bounds.left   = hasBounds ? (std::min)(bounds.left,   entry.rect.left)   : entry.rect.left;
+            bounds.top    = hasBounds ? (std::min)(bounds.top,    entry.rect.top)    : entry.rect.top;
+            bounds.right  = hasBounds ? (std::max)(bounds.right,  entry.rect.right)  : entry.rect.right;
+            bounds.bottom = hasBounds ? (std::max)(bounds.bottom, entry.rect.bottom) : entry.rect.bottom;
+            hasBounds = true;
+        }
+        if (!hasBounds || !Contains(bounds, point)) return nullptr;
+
+        for (const bool isDesktop : { false, true })
+        {
+            const WindowSpatialIndex::Entry* hit = nullptr;
+            std::shared_ptr<Window> hitWindow;
+            for (const auto& entry : entries)
+            {
+                if (entry.isDesktop != isDesktop || !Contains(entry.rect, point)) continue;
+                if (hit && entry.zOrder >= hit->zOrder) continue;
+
+                if (auto window = entry.window.lock())
+                {
+                    hit = &entry;
+                    hitWindow = window;
+                }
+            }
+            if (hitWindow) return hitWindow;
+        }
+
+        return nullptr;
+    }
+
+
+    RECT MakeRect(LONG x, LONG y, LONG width, LONG height)
+    {
+        return { x, y, x + width, y + height };
+    }
+}
+
+
+UWC_TEST(WindowSpatialIndex_MatchesLinearScan)
+{
+    std::mt19937 random(12345);
+    const auto uniform = [&](int min, int max)
+    {
+        return std::uniform_int_distribution<int>(min, max)(random);
+    };
+
+    const RECT monitors[] = {
+        MakeRect(0, 0, 1920, 1080),
+        MakeRect(1920, -360, 2560, 1440),
+        MakeRect(-1280, 200, 1280, 1024),
+    };
+
+    int mismatchCount = 0;
+
+    for (int trial = 0; trial < 50; ++trial)
+    {
+        std::vector<std::shared_ptr<Window>> windows;
+        std::vector<WindowSpatialIndex::Entry> entries;
+
+        const int monitorCount = uniform(1, 3);
+        for (int i = 0; i < monitorCount; ++i)
+        {
+            windows.push_back(std::make_shared<Window>());
+            entries.push_back({ static_cast<int>(entries.size()), monitors[i], static_cast<UINT>(uniform(0, 1000)), true, windows.back() });
+        }
+
+        const int windowCount = uniform(0, 80);
+        for (int i = 0; i < windowCount; ++i)
+        {
+            RECT rect;
+            if (uniform(0, 9) == 0)
+            {
+                // Minimized windows are moved far outside of the screens.
+                rect = MakeRect(-32000, -32000, 160, 28);
+            }
+            else
+            {
+                rect = MakeRect(uniform(-1600, 4400), uniform(-600, 1500), uniform(1, 1500), uniform(1, 1000));
+            }
+
+            // Duplicated z-orders keep the order of the ids.
+            windows.push_back(std::make_shared<Window>());
+            entries.push_back({ static_cast<int>(entries.size()), rect, static_cast<UINT>(uniform(0, 100)), false, windows.back() });
+        }
+
+        // Windows destroyed after the index was built.
+        for (auto& window : windows)
+        {
+            if (uniform(0, 9) == 0) window.reset();
+        }
+
+        auto indexEntries = entries;
+        const WindowSpatialIndex index(std::move(indexEntries));
+
+        for (int i = 0; i < 2000; ++i)
+        {
+            const POINT point = { uniform(-1700, 4600), uniform(-700, 1700) };
+            if (index.Find(point) != FindLinear(entries, point))
+            {
+                ++mismatchCount;
+            }
+        }
+    }
+
+    UWC_EXPECT(mismatchCount == 0);
+}
+
+
+UWC_TEST(WindowSpatialIndex_FindsNothingWithoutDesktops)
+{
+    auto window = std::make_shared<Window>();
+    const WindowSpatialIndex index({ { 0, MakeRect(0, 0, 100, 100), 0, false, window } });
+
+    UWC_EXPECT(index.Find({ 50, 50 }) == nullptr);
+}
+
+
+namespace
+{
+    std::vector<std::shared_ptr<Window>> Find(const WindowSpatialIndex& index, const std::vector<POINT>& points)
+    {
+        std::vector<std::shared_ptr<Window>> results;
+        for (const auto& point : points)
+        {
+            results.push_back(index.Find(point));
+        }
+        return results;
+    }
+}
+
+
+UWC_TEST(WindowSpatialIndex_IncrementalUpdateMatchesRebuild)
+{
+    std::mt19937 random(777);
+    const auto uniform = [&](int min, int max)
+    {
+        return std::uniform_int_distribution<int>(min, max)(random);
+    };
+    const auto randomRect = [&]
+    {
+        return MakeRect(uniform(-1600, 4400), uniform(-600, 1500), uniform(1, 1500), uniform(1, 1000));
+    };
+
+    std::vector<POINT> points;
+    for (int i = 0; i < 500; ++i)
+    {
+        points.push_back({ uniform(-1700, 4600), uniform(-700, 1700) });
+    }
+
+    // Entries by id, as the window handle list thread tracks them.
+    std::map<int, WindowSpatialIndex::Entry> current;
+    std::vector<std::shared_ptr<Window>> windows;
+    int lastId = 0;
+    const auto add = [&](RECT rect, bool isDesktop)
+    {
+        windows.push_back(std::make_shared<Window>());
+        const int id = lastId++;
+        current[id] = { id, rect, static_cast<UINT>(uniform(0, 100)), isDesktop, windows.back() };
+        return current[id];
+    };
+
+    std::vector<WindowSpatialIndex::Entry> initialEntries;
+    initialEntries.push_back(add(MakeRect(0, 0, 1920, 1080), true));
+    initialEntries.push_back(add(MakeRect(1920, -360, 2560, 1440), true));
+    for (int i = 0; i < 100; ++i)
+    {
+        initialEntries.push_back(add(randomRect(), false));
+    }
+    auto index = std::make_shared<WindowSpatialIndex>(std::move(initialEntries));
+
+    bool isAlwaysEqual = true;
+    for (int step = 0; step < 300; ++step)
+    {
+        std::vector<WindowSpatialIndex::Entry> changedEntries;
+        std::vector<int> removedIds;
+
+        const int changeCount = uniform(1, 8);
+        for (int i = 0; i < changeCount; ++i)
+        {
+            auto it = current.begin();
+            std::advance(it, uniform(0, static_cast<int>(current.size()) - 1));
+            auto& entry = it->second;
+
+            switch (uniform(0, 9))
+            {
+                case 0: changedEntries.push_back(add(randomRect(), false)); break;
+                case 1:
+                    if (!entry.isDesktop)
+                    {
+                        removedIds.push_back(entry.id);
+                        current.erase(it);
+                    }
+                    break;
+                case 2: entry.zOrder = static_cast<UINT>(uniform(0, 100)); changedEntries.push_back(entry); break;
+                case 3:
+                    // A monitor layout change moves the bounds of the grid.
+                    if (step % 50 == 0 && entry.isDesktop)
+                    {
+                        entry.rect.right += 64;
+                        changedEntries.push_back(entry);
+                    }
+                    break;
+                default:
+                    if (!entry.isDesktop)
+                    {
+                        entry.rect = randomRect();
+                        changedEntries.push_back(entry);
+                    }
+                    break;
+            }
+        }
+
+        // A window changed and then removed in the same update is only removed.
+        for (const auto id : removedIds)
+        {
+            changedEntries.erase(
+                std::remove_if(changedEntries.begin(), changedEntries.end(), [&](const WindowSpatialIndex::Entry& entry)
+                {
+                    return entry.id == id;
+                }),
+                changedEntries.end());
+        }
+
+        index = std::make_shared<WindowSpatialIndex>(*index, std::move(changedEntries), removedIds);
+
+        std::vector<WindowSpatialIndex::Entry> entries;
+        for (const auto& pair : current) entries.push_back(pair.second);
+        const WindowSpatialIndex rebuilt(std::move(entries));
+
+        isAlwaysEqual &= Find(*index, points) == Find(rebuilt, points);
+    }
+
+    UWC_EXPECT(isAlwaysEqual);
+}
+
+
+namespace
+{
+    // A synthetic desktop for the former resolution: WindowFromPoint() returns the deepest
+    // child of the topmost top-level window under the point, then GetAncestor() climbs.
+    struct TopLevelWindow
+    {
+        HWND hWnd;
+        RECT rect;
+        bool isListed; // accepted by the window filter
+        bool isHitTestVisible;
+        DWORD threadId;
+        DWORD processId;
+        std::vector<std::pair<HWND, RECT>> children;
+    };
+
+
+    struct Desktop
+    {
+        std::vector<TopLevelWindow> windows; // from the top
+        std::map<int, std::shared_ptr<Window>> listedWindows; // windows_ of WindowManager
+        std::vector<WindowSpatialIndex::Entry> entries;
+
+        static HWND GetDesktopWindow() { return reinterpret_cast<HWND>(static_cast<uintptr_t>(1)); }
+
+        HWND WindowFromPoint(POINT point) const
+        {
+            for (const auto& window : windows)
+            {
+                if (!window.isHitTestVisible || !Contains(window.rect, point)) continue;
+
+                for (const auto& child : window.children)
+                {
+                    if (Contains(child.second, point)) return child.first;
+                }
+                return window.hWnd;
+            }
+            return GetDesktopWindow();
+        }
+
+        const TopLevelWindow* FindTopLevel(HWND hWnd) const
+        {
+            for (const auto& window : windows)
+            {
+                if (window.hWnd == hWnd) return &window;
+                for (const auto& child : window.children)
+                {
+                    if (child.first == hWnd) return &window;
+                }
+            }
+            return nullptr;
+        }
+
+        HWND GetAncestor(HWND hWnd) const
+        {
+            if (hWnd == GetDesktopWindow()) return NULL;
+            const auto window = FindTopLevel(hWnd);
+            return window->hWnd == hWnd ? GetDesktopWindow() : window->hWnd;
+        }
+
+        DWORD GetWindowThreadProcessId(HWND hWnd, DWORD* processId) const
+        {
+            const auto window = FindTopLevel(hWnd);
+            *processId = window ? window->processId : 0;
+            return window ? window->threadId : 0;
+        }
+
+        // WindowManager::GetWindowFromPoint() before the spatial index, with the window API above.
+        std::shared_ptr<Window> GetBaselineWindowFromPoint(POINT point) const
+        {
+            auto hWnd = WindowFromPoint(point);
+
+            while (hWnd != NULL)
+            {
+                DWORD thread, process;
+                thread = GetWindowThreadProcessId(hWnd, &process);
+
+                std::shared_ptr<Window> parent;
+                int maxZOrder = INT_MAX;
+
+                for (const auto& pair : listedWindows)
+                {
+                    const auto& window = pair.second;
+
+                    if (window->hWnd == hWnd)
+                    {
+                        return window;
+                    }
+
+                    // Never true as maxZOrder starts at INT_MAX, so this fallback could
+                    // not select a window of the same thread.
+                    if ((window->threadId == thread) &&
+                        (window->processId == process))
+                    {
+                        const int zOrder = window->zOrder;
+                        if (zOrder > maxZOrder)
+                        {
+                            maxZOrder = zOrder;
+                            parent = window;
+                        }
+                    }
+                }
+
+                if (parent)
+                {
+                    return parent;
+                }
+
+                hWnd = GetAncestor(hWnd);
+            }
+
+            return nullptr;
+        }
+    };
+
+
+    Desktop CreateDesktop(std::mt19937& random)
+    {
+        const auto uniform = [&](int min, int max)
+        {
+            return std::uniform_int_distribution<int>(min, max)(random);
+        };
+
+        Desktop desktop;
+        int id = 0;
+
+        for (const auto& rect : { MakeRect(0, 0, 1920, 1080), MakeRect(1920, 0, 1920, 1080) })
+        {
+            auto window = std::make_shared<Window>();
+            window->hWnd = Desktop::GetDesktopWindow();
+            window->isDesktop = true;
+            desktop.listedWindows.emplace(id, window);
+            desktop.entries.push_back({ id++, rect, 0, true, window });
+        }
+
+        uintptr_t lastHandle = 1;
+        int visibleCount = 0;
+        for (int i = 0; i < 60; ++i)
+        {
+            TopLevelWindow topLevel;
+            topLevel.hWnd = reinterpret_cast<HWND>(++lastHandle);
+            topLevel.rect = MakeRect(uniform(-200, 3600), uniform(-100, 900), uniform(100, 1200), uniform(80, 800));
+            topLevel.isListed = uniform(0, 4) != 0;
+            topLevel.isHitTestVisible = uniform(0, 9) != 0;
+            // A few threads own many windows, e.g. a main window and its popups.
+            topLevel.threadId = static_cast<DWORD>(uniform(1, 6));
+            topLevel.processId = topLevel.threadId * 100;
+
+            for (int c = uniform(0, 3); c > 0; --c)
+            {
+                const auto& r = topLevel.rect;
+                const LONG x = uniform(r.left, r.right - 1);
+                const LONG y = uniform(r.top, r.bottom - 1);
+                topLevel.children.emplace_back(reinterpret_cast<HWND>(++lastHandle), RECT { x, y, (std::min)(x + 200, r.right), (std::min)(y + 100, r.bottom) });
+            }
+
+            if (topLevel.isListed)
+            {
+                auto window = std::make_shared<Window>();
+                window->hWnd = topLevel.hWnd;
+                window->threadId = topLevel.threadId;
+                window->processId = topLevel.processId;
+                window->zOrder = visibleCount;
+                desktop.listedWindows.emplace(id, window);
+                if (topLevel.isHitTestVisible)
+                {
+                    desktop.entries.push_back({ id, topLevel.rect, static_cast<UINT>(visibleCount), false, window });
+                }
+                ++id;
+            }
+
+            ++visibleCount;
+            desktop.windows.push_back(std::move(topLevel));
+        }
+
+        return desktop;
+    }
+}
+
+
+UWC_TEST(WindowSpatialIndex_MatchesWindowFromPointResolution)
+{
+    std::mt19937 random(4321);
+    const auto uniform = [&](int min, int max)
+    {
+        return std::uniform_int_distribution<int>(min, max)(random);
+    };
+
+    int listedHitCount = 0;
+    int listedMismatchCount = 0;
+    int unlistedHitCount = 0;
+    int unlistedNonDesktopCount = 0;
+    int unlistedMismatchOutsideDesktopCount = 0;
+    int unlistedIndexMismatchCount = 0;
+
+    for (int trial = 0; trial < 20; ++trial)
+    {
+        auto desktop = CreateDesktop(random);
+        auto entries = desktop.entries;
+        const WindowSpatialIndex index(std::move(entries));
+
+        for (int i = 0; i < 2000; ++i)
+        {
+            const POINT point = { uniform(0, 3839), uniform(0, 1079) };
+            const auto baseline = desktop.GetBaselineWindowFromPoint(point);
+            const auto found = index.Find(point);
+
+            const auto hWnd = desktop.WindowFromPoint(point);
+            const auto topLevel = desktop.FindTopLevel(hWnd);
+
+            if (topLevel && topLevel->isListed)
+            {
+                // Over a listed window (or one of its children) both resolve the same window.
+                ++listedHitCount;
+                if (baseline != found) ++listedMismatchCount;
+            }
+            else
+            {
+                // Over an unlisted window or the bare desktop, the baseline falls through to
+                // the desktop handle, which all monitors share, so it returns the first one.
+                ++unlistedHitCount;
+                if (!baseline || !baseline->isDesktop) ++unlistedNonDesktopCount;
+                if (baseline != desktop.listedWindows.begin()->second) ++unlistedMismatchOutsideDesktopCount;
+
+                // The index returns the listed window or the monitor under the point instead.
+                if (found != FindLinear(desktop.entries, point)) ++unlistedIndexMismatchCount;
+            }
+        }
+    }
+
+    UWC_EXPECT(listedHitCount > 0);
+    UWC_EXPECT(listedMismatchCount == 0);
+    UWC_EXPECT(unlistedHitCount > 0);
+    UWC_EXPECT(unlistedNonDesktopCount == 0);
+    UWC_EXPECT(unlistedMismatchOutsideDesktopCount == 0);
+    UWC_EXPECT(unlistedIndexMismatchCount == 0);
+}
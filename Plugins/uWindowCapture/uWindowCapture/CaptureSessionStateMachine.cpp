@@ -0,0 +1,124 @@
+#include "CaptureSessionStateMachine.h"
+
+
+
+void CaptureSessionStateMachine::OnRequested(int64_t now)
+{
+    isStartRequested_ = true;
+    lastRequestTime_ = now;
+}
+
+
+void CaptureSessionStateMachine::OnFrameReceived(int64_t now)
+{
+    lastFrameTime_ = now;
+    lastRequestTime_ = now;
+}
+
+
+void CaptureSessionStateMachine::OnStarted(bool succeeded, int64_t now)
+{
+    if (succeeded)
+    {
+        state_ = CaptureSessionState::Active;
+        hasStartFailed_ = false;
+        lastFrameTime_ = now;
+    }
+    else
+    {
+        state_ = CaptureSessionState::Stopped;
+        hasStartFailed_ = true;
+        lastStartFailureTime_ = now;
+    }
+}
+
+
+void CaptureSessionStateMachine::OnStopped()
+{
+    state_ = CaptureSessionState::Stopped;
+    isRestartRequested_ = false;
+}
+
+
+void CaptureSessionStateMachine::RequestRestart()
+{
+    if (state_ == CaptureSessionState::Stopped) return;
+    isRestartRequested_ = true;
+}
+
+
+CaptureSessionAction CaptureSessionStateMachine::Update(int64_t now, const CaptureSessionTimeouts& timeouts)
+{
+    switch (state_)
+    {
+        case CaptureSessionState::Stopped:
+        {
+            if (!isStartRequested_) return CaptureSessionAction::None;
+
+            // Do not hammer windows which cannot be captured.
+            if (hasStartFailed_ && now - lastStartFailureTime_ < timeouts.startRetryInterval)
+            {
+                return CaptureSessionAction::None;
+            }
+
+            isStartRequested_ = false;
+            return CaptureSessionAction::Start;
+        }
+        case CaptureSessionState::Active:
+        {
+            isStartRequested_ = false;
+
+            if (isRestartRequested_)
+            {
+                isRestartRequested_ = false;
+                lastRestartTime_ = now;
+                return CaptureSessionAction::Restart;
+            }
+
+            // Park the session first instead of stopping it so that a request
+            // soon after the idle timeout reuses it.
+            if (now - lastRequestTime_ > timeouts.idleTimeout)
+            {
+                state_ = CaptureSessionState::Warm;
+                warmStartTime_ = now;
+                return CaptureSessionAction::None;
+            }
+
+            if (now - lastFrameTime_ > timeouts.frameTimeout && 
+                now - lastRestartTime_ > timeouts.minRestartInterval)
+            {
+                lastRestartTime_ = now;
+                lastFrameTime_ = now;
+                return CaptureSessionAction::Restart;
+            }
+
+            return CaptureSessionAction::None;
+        }
+        case CaptureSessionState::Warm:
+        {
+            // Options changed while parked: stop and let the next request start afresh.
+            if (isRestartRequested_)
+            {
+                isRestartRequested_ = false;
+                return CaptureSessionAction::Stop;
+            }
+
+            if (isStartRequested_)
+            {
+                isStartRequested_ = false;
+                state_ = CaptureSessionState::Active;
+                lastFrameTime_ = now;
+                return CaptureSessionAction::None;
+            }
+
+            if (now - warmStartTime_ > timeouts.warmTimeout)
+            {
+                return CaptureSessionAction::Stop;
+            }
+
+            return CaptureSessionAction::None;
+        }
+    }
+
+    return CaptureSessionAction::None;
+}
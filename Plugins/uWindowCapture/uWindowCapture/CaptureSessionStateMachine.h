@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+
+
+enum class CaptureSessionState
+{
+    // No frame pool and session.
+    Stopped = 0,
+    // The session is running and frames are requested.
+    Active = 1,
+    // The session is still running but nobody requests frames. It is kept
+    // for a while so that a new request does not pay the creation cost again.
+    Warm = 2,
+};
+
+
+enum class CaptureSessionAction
+{
+    None = 0,
+    Start = 1,
+    Stop = 2,
+    Restart = 3,
+};
+
+
+struct CaptureSessionTimeouts
+{
+    int64_t idleTimeout = 1'000'000; // [us] Active -> Warm without requests
+    int64_t warmTimeout = 10'000'000; // [us] Warm -> Stopped
+    int64_t frameTimeout = 1'000'000; // [us] restart an active session without frames
+    int64_t minRestartInterval = 3'000'000; // [us]
+    int64_t startRetryInterval = 1'000'000; // [us] after a failed start
+};
+
+
+// Decides when a capture session is started, parked, stopped or restarted.
+// It only consumes timestamps and events and returns the action to perform,
+// so it does not depend on Windows Graphics Capture or on a real clock.
+// Not thread-safe; the owner serializes calls.
+class CaptureSessionStateMachine
+{
+public:
+    void OnRequested(int64_t now);
+    void OnFrameReceived(int64_t now);
+    void OnStarted(bool succeeded, int64_t now);
+    void OnStopped();
+    void RequestRestart();
+
+    CaptureSessionAction Update(int64_t now, const CaptureSessionTimeouts& timeouts);
+
+    CaptureSessionState GetState() const { return state_; }
+    int64_t GetLastRequestTime() const { return lastRequestTime_; }
+
+private:
+    CaptureSessionState state_ = CaptureSessionState::Stopped;
+    bool isStartRequested_ = false;
+    bool isRestartRequested_ = false;
+    int64_t lastRequestTime_ = 0;
+    int64_t lastFrameTime_ = 0;
+    int64_t lastRestartTime_ = 0;
+    int64_t lastStartFailureTime_ = 0;
+    int64_t warmStartTime_ = 0;
+    bool hasStartFailed_ = false;
+};
+
+
+// Returns the warm sessions to stop so that at most capacity of them stay warm,
+// keeping the most recently requested ones. Ptr is any pointer-like type to
+// an object with GetState() and GetLastRequestTime().
+template <class Ptr>
+std::vector<Ptr> SelectWarmSessionsToEvict(const std::vector<Ptr>& sessions, size_t capacity)
+{
+    std::vector<Ptr> warmSessions;
+    for (const auto& session : sessions)
+    {
+        if (session->GetState() == CaptureSessionState::Warm)
+        {
+            warmSessions.push_back(session);
+        }
+    }
+
+    if (warmSessions.size() <= capacity) return {};
+
+    std::stable_sort(
+        warmSessions.begin(),
+        warmSessions.end(),
+        [](const Ptr& a, const Ptr& b)
+        {
+            return a->GetLastRequestTime() > b->GetLastRequestTime();
+        });
+
+    warmSessions.erase(warmSessions.begin(), warmSessions.begin() + capacity);
+    return warmSessions;
+}
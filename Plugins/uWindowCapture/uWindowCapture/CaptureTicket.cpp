@@ -0,0 +1,261 @@
+#include "CaptureTicket.h"
+#include "CaptureManager.h"
+#include "Util.h"
+
+
+
+CaptureTicketManager::~CaptureTicketManager()
+{
+    FailAll();
+}
+
+
+int CaptureTicketManager::Issue(int windowId, CapturePriority priority)
+{
+    const auto now = GetTimestampInMicroseconds();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    ExpireFinishedTickets(now);
+
+    // Coalesce requests for the same window into the pending ticket.
+    const auto it = pendingTicketIds_.find(windowId);
+    if (it != pendingTicketIds_.end())
+    {
+        auto& ticket = tickets_[it->second];
+        if (static_cast<int>(priority) < static_cast<int>(ticket.priority))
+        {
+            ticket.priority = priority;
+        }
+        ++ticket.refCount;
+        return it->second;
+    }
+
+    const int ticketId = lastTicketId_++;
+
+    auto& ticket = tickets_[ticketId];
+    ticket.priority = priority;
+    ticket.refCount = 1;
+    ticket.result.ticketId = ticketId;
+    ticket.result.windowId = windowId;
+    ticket.result.state = CaptureTicketState::Pending;
+    ticket.result.requestedTime = now;
+
+    pendingTicketIds_.emplace(windowId, ticketId);
+
+    return ticketId;
+}
+
+
+int CaptureTicketManager::IssueFailed(int windowId)
+{
+    const auto now = GetTimestampInMicroseconds();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    ExpireFinishedTickets(now);
+
+    const int ticketId = lastTicketId_++;
+
+    auto& ticket = tickets_[ticketId];
+    ticket.refCount = 1;
+    ticket.result.ticketId = ticketId;
+    ticket.result.windowId = windowId;
+    ticket.result.state = CaptureTicketState::Failed;
+    ticket.result.requestedTime = now;
+
+    finishedTickets_.emplace_back(ticketId, now);
+
+    return ticketId;
+}
+
+
+CaptureTicketManager::ResolveResult CaptureTicketManager::Resolve(int windowId, UINT64 frameId, INT64 capturedTime, INT64 uploadedTime)
+{
+    std::vector<std::pair<Callback, CaptureTicketResult>> callbacks;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        const auto it = pendingTicketIds_.find(windowId);
+        if (it == pendingTicketIds_.end()) return ResolveResult::NoTicket;
+
+        auto& ticket = tickets_[it->second];
+
+        // The frame was captured before the request, so it cannot satisfy the ticket.
+        if (capturedTime < ticket.result.requestedTime) return ResolveResult::Stale;
+
+        ticket.result.frameId = frameId;
+        ticket.result.capturedTime = capturedTime;
+        ticket.result.uploadedTime = uploadedTime;
+        Finish(ticket, CaptureTicketState::Completed, callbacks);
+
+        pendingTicketIds_.erase(it);
+    }
+
+    cv_.notify_all();
+
+    for (const auto& pair : callbacks)
+    {
+        pair.first(pair.second);
+    }
+
+    return ResolveResult::Resolved;
+}
+
+
+void CaptureTicketManager::Fail(int windowId)
+{
+    std::vector<std::pair<Callback, CaptureTicketResult>> callbacks;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        const auto it = pendingTicketIds_.find(windowId);
+        if (it == pendingTicketIds_.end()) return;
+
+        Finish(tickets_[it->second], CaptureTicketState::Failed, callbacks);
+        pendingTicketIds_.erase(it);
+    }
+
+    cv_.notify_all();
+
+    for (const auto& pair : callbacks)
+    {
+        pair.first(pair.second);
+    }
+}
+
+
+void CaptureTicketManager::FailAll()
+{
+    std::vector<std::pair<Callback, CaptureTicketResult>> callbacks;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        for (const auto& pair : pendingTicketIds_)
+        {
+            Finish(tickets_[pair.second], CaptureTicketState::Failed, callbacks);
+        }
+        pendingTicketIds_.clear();
+    }
+
+    cv_.notify_all();
+
+    for (const auto& pair : callbacks)
+    {
+        pair.first(pair.second);
+    }
+}
+
+
+bool CaptureTicketManager::GetPendingPriority(int windowId, CapturePriority& outPriority) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const auto it = pendingTicketIds_.find(windowId);
+    if (it == pendingTicketIds_.end()) return false;
+
+    outPriority = tickets_.at(it->second).priority;
+    return true;
+}
+
+
+void CaptureTicketManager::Finish(Ticket& ticket, CaptureTicketState state, std::vector<std::pair<Callback, CaptureTicketResult>>& outCallbacks)
+{
+    ticket.result.state = state;
+    finishedTickets_.emplace_back(ticket.result.ticketId, GetTimestampInMicroseconds());
+
+    for (auto&& callback : ticket.callbacks)
+    {
+        outCallbacks.emplace_back(std::move(callback), ticket.result);
+    }
+    ticket.callbacks.clear();
+}
+
+
+void CaptureTicketManager::ExpireFinishedTickets(INT64 now)
+{
+    // Run this scope with mutex_ locked.
+
+    while (!finishedTickets_.empty())
+    {
+        const auto& finished = finishedTickets_.front();
+        if (now - finished.second < kFinishedTicketLifetime) break;
+
+        // Released tickets have already been erased.
+        tickets_.erase(finished.first);
+        finishedTickets_.pop_front();
+    }
+}
+
+
+CaptureTicketState CaptureTicketManager::GetInternal(int ticketId, CaptureTicketResult* outResult) const
+{
+    const auto it = tickets_.find(ticketId);
+    if (it == tickets_.end()) return CaptureTicketState::Invalid;
+
+    const auto& result = it->second.result;
+    if (outResult)
+    {
+        *outResult = result;
+    }
+
+    return result.state;
+}
+
+
+CaptureTicketState CaptureTicketManager::Get(int ticketId, CaptureTicketResult* outResult) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return GetInternal(ticketId, outResult);
+}
+
+
+CaptureTicketState CaptureTicketManager::Wait(int ticketId, UINT timeout, CaptureTicketResult* outResult) const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    cv_.wait_for(lock, std::chrono::milliseconds(timeout), [&]
+    {
+        return GetInternal(ticketId, nullptr) != CaptureTicketState::Pending;
+    });
+
+    return GetInternal(ticketId, outResult);
+}
+
+
+bool CaptureTicketManager::AddCallback(int ticketId, const Callback& callback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const auto it = tickets_.find(ticketId);
+    if (it == tickets_.end()) return false;
+
+    auto& ticket = it->second;
+    if (ticket.result.state != CaptureTicketState::Pending) return false;
+
+    ticket.callbacks.push_back(callback);
+    return true;
+}
+
+
+void CaptureTicketManager::Release(int ticketId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const auto it = tickets_.find(ticketId);
+    if (it == tickets_.end()) return;
+
+    auto& ticket = it->second;
+    if (--ticket.refCount > 0) return;
+
+    // A pending ticket nobody waits for no longer needs to be tracked.
+    if (ticket.result.state == CaptureTicketState::Pending)
+    {
+        pendingTicketIds_.erase(ticket.result.windowId);
+    }
+
+    tickets_.erase(it);
+}
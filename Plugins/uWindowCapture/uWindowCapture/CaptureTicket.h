@@ -0,0 +1,91 @@
+#pragma once
+
+#include <Windows.h>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+#include "IUnityInterface.h"
+
+
+enum class CapturePriority;
+
+
+enum class CaptureTicketState : int
+{
+    Invalid = -1,
+    Pending = 0,
+    Completed = 1,
+    Failed = 2,
+};
+
+
+struct CaptureTicketResult
+{
+    int ticketId = -1;
+    int windowId = -1;
+    CaptureTicketState state = CaptureTicketState::Invalid;
+    UINT64 frameId = 0;
+    INT64 requestedTime = 0; // [us]
+    INT64 capturedTime = 0; // [us]
+    INT64 uploadedTime = 0; // [us]
+};
+
+
+using CaptureTicketCallbackFuncPtr = void(UNITY_INTERFACE_API *)(const CaptureTicketResult*, void*);
+
+
+class CaptureTicketManager
+{
+public:
+    using Callback = std::function<void(const CaptureTicketResult&)>;
+
+    enum class ResolveResult
+    {
+        NoTicket,
+        Resolved,
+        Stale,
+    };
+
+    ~CaptureTicketManager();
+
+    int Issue(int windowId, CapturePriority priority);
+    int IssueFailed(int windowId);
+    ResolveResult Resolve(int windowId, UINT64 frameId, INT64 capturedTime, INT64 uploadedTime);
+    void Fail(int windowId);
+    void FailAll();
+    bool GetPendingPriority(int windowId, CapturePriority& outPriority) const;
+
+    CaptureTicketState Get(int ticketId, CaptureTicketResult* outResult) const;
+    CaptureTicketState Wait(int ticketId, UINT timeout, CaptureTicketResult* outResult) const;
+    bool AddCallback(int ticketId, const Callback& callback);
+
+    // Frees the ticket. Finished tickets that are never released expire
+    // after kFinishedTicketLifetime, so ignoring results does not leak.
+    void Release(int ticketId);
+
+    static constexpr INT64 kFinishedTicketLifetime = 10'000'000; // [us]
+
+private:
+    struct Ticket
+    {
+        CapturePriority priority;
+        CaptureTicketResult result;
+        std::vector<Callback> callbacks;
+        int refCount = 0;
+    };
+
+    void Finish(Ticket& ticket, CaptureTicketState state, std::vector<std::pair<Callback, CaptureTicketResult>>& outCallbacks);
+    CaptureTicketState GetInternal(int ticketId, CaptureTicketResult* outResult) const;
+    void ExpireFinishedTickets(INT64 now);
+
+    std::unordered_map<int, Ticket> tickets_;
+    std::unordered_map<int, int> pendingTicketIds_;
+    std::deque<std::pair<int, INT64>> finishedTickets_; // (ticketId, finishedTime) in finished order
+    int lastTicketId_ = 0;
+    mutable std::mutex mutex_;
+    mutable std::condition_variable cv_;
+};
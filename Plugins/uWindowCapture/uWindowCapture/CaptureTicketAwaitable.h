@@ -0,0 +1,72 @@
+#pragma once
+
+// C++20 coroutine wrapper of the capture ticket API for native hosts.
+// The coroutine is resumed on the upload thread when the frame is uploaded.
+//
+//     CaptureTicketResult result = co_await UwcCaptureWindowAsync(id, CapturePriority::High);
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <coroutine>
+
+#include "CaptureManager.h"
+#include "CaptureTicket.h"
+
+
+extern "C"
+{
+    int UNITY_INTERFACE_API UwcRequestCaptureWindowTicket(int id, CapturePriority priority);
+    CaptureTicketState UNITY_INTERFACE_API UwcGetCaptureTicketResult(int ticketId, CaptureTicketResult* result);
+    bool UNITY_INTERFACE_API UwcSetCaptureTicketCallback(int ticketId, CaptureTicketCallbackFuncPtr func, void* userData);
+    void UNITY_INTERFACE_API UwcReleaseCaptureTicket(int ticketId);
+}
+
+
+class CaptureTicketAwaiter
+{
+public:
+    explicit CaptureTicketAwaiter(int ticketId) : ticketId_(ticketId) {}
+
+    CaptureTicketAwaiter(const CaptureTicketAwaiter&) = delete;
+    CaptureTicketAwaiter& operator=(const CaptureTicketAwaiter&) = delete;
+
+    bool await_ready() const
+    {
+        return UwcGetCaptureTicketResult(ticketId_, nullptr) != CaptureTicketState::Pending;
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        handle_ = handle;
+
+        // If the ticket has already finished, no callback is registered and we resume immediately.
+        return UwcSetCaptureTicketCallback(ticketId_, &CaptureTicketAwaiter::OnFinished, this);
+    }
+
+    CaptureTicketResult await_resume()
+    {
+        CaptureTicketResult result;
+        result.ticketId = ticketId_;
+        UwcGetCaptureTicketResult(ticketId_, &result);
+        UwcReleaseCaptureTicket(ticketId_);
+        return result;
+    }
+
+private:
+    static void UNITY_INTERFACE_API OnFinished(const CaptureTicketResult*, void* userData)
+    {
+        auto thiz = static_cast<CaptureTicketAwaiter*>(userData);
+        thiz->handle_.resume();
+    }
+
+    const int ticketId_;
+    std::coroutine_handle<> handle_;
+};
+
+
+inline CaptureTicketAwaiter UwcCaptureWindowAsync(int id, CapturePriority priority)
+{
+    return CaptureTicketAwaiter(UwcRequestCaptureWindowTicket(id, priority));
+}
+
+#endif
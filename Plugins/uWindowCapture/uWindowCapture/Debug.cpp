@@ -1,46 +1,260 @@
-#pragma once
-
-#include <Windows.h>
-#include "Debug.h"
-
-
-decltype(Debug::mode_)    Debug::mode_ = Debug::Mode::File;
-decltype(Debug::logFunc_) Debug::logFunc_ = nullptr;
-decltype(Debug::errFunc_) Debug::errFunc_ = nullptr;
-decltype(Debug::fs_)      Debug::fs_;
-decltype(Debug::ss_)      Debug::ss_;
-decltype(Debug::mutex_)   Debug::mutex_;
-
-
-void Debug::Initialize()
-{
-    if (mode_ == Mode::File)
-    {
-        fs_.open("uWindowCapture.log");
-        Debug::Log("Start");
-    }
-}
-
-
-void Debug::Finalize()
-{
-    if (mode_ == Mode::File)
-    {
-        Debug::Log("Stop");
-        fs_.close();
-    }
-}
-
-
-void OutputApiError(const char* apiName)
-{
-    const auto error = ::GetLastError();
-    Debug::Error(apiName, "() failed with error code: ", error);
-}
-
-
-void OutputApiError(const char* func, const char* apiName)
-{
-    const auto error = ::GetLastError();
-    Debug::Error(func, "() => ", apiName, "() failed with error code: ", error);
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include "Debug.h"
+#include "LogRing.h"
+#include "Thread.h"
+#include "Util.h"
+
+
+decltype(Debug::mode_)                Debug::mode_ = Debug::Mode::File;
+decltype(Debug::level_)               Debug::level_ = Debug::Level::Log;
+decltype(Debug::logFunc_)             Debug::logFunc_ = nullptr;
+decltype(Debug::errFunc_)             Debug::errFunc_ = nullptr;
+decltype(Debug::fs_)                  Debug::fs_;
+decltype(Debug::outputMutex_)         Debug::outputMutex_;
+decltype(Debug::isWriterRunning_)     Debug::isWriterRunning_ = false;
+decltype(Debug::activeProducerCount_) Debug::activeProducerCount_ = 0;
+
+
+namespace
+{
+    const auto kWriterInterval = std::chrono::milliseconds(10);
+
+
+    struct LogRingHolder
+    {
+        ~LogRingHolder()
+        {
+            if (ring) ring->isOwnerAlive = false;
+        }
+
+        std::shared_ptr<LogRing> ring;
+    };
+
+
+    std::vector<std::shared_ptr<LogRing>> g_rings;
+    std::mutex g_ringsMutex;
+    std::atomic<UINT64> g_sequence = { 0 };
+    LogRateLimiter g_rateLimiter;
+    ThreadLoop g_writerThreadLoop(L"uWindowCapture - Log Writer Thread");
+    thread_local LogRingHolder t_ringHolder;
+
+
+    LogRing& GetThreadRing()
+    {
+        if (!t_ringHolder.ring)
+        {
+            t_ringHolder.ring = std::make_shared<LogRing>();
+            std::scoped_lock lock(g_ringsMutex);
+            g_rings.push_back(t_ringHolder.ring);
+        }
+        return *t_ringHolder.ring;
+    }
+}
+
+
+void Debug::Initialize()
+{
+    if (mode_ == Mode::File)
+    {
+        fs_.open("uWindowCapture.log");
+    }
+
+    isWriterRunning_ = true;
+    g_writerThreadLoop.Start([]
+    {
+        Drain();
+    }, kWriterInterval);
+
+    UWC_LOG("Start");
+}
+
+
+void Debug::Finalize()
+{
+    UWC_LOG("Stop");
+
+    // Messages logged from now on are written synchronously.
+    isWriterRunning_ = false;
+    g_writerThreadLoop.Stop();
+
+    // A producer which saw the writer running may still be pushing,
+    // so drain once more after the last one of them has finished.
+    while (activeProducerCount_ > 0)
+    {
+        std::this_thread::yield();
+    }
+    Drain();
+
+    if (fs_.is_open())
+    {
+        fs_.close();
+    }
+}
+
+
+std::ostringstream& Debug::GetThreadStream()
+{
+    thread_local std::ostringstream ss;
+    return ss;
+}
+
+
+bool Debug::CheckRateLimit(const DebugCallSite& site, uint32_t* pSuppressedCount)
+{
+    const auto key = reinterpret_cast<uintptr_t>(site.file) * 31 + static_cast<uintptr_t>(site.line);
+    return g_rateLimiter.Check(key, GetTimestampInMicroseconds(), pSuppressedCount);
+}
+
+
+void Debug::Push(Level level, std::string&& message)
+{
+    const auto sequence = g_sequence++;
+
+    // Pairs with Finalize(): either the writer is seen stopped here
+    // or Finalize() waits for this push before its last drain.
+    ++activeProducerCount_;
+    if (isWriterRunning_)
+    {
+        GetThreadRing().Push(level, sequence, std::move(message));
+        --activeProducerCount_;
+        return;
+    }
+    --activeProducerCount_;
+
+    std::scoped_lock lock(outputMutex_);
+    Output(level, time(nullptr), message.c_str());
+    if (fs_.is_open())
+    {
+        fs_.flush();
+    }
+}
+
+
+void Debug::Drain()
+{
+    // Run this scope in the log writer thread (or after it has stopped).
+
+    static std::vector<LogEntry> entries;
+    UINT64 droppedCount = 0;
+
+    {
+        std::scoped_lock lock(g_ringsMutex);
+
+        for (const auto& ring : g_rings)
+        {
+            ring->PopAll([&](LogEntry& entry)
+            {
+                entries.push_back(std::move(entry));
+            });
+            droppedCount += ring->TakeDroppedCount();
+        }
+
+        // Forget rings of exited threads once they have been drained.
+        g_rings.erase(
+            std::remove_if(
+                g_rings.begin(),
+                g_rings.end(),
+                [](const auto& ring)
+                {
+                    return !ring->isOwnerAlive && ring->IsEmpty();
+                }),
+            g_rings.end());
+    }
+
+    if (entries.empty() && droppedCount == 0) return;
+
+    // Rings are drained one by one, so restore the order in which messages were logged.
+    std::sort(
+        entries.begin(),
+        entries.end(),
+        [](const LogEntry& a, const LogEntry& b)
+        {
+            return a.sequence < b.sequence;
+        });
+
+    std::scoped_lock lock(outputMutex_);
+
+    for (const auto& entry : entries)
+    {
+        Output(entry.level, entry.time, entry.message.c_str());
+    }
+    entries.clear();
+
+    if (droppedCount > 0)
+    {
+        const auto message = std::to_string(droppedCount) + " messages were dropped because the log buffer was full.";
+        Output(Level::Error, time(nullptr), message.c_str());
+    }
+
+    if (fs_.is_open())
+    {
+        fs_.flush();
+    }
+}
+
+
+void Debug::Output(Level level, time_t time, const char* message)
+{
+    // Run this scope with outputMutex_ locked.
+
+    tm tm;
+    localtime_s(&tm, &time);
+    char timeBuf[64];
+    strftime(timeBuf, 64, "%F %T", &tm);
+
+    std::ostringstream ss;
+    ss << (level == Level::Error ? "[uWC::Err]" : "[uWC::Log]") << "[" << timeBuf << "] " << message;
+    const auto str = ss.str();
+
+    switch (mode_)
+    {
+        case Mode::None:
+        {
+            return;
+        }
+        case Mode::File:
+        {
+            if (fs_.good())
+            {
+                fs_ << str << '\n';
+            }
+            break;
+        }
+        case Mode::UnityLog:
+        {
+            switch (level)
+            {
+                case Level::Log   :
+                    if (const auto func = logFunc_.load()) func(str.c_str());
+                    break;
+                case Level::Error :
+                    if (const auto func = errFunc_.load()) func(str.c_str());
+                    break;
+                default:
+                    break;
+            }
+            break;
+        }
+    }
+}
+
+
+void OutputApiError(const char* apiName)
+{
+    // Keyed by the API name so that failures of different APIs are limited separately.
+    const auto error = ::GetLastError();
+    Debug::Error(DebugCallSite { apiName, __LINE__ }, apiName, "() failed with error code: ", error);
+}
+
+
+void OutputApiError(const char* func, const char* apiName)
+{
+    const auto error = ::GetLastError();
+    Debug::Error(DebugCallSite { apiName, __LINE__ }, func, "() => ", apiName, "() failed with error code: ", error);
 }
\ No newline at end of file
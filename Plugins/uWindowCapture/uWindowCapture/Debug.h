@@ -1,144 +1,131 @@
-#pragma once
-
-#include <time.h>
-#include <fstream>
-#include <sstream>
-#include <mutex>
-
-#include "IUnityInterface.h"
-
-
-// Error handling
-void OutputApiError(const char* apiName);
-void OutputApiError(const char* func, const char* apiName);
-
-
-// Logging
-class Debug
-{
-public:
-    enum class Mode
-    {
-        None = 0,
-        File = 1,
-        UnityLog = 2,
-    };
-
-    using DebugLogFuncPtr = void(UNITY_INTERFACE_API *)(const char*);
-
-    static void SetMode(Mode mode) { mode_ = mode; }
-    static void Initialize();
-    static void Finalize();
-    static void SetLogFunc(DebugLogFuncPtr func) { logFunc_ = func; }
-    static void SetErrorFunc(DebugLogFuncPtr func) { errFunc_ = func; }
-
-private:
-    enum class Level
-    {
-        Log,
-        Error
-    };
-
-    template <class T>
-    static void Output(T&& arg)
-    {
-        if (mode_ == Mode::None) return;
-        if (ss_.good())
-        {
-            ss_ << std::forward<T>(arg);
-        }
-    }
-
-    static void Flush(Level level)
-    {
-        switch (mode_)
-        {
-            case Mode::None:
-            {
-                return;
-            }
-            case Mode::File:
-            {
-                if (fs_.good() && ss_.good())
-                {
-                    const auto str = ss_.str();
-                    fs_ << str << std::endl;
-                    fs_.flush();
-                }
-                break;
-            }
-            case Mode::UnityLog:
-            {
-                if (ss_.good())
-                {
-                    switch (level)
-                    {
-                        case Level::Log   : 
-                            if (logFunc_) logFunc_(ss_.str().c_str()); 
-                            break;
-                        case Level::Error : 
-                            if (errFunc_) errFunc_(ss_.str().c_str()); 
-                            break;
-                    }
-                }
-                break;
-            }
-        }
-        ss_.str("");
-        ss_.clear(std::stringstream::goodbit);
-    }
-
-    template <class Arg, class... RestArgs>
-    static void _Log(Level level, Arg&& arg, RestArgs&&... restArgs)
-    {
-        Output(std::forward<Arg>(arg));
-        _Log(level, std::forward<RestArgs>(restArgs)...);
-    }
-
-    static void _Log(Level level)
-    {
-        Flush(level);
-    }
-
-    static void OutputTime()
-    {
-        auto t = time(nullptr);
-        tm tm;
-        localtime_s(&tm, &t);
-        char buf[64];
-        strftime(buf, 64, "%F %T", &tm);
-        Output("[");;
-        Output(buf);
-        Output("]");
-    }
-
-public:
-    template <class Arg, class... RestArgs>
-    static void Log(Arg&& arg, RestArgs&&... restArgs)
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        Output("[uWC::Log]");
-        OutputTime();
-        Output(" ");
-        _Log(Level::Log, std::forward<Arg>(arg), std::forward<RestArgs>(restArgs)...);
-    }
-
-    template <class Arg, class... RestArgs>
-    static void Error(Arg&& arg, RestArgs&&... restArgs)
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        Output("[uWC::Err]");
-        OutputTime();
-        Output(" ");
-        _Log(Level::Error, std::forward<Arg>(arg), std::forward<RestArgs>(restArgs)...);
-    }
-
-private:
-    static bool isInitialized_;
-    static Mode mode_;
-    static std::ofstream fs_;
-    static std::ostringstream ss_;
-    static DebugLogFuncPtr logFunc_;
-    static DebugLogFuncPtr errFunc_;
-    static std::mutex mutex_;
-};
+#pragma once
+
+#include <time.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#include "IUnityInterface.h"
+
+
+// Messages below this level are compiled out (0: Log, 1: Error, 2: None).
+#ifndef UWC_LOG_LEVEL
+#define UWC_LOG_LEVEL 0
+#endif
+
+
+// Error handling
+void OutputApiError(const char* apiName);
+void OutputApiError(const char* func, const char* apiName);
+
+
+// Identifies a logging call site for the rate limiting.
+struct DebugCallSite
+{
+    const char* file;
+    int line;
+};
+
+
+// Logging
+class Debug
+{
+public:
+    enum class Mode
+    {
+        None = 0,
+        File = 1,
+        UnityLog = 2,
+    };
+
+    enum class Level
+    {
+        Log = 0,
+        Error = 1,
+        None = 2,
+    };
+
+    using DebugLogFuncPtr = void(UNITY_INTERFACE_API *)(const char*);
+
+    static void SetMode(Mode mode) { mode_ = mode; }
+    static void SetLevel(Level level) { level_ = level; }
+    static void Initialize();
+    static void Finalize();
+    static void SetLogFunc(DebugLogFuncPtr func) { logFunc_ = func; }
+    static void SetErrorFunc(DebugLogFuncPtr func) { errFunc_ = func; }
+
+    static bool IsEnabled(Level level)
+    {
+        return
+            mode_ != Mode::None &&
+            static_cast<int>(level) >= static_cast<int>(level_.load());
+    }
+
+    // Use UWC_LOG() and UWC_ERROR() which fill in the call site.
+    template <class Arg, class... RestArgs>
+    static void Log(const DebugCallSite& site, Arg&& arg, RestArgs&&... restArgs)
+    {
+        Write(Level::Log, site, std::forward<Arg>(arg), std::forward<RestArgs>(restArgs)...);
+    }
+
+    template <class Arg, class... RestArgs>
+    static void Error(const DebugCallSite& site, Arg&& arg, RestArgs&&... restArgs)
+    {
+        Write(Level::Error, site, std::forward<Arg>(arg), std::forward<RestArgs>(restArgs)...);
+    }
+
+private:
+    template <class Arg, class... RestArgs>
+    static void Write(Level level, const DebugCallSite& site, Arg&& arg, RestArgs&&... restArgs)
+    {
+        if (!IsEnabled(level)) return;
+
+        uint32_t suppressedCount = 0;
+        if (!CheckRateLimit(site, &suppressedCount)) return;
+
+        auto& ss = GetThreadStream();
+        ss << std::forward<Arg>(arg);
+        ((ss << std::forward<RestArgs>(restArgs)), ...);
+        if (suppressedCount > 0)
+        {
+            ss << " (" << suppressedCount << " similar messages were suppressed)";
+        }
+
+        Push(level, ss.str());
+
+        ss.str("");
+        ss.clear(std::stringstream::goodbit);
+    }
+
+    static std::ostringstream& GetThreadStream();
+    static bool CheckRateLimit(const DebugCallSite& site, uint32_t* pSuppressedCount);
+    static void Push(Level level, std::string&& message);
+    static void Drain();
+    static void Output(Level level, time_t time, const char* message);
+
+    static std::atomic<Mode> mode_;
+    static std::atomic<Level> level_;
+    static std::ofstream fs_;
+    static std::atomic<DebugLogFuncPtr> logFunc_;
+    static std::atomic<DebugLogFuncPtr> errFunc_;
+    static std::mutex outputMutex_;
+    static std::atomic<bool> isWriterRunning_;
+    static std::atomic<int> activeProducerCount_;
+};
+
+
+// Levels below UWC_LOG_LEVEL are compiled out together with their arguments.
+#if UWC_LOG_LEVEL <= 0
+#define UWC_LOG(...) Debug::Log(DebugCallSite { __FILE__, __LINE__ }, __VA_ARGS__)
+#else
+#define UWC_LOG(...) ((void)0)
+#endif
+
+#if UWC_LOG_LEVEL <= 1
+#define UWC_ERROR(...) Debug::Error(DebugCallSite { __FILE__, __LINE__ }, __VA_ARGS__)
+#else
+#define UWC_ERROR(...) ((void)0)
+#endif
@@ -0,0 +1,55 @@
+#include <functional>
+#include "LogRing.h"
+
+
+
+bool LogRing::Push(Debug::Level level, UINT64 sequence, std::string&& message)
+{
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) >= kCapacity)
+    {
+        ++droppedCount_;
+        return false;
+    }
+
+    auto& entry = entries_[tail % kCapacity];
+    entry.sequence = sequence;
+    entry.time = time(nullptr);
+    entry.level = level;
+    entry.message = std::move(message);
+
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+
+bool LogRing::IsEmpty() const
+{
+    return head_.load() == tail_.load();
+}
+
+
+UINT64 LogRing::TakeDroppedCount()
+{
+    return droppedCount_.exchange(0);
+}
+
+
+bool LogRateLimiter::Check(uintptr_t key, INT64 now, uint32_t* pSuppressedCount)
+{
+    const auto hash = std::hash<uintptr_t>()(key);
+    auto& slot = slots_[hash % kSlotCount];
+
+    auto windowStartTime = slot.windowStartTime.load();
+    if (now - windowStartTime >= kWindow &&
+        slot.windowStartTime.compare_exchange_strong(windowStartTime, now))
+    {
+        slot.count = 0;
+        *pSuppressedCount = slot.suppressedCount.exchange(0);
+    }
+
+    if (slot.count.fetch_add(1) < kBurstCount) return true;
+
+    ++slot.suppressedCount;
+    return false;
+}
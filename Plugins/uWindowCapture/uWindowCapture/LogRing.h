@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Windows.h>
+#include <array>
+#include <atomic>
+#include <string>
+#include <ctime>
+#include "Debug.h"
+
+
+
+struct LogEntry
+{
+    UINT64 sequence = 0;
+    time_t time = 0;
+    Debug::Level level = Debug::Level::Log;
+    std::string message;
+};
+
+
+// Single-producer single-consumer ring owned by one logging thread
+// and drained by the writer thread. Entries keep the whole message.
+class LogRing
+{
+public:
+    static constexpr size_t kCapacity = 128;
+
+    bool Push(Debug::Level level, UINT64 sequence, std::string&& message);
+
+    // Passes each entry as a mutable reference so that the consumer can move the message out.
+    template <class Func>
+    void PopAll(const Func& func)
+    {
+        const auto head = head_.load(std::memory_order_relaxed);
+        const auto tail = tail_.load(std::memory_order_acquire);
+        for (auto i = head; i < tail; ++i)
+        {
+            func(entries_[i % kCapacity]);
+        }
+        head_.store(tail, std::memory_order_release);
+    }
+
+    bool IsEmpty() const;
+    UINT64 TakeDroppedCount();
+
+    std::atomic<bool> isOwnerAlive = { true };
+
+private:
+    std::array<LogEntry, kCapacity> entries_;
+    std::atomic<size_t> head_ = { 0 };
+    std::atomic<size_t> tail_ = { 0 };
+    std::atomic<UINT64> droppedCount_ = { 0 };
+};
+
+
+// Lets each call site log a burst of messages per time window and counts
+// the suppressed ones. Call sites hashed into the same slot share the limit.
+class LogRateLimiter
+{
+public:
+    static constexpr size_t kSlotCount = 256;
+    static constexpr uint32_t kBurstCount = 10;
+    static constexpr INT64 kWindow = 1'000'000; // [us]
+
+    // Returns false when the message should be suppressed. The count of the
+    // messages suppressed in the previous window is reported once.
+    bool Check(uintptr_t key, INT64 now, uint32_t* pSuppressedCount);
+
+private:
+    struct Slot
+    {
+        std::atomic<INT64> windowStartTime = { 0 };
+        std::atomic<uint32_t> count = { 0 };
+        std::atomic<uint32_t> suppressedCount = { 0 };
+    };
+
+    std::array<Slot, kSlotCount> slots_;
+};
@@ -1,713 +1,1021 @@
-#include <d3d11.h>
-#include <dxgi1_2.h>
-#include <Windows.h>
-#include <memory>
-
-#include "IUnityInterface.h"
-#include "IUnityGraphics.h"
-
-#include "Debug.h"
-#include "Message.h"
-#include "UploadManager.h"
-#include "CaptureManager.h"
-#include "Window.h"
-#include "Cursor.h"
-#include "WindowTexture.h"
-#include "WindowManager.h"
-
-#include "Util.h"
-
-#pragma comment(lib, "dxgi.lib")
-#pragma comment(lib, "Dwmapi.lib")
-
-
-// flag to check if this plugin has initialized.
-bool g_hasInitialized = false;
-
-// unity interafece to access ID3D11Device.
-IUnityInterfaces* g_unity = nullptr;
-
-
-std::shared_ptr<Window> GetWindow(int id)
-{
-    if (WindowManager::IsNull()) return nullptr;
-    return WindowManager::Get().GetWindow(id);
-}
-
-
-extern "C"
-{
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcInitialize()
-    {
-        if (g_hasInitialized) return;
-        g_hasInitialized = true;
-
-        Debug::Initialize();
-
-        MessageManager::Create();
-
-        WindowManager::Create();
-        WindowManager::Get().Initialize();
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcFinalize()
-    {
-        if (!g_hasInitialized) return;
-        g_hasInitialized = false;
-
-        WindowManager::Get().Finalize();
-        WindowManager::Destroy();
-
-        MessageManager::Destroy();
-
-        Debug::Finalize();
-    }
-
-    void UNITY_INTERFACE_API OnGraphicsDeviceEvent(UnityGfxDeviceEventType event)
-    {
-        switch (event)
-        {
-        case kUnityGfxDeviceEventInitialize:
-        {
-            UwcInitialize();
-            break;
-        }
-        case kUnityGfxDeviceEventShutdown:
-        {
-            UwcFinalize();
-            break;
-        }
-        }
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UnityPluginLoad(IUnityInterfaces* unityInterfaces)
-    {
-        g_unity = unityInterfaces;
-        auto unityGraphics = g_unity->Get<IUnityGraphics>();
-        unityGraphics->RegisterDeviceEventCallback(OnGraphicsDeviceEvent);
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UnityPluginUnload()
-    {
-        auto unityGraphics = g_unity->Get<IUnityGraphics>();
-        unityGraphics->UnregisterDeviceEventCallback(OnGraphicsDeviceEvent);
-        g_unity = nullptr;
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetDebugMode(Debug::Mode mode)
-    {
-        Debug::SetMode(mode);
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetLogFunc(Debug::DebugLogFuncPtr func)
-    {
-        Debug::SetLogFunc(func);
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetErrorFunc(Debug::DebugLogFuncPtr func)
-    {
-        Debug::SetErrorFunc(func);
-    }
-
-    void UNITY_INTERFACE_API OnRenderEvent(int id)
-    {
-        if (WindowManager::IsNull()) return;
-        WindowManager::Get().Render();
-    }
-
-    UNITY_INTERFACE_EXPORT UnityRenderingEvent UNITY_INTERFACE_API UwcGetRenderEventFunc()
-    {
-        return OnRenderEvent;
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcUpdate(float dt)
-    {
-        if (WindowManager::IsNull()) return;
-        WindowManager::Get().Update(dt);
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetMessageCount()
-    {
-        if (MessageManager::IsNull()) return 0;
-        return MessageManager::Get().GetCount();
-    }
-
-    UNITY_INTERFACE_EXPORT const Message* UNITY_INTERFACE_API UwcGetMessages()
-    {
-        if (MessageManager::IsNull()) return nullptr;
-        return MessageManager::Get().GetHeadPointer();
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcExcludeRemovedWindowEvents()
-    {
-        if (MessageManager::IsNull()) return;
-        MessageManager::Get().ExcludeRemovedWindowEvents();
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcClearMessages()
-    {
-        if (MessageManager::IsNull()) return;
-        MessageManager::Get().ClearAll();
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcCheckWindowExistence(int id)
-    {
-        if (WindowManager::IsNull()) return false;
-        return WindowManager::Get().CheckExistence(id);
-    }
-
-    UNITY_INTERFACE_EXPORT int UNITY_INTERFACE_API UwcGetWindowParentId(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetParentId();
-        }
-        return -1;
-    }
-
-    UNITY_INTERFACE_EXPORT HWND UNITY_INTERFACE_API UwcGetWindowHandle(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetWindowHandle();
-        }
-        return nullptr;
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcRequestUpdateWindowTitle(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->RequestUpdateTitle();
-        }
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcRequestCaptureWindow(int id, CapturePriority priority)
-    {
-        if (WindowManager::IsNull()) return;
-        WindowManager::GetCaptureManager()->RequestCapture(id, priority);
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcRequestCaptureIcon(int id)
-    {
-        if (WindowManager::IsNull()) return;
-        WindowManager::GetCaptureManager()->RequestCaptureIcon(id);
-    }
-
-    UNITY_INTERFACE_EXPORT HWND UNITY_INTERFACE_API UwcGetWindowOwnerHandle(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetOwnerHandle();
-        }
-        return nullptr;
-    }
-
-    UNITY_INTERFACE_EXPORT HWND UNITY_INTERFACE_API UwcGetWindowParentHandle(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetParentHandle();
-        }
-        return nullptr;
-    }
-
-    UNITY_INTERFACE_EXPORT HINSTANCE UNITY_INTERFACE_API UwcGetWindowInstance(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetInstance();
-        }
-        return nullptr;
-    }
-
-    UNITY_INTERFACE_EXPORT DWORD UNITY_INTERFACE_API UwcGetWindowProcessId(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetProcessId();
-        }
-        return -1;
-    }
-
-    UNITY_INTERFACE_EXPORT DWORD UNITY_INTERFACE_API UwcGetWindowThreadId(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetThreadId();
-        }
-        return -1;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowX(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetX();
-        }
-        return 0;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowY(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetY();
-        }
-        return 0;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowWidth(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetWidth();
-        }
-        return 0;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowHeight(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetHeight();
-        }
-        return 0;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowZOrder(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetZOrder();
-        }
-        return 0;
-    }
-
-    UNITY_INTERFACE_EXPORT BYTE* UNITY_INTERFACE_API UwcGetWindowBuffer(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetBuffer();
-        }
-        return nullptr;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowTextureWidth(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetTextureWidth();
-        }
-        return 0;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowTextureHeight(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetTextureHeight();
-        }
-        return 0;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowTextureOffsetX(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetTextureOffsetX();
-        }
-        return 0;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowTextureOffsetY(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetTextureOffsetY();
-        }
-        return 0;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowIconWidth(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetIconWidth();
-        }
-        return 0;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowIconHeight(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetIconHeight();
-        }
-        return 0;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowTitleLength(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return static_cast<UINT>(window->GetTitle().length());
-        }
-        return 0;
-    }
-
-    UNITY_INTERFACE_EXPORT const WCHAR* UNITY_INTERFACE_API UwcGetWindowTitle(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetTitle().c_str();
-        }
-        return nullptr;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowClassNameLength(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return static_cast<UINT>(window->GetClass().length());
-        }
-        return 0;
-    }
-
-    UNITY_INTERFACE_EXPORT const CHAR* UNITY_INTERFACE_API UwcGetWindowClassName(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetClass().c_str();
-        }
-        return nullptr;
-    }
-
-    UNITY_INTERFACE_EXPORT ID3D11Texture2D* UNITY_INTERFACE_API UwcGetWindowTexturePtr(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetWindowTexture();
-        }
-        return nullptr;
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetWindowTexturePtr(int id, ID3D11Texture2D* ptr)
-    {
-        if (auto window = GetWindow(id))
-        {
-            window->SetWindowTexture(ptr);
-        }
-    }
-
-    UNITY_INTERFACE_EXPORT ID3D11Texture2D* UNITY_INTERFACE_API UwcGetWindowIconTexturePtr(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetIconTexture();
-        }
-        return nullptr;
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetWindowIconTexturePtr(int id, ID3D11Texture2D* ptr)
-    {
-        if (auto window = GetWindow(id))
-        {
-            window->SetIconTexture(ptr);
-        }
-    }
-
-    UNITY_INTERFACE_EXPORT CaptureMode UNITY_INTERFACE_API UwcGetWindowCaptureMode(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetCaptureMode();
-        }
-        return CaptureMode::None;
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetWindowCaptureMode(int id, CaptureMode mode)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->SetCaptureMode(mode);
-        }
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcGetWindowCursorDraw(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetCursorDraw();
-        }
-        return false;
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetWindowCursorDraw(int id, bool draw)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->SetCursorDraw(draw);
-        }
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindow(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->IsWindow() > 0;
-        }
-        return false;
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsAltTabWindow(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->IsAltTab();
-        }
-        return false;
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsDesktop(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->IsDesktop();
-        }
-        return false;
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowVisible(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->IsVisible() > 0;
-        }
-        return false;
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowEnabled(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->IsEnabled() > 0;
-        }
-        return false;
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowUnicode(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->IsUnicode() > 0;
-        }
-        return false;
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowZoomed(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->IsZoomed() > 0;
-        }
-        return false;
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowIconic(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->IsIconic() > 0;
-        }
-        return false;
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowHungUp(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->IsHungUp() > 0;
-        }
-        return false;
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowTouchable(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->IsTouchable() > 0;
-        }
-        return false;
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowApplicationFrameWindow(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->IsApplicationFrameWindow() > 0;
-        }
-        return false;
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowUWP(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return IsUWP(window->GetProcessId());
-        }
-        return false;
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowBackground(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->IsBackground() > 0;
-        }
-        return false;
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowsGraphicsCaptureAvailable(int id)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->IsWindowsGraphicsCaptureAvailable();
-        }
-        return false;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowPixel(int id, int x, int y)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetPixel(x, y);
-        }
-        return 0;
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcGetWindowPixels(int id, BYTE* output, int x, int y, int width, int height)
-    {
-        if (auto window = GetWindow(id))
-        {
-            return window->GetPixels(output, x, y, width, height);
-        }
-        return false;
-    }
-
-    UNITY_INTERFACE_EXPORT POINT UNITY_INTERFACE_API UwcGetCursorPosition()
-    {
-        POINT point;
-        GetCursorPos(&point);
-        return point;
-    }
-
-    UNITY_INTERFACE_EXPORT int UNITY_INTERFACE_API UwcGetWindowIdFromPoint(int x, int y)
-    {
-        if (WindowManager::IsNull()) return -1;
-        if (auto window = WindowManager::Get().GetWindowFromPoint({ x, y }))
-        {
-            return window->GetId();
-        }
-        return -1;
-    }
-
-    UNITY_INTERFACE_EXPORT int UNITY_INTERFACE_API UwcGetWindowIdUnderCursor()
-    {
-        if (WindowManager::IsNull()) return -1;
-        if (auto window = WindowManager::Get().GetCursorWindow())
-        {
-            return window->GetId();
-        }
-        return -1;
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcRequestCaptureCursor()
-    {
-        if (WindowManager::IsNull()) return;
-        if (auto& cursor = WindowManager::Get().GetCursor())
-        {
-            return cursor->RequestCapture();
-        }
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetCursorX()
-    {
-        if (WindowManager::IsNull()) return -1;
-        if (auto& cursor = WindowManager::Get().GetCursor())
-        {
-            return cursor->GetX();
-        }
-        return -1;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetCursorY()
-    {
-        if (WindowManager::IsNull()) return -1;
-        if (auto& cursor = WindowManager::Get().GetCursor())
-        {
-            return cursor->GetY();
-        }
-        return -1;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetCursorWidth()
-    {
-        if (WindowManager::IsNull()) return -1;
-        if (auto& cursor = WindowManager::Get().GetCursor())
-        {
-            return cursor->GetWidth();
-        }
-        return -1;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetCursorHeight()
-    {
-        if (WindowManager::IsNull()) return -1;
-        if (auto& cursor = WindowManager::Get().GetCursor())
-        {
-            return cursor->GetHeight();
-        }
-        return -1;
-    }
-
-    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetCursorTexturePtr(ID3D11Texture2D* ptr)
-    {
-        if (WindowManager::IsNull()) return;
-        if (auto& cursor = WindowManager::Get().GetCursor())
-        {
-            cursor->SetUnityTexturePtr(ptr);
-        }
-        return;
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetScreenX()
-    {
-        return ::GetSystemMetrics(SM_XVIRTUALSCREEN);
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetScreenY()
-    {
-        return ::GetSystemMetrics(SM_YVIRTUALSCREEN);
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetScreenWidth()
-    {
-        return ::GetSystemMetrics(SM_CXVIRTUALSCREEN);
-    }
-
-    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetScreenHeight()
-    {
-        return ::GetSystemMetrics(SM_CYVIRTUALSCREEN);
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowsGraphicsCaptureSupported()
-    {
-        return WindowsGraphicsCapture::IsSupported();
-    }
-
-    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowsGraphicsCaptureCursorCaptureEnabledApiSupported()
-    {
-        return WindowsGraphicsCapture::IsCursorCaptureEnabledApiSupported();
-    }
+#include <d3d11.h>
+#include <dxgi1_2.h>
+#include <Windows.h>
+#include <memory>
+
+#include "IUnityInterface.h"
+#include "IUnityGraphics.h"
+
+#include "Debug.h"
+#include "Trace.h"
+#include "Message.h"
+#include "UploadManager.h"
+#include "CaptureManager.h"
+#include "Window.h"
+#include "Cursor.h"
+#include "WindowTexture.h"
+#include "WindowManager.h"
+
+#include "Util.h"
+
+#pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "Dwmapi.lib")
+
+
+// flag to check if this plugin has initialized.
+bool g_hasInitialized = false;
+
+// unity interafece to access ID3D11Device.
+IUnityInterfaces* g_unity = nullptr;
+
+// window filter set by UwcSetWindowFilter(), also applied before the first enumeration.
+WindowFilter::Settings g_windowFilterSettings;
+
+
+std::shared_ptr<Window> GetWindow(int id)
+{
+    if (WindowManager::IsNull()) return nullptr;
+    return WindowManager::Get().GetWindow(id);
+}
+
+
+// Metadata updated only by the window list thread is read from its published snapshot without
+// the window list lock. Titles, textures, icons, capture state and live window API queries
+// change outside the list update, so their getters still go through GetWindow().
+bool GetWindowSnapshot(int id, WindowSnapshot& snapshot)
+{
+    if (WindowManager::IsNull()) return false;
+    return WindowManager::Get().GetWindowSnapshot(id, snapshot);
+}
+
+
+extern "C"
+{
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcInitialize()
+    {
+        if (g_hasInitialized) return;
+        g_hasInitialized = true;
+
+        Debug::Initialize();
+
+        MessageManager::Create();
+
+        WindowManager::Create();
+        WindowManager::Get().Initialize(g_windowFilterSettings);
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcFinalize()
+    {
+        if (!g_hasInitialized) return;
+        g_hasInitialized = false;
+
+        WindowManager::Get().Finalize();
+        WindowManager::Destroy();
+
+        MessageManager::Destroy();
+
+        Debug::Finalize();
+    }
+
+    void UNITY_INTERFACE_API OnGraphicsDeviceEvent(UnityGfxDeviceEventType event)
+    {
+        switch (event)
+        {
+        case kUnityGfxDeviceEventInitialize:
+        {
+            UwcInitialize();
+            break;
+        }
+        case kUnityGfxDeviceEventShutdown:
+        {
+            UwcFinalize();
+            break;
+        }
+        }
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UnityPluginLoad(IUnityInterfaces* unityInterfaces)
+    {
+        g_unity = unityInterfaces;
+        auto unityGraphics = g_unity->Get<IUnityGraphics>();
+        unityGraphics->RegisterDeviceEventCallback(OnGraphicsDeviceEvent);
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UnityPluginUnload()
+    {
+        auto unityGraphics = g_unity->Get<IUnityGraphics>();
+        unityGraphics->UnregisterDeviceEventCallback(OnGraphicsDeviceEvent);
+        g_unity = nullptr;
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetDebugMode(Debug::Mode mode)
+    {
+        Debug::SetMode(mode);
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetDebugLevel(Debug::Level level)
+    {
+        Debug::SetLevel(level);
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetTraceMode(TraceMode mode)
+    {
+        Trace::SetMode(mode);
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetTraceFlightRecorderDuration(int duration)
+    {
+        Trace::SetFlightRecorderDuration(static_cast<INT64>(duration) * 1000);
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcClearTrace()
+    {
+        Trace::Clear();
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcExportTrace(const WCHAR* path)
+    {
+        if (!path) return false;
+        return Trace::Export(path);
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetLogFunc(Debug::DebugLogFuncPtr func)
+    {
+        Debug::SetLogFunc(func);
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetErrorFunc(Debug::DebugLogFuncPtr func)
+    {
+        Debug::SetErrorFunc(func);
+    }
+
+    void UNITY_INTERFACE_API OnRenderEvent(int id)
+    {
+        if (WindowManager::IsNull()) return;
+        WindowManager::Get().Render();
+    }
+
+    UNITY_INTERFACE_EXPORT UnityRenderingEvent UNITY_INTERFACE_API UwcGetRenderEventFunc()
+    {
+        return OnRenderEvent;
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcUpdate(float dt)
+    {
+        if (WindowManager::IsNull()) return;
+        WindowManager::Get().Update(dt);
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetMessageCount()
+    {
+        if (MessageManager::IsNull()) return 0;
+        return MessageManager::Get().GetCount();
+    }
+
+    UNITY_INTERFACE_EXPORT const Message* UNITY_INTERFACE_API UwcGetMessages()
+    {
+        if (MessageManager::IsNull()) return nullptr;
+        return MessageManager::Get().GetHeadPointer();
+    }
+
+    UNITY_INTERFACE_EXPORT const Message* UNITY_INTERFACE_API UwcSwapMessages(UINT* count)
+    {
+        if (MessageManager::IsNull())
+        {
+            if (count) *count = 0;
+            return nullptr;
+        }
+        return MessageManager::Get().Swap(count);
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcExcludeRemovedWindowEvents()
+    {
+        if (MessageManager::IsNull()) return;
+        MessageManager::Get().ExcludeRemovedWindowEvents();
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcClearMessages()
+    {
+        if (MessageManager::IsNull()) return;
+        MessageManager::Get().ClearAll();
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSubscribeMessageType(MessageType type, bool subscribe)
+    {
+        if (MessageManager::IsNull()) return;
+        MessageManager::Get().SubscribeType(type, subscribe);
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsMessageTypeSubscribed(MessageType type)
+    {
+        if (MessageManager::IsNull()) return false;
+        return MessageManager::Get().IsTypeSubscribed(type);
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetMessageWindowFilter(MessageWindowFilter filter)
+    {
+        if (MessageManager::IsNull()) return;
+        MessageManager::Get().SetWindowFilter(filter);
+    }
+
+    UNITY_INTERFACE_EXPORT MessageWindowFilter UNITY_INTERFACE_API UwcGetMessageWindowFilter()
+    {
+        if (MessageManager::IsNull()) return MessageWindowFilter::All;
+        return MessageManager::Get().GetWindowFilter();
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSubscribeWindowMessages(int id, bool subscribe)
+    {
+        if (MessageManager::IsNull()) return;
+        MessageManager::Get().SubscribeWindow(id, subscribe);
+    }
+
+    UNITY_INTERFACE_EXPORT UINT64 UNITY_INTERFACE_API UwcGetProducedMessageCount(MessageType type)
+    {
+        if (MessageManager::IsNull()) return 0;
+        return MessageManager::Get().GetProducedCount(type);
+    }
+
+    UNITY_INTERFACE_EXPORT UINT64 UNITY_INTERFACE_API UwcGetDeliveredMessageCount(MessageType type)
+    {
+        if (MessageManager::IsNull()) return 0;
+        return MessageManager::Get().GetDeliveredCount(type);
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetMessageCallback(MessageType type, MessageCallbackFuncPtr func, void* userData, MessageCallbackMode mode)
+    {
+        if (MessageManager::IsNull()) return;
+        MessageManager::Get().SetCallback(type, func, userData, mode);
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowInfos(WindowInfo* buffer, UINT capacity)
+    {
+        if (WindowManager::IsNull()) return 0;
+        return WindowManager::Get().CopyWindowInfos(buffer, capacity);
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetWindowFilter(bool isAltTabOnly, int minWidth, int minHeight, const WindowFilterPatternDesc* patterns, int patternCount)
+    {
+        WindowFilter::Settings settings;
+        settings.isAltTabOnly = isAltTabOnly;
+        settings.minWidth = minWidth;
+        settings.minHeight = minHeight;
+        for (int i = 0; patterns && i < patternCount; ++i)
+        {
+            const auto& p = patterns[i];
+            if (!p.pattern || !p.pattern[0]) continue;
+            settings.patterns.push_back({ p.target, p.mode, p.pattern });
+        }
+        g_windowFilterSettings = settings;
+
+        // Before UwcInitialize() the settings are applied when the window manager starts.
+        if (WindowManager::IsNull()) return;
+        if (auto& filter = WindowManager::Get().GetWindowFilter())
+        {
+            filter->Set(std::move(settings));
+        }
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetWindowFilterAltTabOnly(bool isAltTabOnly)
+    {
+        if (WindowManager::IsNull()) return;
+        if (auto& filter = WindowManager::Get().GetWindowFilter())
+        {
+            filter->SetAltTabOnly(isAltTabOnly);
+        }
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetWindowFilterMinSize(int width, int height)
+    {
+        if (WindowManager::IsNull()) return;
+        if (auto& filter = WindowManager::Get().GetWindowFilter())
+        {
+            filter->SetMinSize(width, height);
+        }
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcAddWindowFilterPattern(WindowFilterTarget target, WindowFilterMode mode, const WCHAR* pattern)
+    {
+        if (WindowManager::IsNull() || !pattern) return;
+        if (auto& filter = WindowManager::Get().GetWindowFilter())
+        {
+            filter->AddPattern(target, mode, pattern);
+        }
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcClearWindowFilter()
+    {
+        if (WindowManager::IsNull()) return;
+        if (auto& filter = WindowManager::Get().GetWindowFilter())
+        {
+            filter->Clear();
+        }
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcCheckWindowExistence(int id)
+    {
+        if (WindowManager::IsNull()) return false;
+        return WindowManager::Get().CheckExistence(id);
+    }
+
+    UNITY_INTERFACE_EXPORT int UNITY_INTERFACE_API UwcGetWindowParentId(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return snapshot.parentId;
+        }
+        return -1;
+    }
+
+    UNITY_INTERFACE_EXPORT HWND UNITY_INTERFACE_API UwcGetWindowHandle(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return snapshot.hWnd;
+        }
+        return nullptr;
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcRequestUpdateWindowTitle(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->RequestUpdateTitle();
+        }
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcRequestCaptureWindow(int id, CapturePriority priority)
+    {
+        if (WindowManager::IsNull()) return;
+        WindowManager::GetCaptureManager()->RequestCapture(id, priority);
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcRequestCaptureIcon(int id)
+    {
+        if (WindowManager::IsNull()) return;
+        WindowManager::GetCaptureManager()->RequestCaptureIcon(id);
+    }
+
+    UNITY_INTERFACE_EXPORT int UNITY_INTERFACE_API UwcRequestCaptureWindowTicket(int id, CapturePriority priority)
+    {
+        if (WindowManager::IsNull()) return -1;
+        return WindowManager::GetCaptureManager()->RequestCaptureTicket(id, priority);
+    }
+
+    UNITY_INTERFACE_EXPORT CaptureTicketState UNITY_INTERFACE_API UwcGetCaptureTicketResult(int ticketId, CaptureTicketResult* result)
+    {
+        if (WindowManager::IsNull()) return CaptureTicketState::Invalid;
+        return WindowManager::GetCaptureManager()->GetTicketManager().Get(ticketId, result);
+    }
+
+    UNITY_INTERFACE_EXPORT CaptureTicketState UNITY_INTERFACE_API UwcWaitCaptureTicket(int ticketId, UINT timeout, CaptureTicketResult* result)
+    {
+        if (WindowManager::IsNull()) return CaptureTicketState::Invalid;
+        return WindowManager::GetCaptureManager()->GetTicketManager().Wait(ticketId, timeout, result);
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcSetCaptureTicketCallback(int ticketId, CaptureTicketCallbackFuncPtr func, void* userData)
+    {
+        if (WindowManager::IsNull() || !func) return false;
+        return WindowManager::GetCaptureManager()->GetTicketManager().AddCallback(ticketId, [func, userData](const CaptureTicketResult& result)
+        {
+            func(&result, userData);
+        });
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcReleaseCaptureTicket(int ticketId)
+    {
+        if (WindowManager::IsNull()) return;
+        WindowManager::GetCaptureManager()->GetTicketManager().Release(ticketId);
+    }
+
+    UNITY_INTERFACE_EXPORT HWND UNITY_INTERFACE_API UwcGetWindowOwnerHandle(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return snapshot.hOwner;
+        }
+        return nullptr;
+    }
+
+    UNITY_INTERFACE_EXPORT HWND UNITY_INTERFACE_API UwcGetWindowParentHandle(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return snapshot.hParent;
+        }
+        return nullptr;
+    }
+
+    UNITY_INTERFACE_EXPORT HINSTANCE UNITY_INTERFACE_API UwcGetWindowInstance(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return snapshot.hInstance;
+        }
+        return nullptr;
+    }
+
+    UNITY_INTERFACE_EXPORT DWORD UNITY_INTERFACE_API UwcGetWindowProcessId(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return snapshot.processId;
+        }
+        return -1;
+    }
+
+    UNITY_INTERFACE_EXPORT DWORD UNITY_INTERFACE_API UwcGetWindowThreadId(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return snapshot.threadId;
+        }
+        return -1;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowX(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return snapshot.windowRect.left;
+        }
+        return 0;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowY(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return snapshot.windowRect.top;
+        }
+        return 0;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowWidth(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return snapshot.windowRect.right - snapshot.windowRect.left;
+        }
+        return 0;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowHeight(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return snapshot.windowRect.bottom - snapshot.windowRect.top;
+        }
+        return 0;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowZOrder(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return snapshot.zOrder;
+        }
+        return 0;
+    }
+
+    UNITY_INTERFACE_EXPORT BYTE* UNITY_INTERFACE_API UwcGetWindowBuffer(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetBuffer();
+        }
+        return nullptr;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowTextureWidth(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetTextureWidth();
+        }
+        return 0;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowTextureHeight(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetTextureHeight();
+        }
+        return 0;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowTextureOffsetX(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetTextureOffsetX();
+        }
+        return 0;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowTextureOffsetY(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetTextureOffsetY();
+        }
+        return 0;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowIconWidth(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetIconWidth();
+        }
+        return 0;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowIconHeight(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetIconHeight();
+        }
+        return 0;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowTitleLength(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return static_cast<UINT>(window->GetTitle().length());
+        }
+        return 0;
+    }
+
+    UNITY_INTERFACE_EXPORT const WCHAR* UNITY_INTERFACE_API UwcGetWindowTitle(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetTitle().c_str();
+        }
+        return nullptr;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowClassNameLength(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return static_cast<UINT>(window->GetClass().length());
+        }
+        return 0;
+    }
+
+    UNITY_INTERFACE_EXPORT const CHAR* UNITY_INTERFACE_API UwcGetWindowClassName(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetClass().c_str();
+        }
+        return nullptr;
+    }
+
+    UNITY_INTERFACE_EXPORT ID3D11Texture2D* UNITY_INTERFACE_API UwcGetWindowTexturePtr(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetWindowTexture();
+        }
+        return nullptr;
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetWindowTexturePtr(int id, ID3D11Texture2D* ptr)
+    {
+        if (auto window = GetWindow(id))
+        {
+            window->SetWindowTexture(ptr);
+        }
+    }
+
+    UNITY_INTERFACE_EXPORT ID3D11Texture2D* UNITY_INTERFACE_API UwcGetWindowIconTexturePtr(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetIconTexture();
+        }
+        return nullptr;
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetWindowIconTexturePtr(int id, ID3D11Texture2D* ptr)
+    {
+        if (auto window = GetWindow(id))
+        {
+            window->SetIconTexture(ptr);
+        }
+    }
+
+    UNITY_INTERFACE_EXPORT CaptureMode UNITY_INTERFACE_API UwcGetWindowCaptureMode(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetCaptureMode();
+        }
+        return CaptureMode::None;
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetWindowCaptureMode(int id, CaptureMode mode)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->SetCaptureMode(mode);
+        }
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcGetWindowCursorDraw(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetCursorDraw();
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetWindowCursorDraw(int id, bool draw)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->SetCursorDraw(draw);
+        }
+    }
+
+    UNITY_INTERFACE_EXPORT int UNITY_INTERFACE_API UwcGetWindowCapturePoolDepth(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetCapturePoolDepth();
+        }
+        return 0;
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetWindowCapturePoolDepth(int id, int depth)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->SetCapturePoolDepth(depth);
+        }
+    }
+
+    UNITY_INTERFACE_EXPORT CapturePixelFormat UNITY_INTERFACE_API UwcGetWindowCapturePixelFormat(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetCapturePixelFormat();
+        }
+        return CapturePixelFormat::B8G8R8A8UIntNormalized;
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetWindowCapturePixelFormat(int id, CapturePixelFormat format)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->SetCapturePixelFormat(format);
+        }
+    }
+
+    UNITY_INTERFACE_EXPORT CaptureFrameArrivalMode UNITY_INTERFACE_API UwcGetWindowCaptureFrameArrivalMode(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetCaptureFrameArrivalMode();
+        }
+        return CaptureFrameArrivalMode::Polling;
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetWindowCaptureFrameArrivalMode(int id, CaptureFrameArrivalMode mode)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->SetCaptureFrameArrivalMode(mode);
+        }
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcGetWindowCaptureFrameStats(int id, CaptureFrameStats* stats)
+    {
+        if (!stats) return false;
+        if (auto window = GetWindow(id))
+        {
+            *stats = window->GetCaptureFrameStats();
+            return true;
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindow(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->IsWindow() > 0;
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsAltTabWindow(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return snapshot.isAltTabWindow;
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsDesktop(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return snapshot.isDesktop;
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowVisible(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->IsVisible() > 0;
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowEnabled(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->IsEnabled() > 0;
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowUnicode(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->IsUnicode() > 0;
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowZoomed(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->IsZoomed() > 0;
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowIconic(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->IsIconic() > 0;
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowHungUp(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->IsHungUp() > 0;
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowTouchable(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->IsTouchable() > 0;
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowApplicationFrameWindow(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return snapshot.isApplicationFrameWindow;
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowUWP(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return IsUWP(snapshot.processId);
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowBackground(int id)
+    {
+        WindowSnapshot snapshot;
+        if (GetWindowSnapshot(id, snapshot))
+        {
+            return snapshot.isBackground;
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowsGraphicsCaptureAvailable(int id)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->IsWindowsGraphicsCaptureAvailable();
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetWindowPixel(int id, int x, int y)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetPixel(x, y);
+        }
+        return 0;
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcGetWindowPixels(int id, BYTE* output, int x, int y, int width, int height)
+    {
+        if (auto window = GetWindow(id))
+        {
+            return window->GetPixels(output, x, y, width, height);
+        }
+        return false;
+    }
+
+    UNITY_INTERFACE_EXPORT POINT UNITY_INTERFACE_API UwcGetCursorPosition()
+    {
+        POINT point;
+        GetCursorPos(&point);
+        return point;
+    }
+
+    UNITY_INTERFACE_EXPORT int UNITY_INTERFACE_API UwcGetWindowIdFromPoint(int x, int y)
+    {
+        if (WindowManager::IsNull()) return -1;
+        if (auto window = WindowManager::Get().GetWindowFromPoint({ x, y }))
+        {
+            return window->GetId();
+        }
+        return -1;
+    }
+
+    UNITY_INTERFACE_EXPORT int UNITY_INTERFACE_API UwcGetWindowIdUnderCursor()
+    {
+        if (WindowManager::IsNull()) return -1;
+        if (auto window = WindowManager::Get().GetCursorWindow())
+        {
+            return window->GetId();
+        }
+        return -1;
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcRequestCaptureCursor()
+    {
+        if (WindowManager::IsNull()) return;
+        if (auto& cursor = WindowManager::Get().GetCursor())
+        {
+            return cursor->RequestCapture();
+        }
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetCursorX()
+    {
+        if (WindowManager::IsNull()) return -1;
+        if (auto& cursor = WindowManager::Get().GetCursor())
+        {
+            return cursor->GetX();
+        }
+        return -1;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetCursorY()
+    {
+        if (WindowManager::IsNull()) return -1;
+        if (auto& cursor = WindowManager::Get().GetCursor())
+        {
+            return cursor->GetY();
+        }
+        return -1;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetCursorWidth()
+    {
+        if (WindowManager::IsNull()) return -1;
+        if (auto& cursor = WindowManager::Get().GetCursor())
+        {
+            return cursor->GetWidth();
+        }
+        return -1;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetCursorHeight()
+    {
+        if (WindowManager::IsNull()) return -1;
+        if (auto& cursor = WindowManager::Get().GetCursor())
+        {
+            return cursor->GetHeight();
+        }
+        return -1;
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetCursorTexturePtr(ID3D11Texture2D* ptr)
+    {
+        if (WindowManager::IsNull()) return;
+        if (auto& cursor = WindowManager::Get().GetCursor())
+        {
+            cursor->SetUnityTexturePtr(ptr);
+        }
+        return;
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetScreenX()
+    {
+        return ::GetSystemMetrics(SM_XVIRTUALSCREEN);
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetScreenY()
+    {
+        return ::GetSystemMetrics(SM_YVIRTUALSCREEN);
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetScreenWidth()
+    {
+        return ::GetSystemMetrics(SM_CXVIRTUALSCREEN);
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetScreenHeight()
+    {
+        return ::GetSystemMetrics(SM_CYVIRTUALSCREEN);
+    }
+
+    UNITY_INTERFACE_EXPORT UINT UNITY_INTERFACE_API UwcGetSharedTextureCreationCountPerSecond()
+    {
+        if (WindowManager::IsNull()) return 0;
+        if (auto& uploader = WindowManager::GetUploadManager())
+        {
+            return uploader->GetSharedTextureCreationCountPerSecond();
+        }
+        return 0;
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowsGraphicsCaptureSupported()
+    {
+        return WindowsGraphicsCapture::IsSupported();
+    }
+
+    UNITY_INTERFACE_EXPORT bool UNITY_INTERFACE_API UwcIsWindowsGraphicsCaptureCursorCaptureEnabledApiSupported()
+    {
+        return WindowsGraphicsCapture::IsCursorCaptureEnabledApiSupported();
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetWindowsGraphicsCaptureSessionTimeouts(int idleTimeout, int warmTimeout, int frameTimeout, int minRestartInterval)
+    {
+        if (WindowManager::IsNull()) return;
+        if (auto& manager = WindowManager::Get().GetWindowsGraphicsCaptureManager())
+        {
+            // Milliseconds to microseconds.
+            CaptureSessionTimeouts timeouts;
+            timeouts.idleTimeout = static_cast<int64_t>(idleTimeout) * 1000;
+            timeouts.warmTimeout = static_cast<int64_t>(warmTimeout) * 1000;
+            timeouts.frameTimeout = static_cast<int64_t>(frameTimeout) * 1000;
+            timeouts.minRestartInterval = static_cast<int64_t>(minRestartInterval) * 1000;
+            manager->SetSessionTimeouts(timeouts);
+        }
+    }
+
+    UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UwcSetWindowsGraphicsCaptureWarmSessionCount(int count)
+    {
+        if (WindowManager::IsNull()) return;
+        if (auto& manager = WindowManager::Get().GetWindowsGraphicsCaptureManager())
+        {
+            manager->SetWarmSessionCapacity(count);
+        }
+    }
 }
\ No newline at end of file
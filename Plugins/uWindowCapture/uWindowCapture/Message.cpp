@@ -1,62 +1,463 @@
-#include <set>
-#include "Message.h"
-
-
-
-UWC_SINGLETON_INSTANCE(MessageManager)
-
-
-UINT MessageManager::GetCount() const
-{
-    std::lock_guard<std::mutex> lock(mutex_);
-    return static_cast<UINT>(messages_.size());
-}
-
-
-const Message* MessageManager::GetHeadPointer() const
-{
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (messages_.empty()) return nullptr;
-    return &messages_[0];
-}
-
-
-void MessageManager::Add(Message message)
-{
-    std::lock_guard<std::mutex> lock(mutex_);
-    messages_.push_back(message);
-}
-
-
-void MessageManager::ClearAll()
-{
-    std::lock_guard<std::mutex> lock(mutex_);
-    messages_.clear();
-}
-
-
-void MessageManager::ExcludeRemovedWindowEvents()
-{
-    std::lock_guard<std::mutex> lock(mutex_);
-
-    std::set<int> removedWinedowIds; 
-    for (const auto& message : messages_)
-    {
-        if (message.type == MessageType::WindowRemoved)
-        {
-            removedWinedowIds.insert(message.windowId);
-        }
-    }
-
-    for (auto it = messages_.begin(); it != messages_.end();)
-    {
-        const auto& message = *it;
-        if (removedWinedowIds.find(message.windowId) != removedWinedowIds.end() && 
-            message.type != MessageType::WindowRemoved)
-        {
-            it = messages_.erase(it);
-            continue;
-        }
-        ++it;
-    }
-}
+#include <algorithm>
+#include <unordered_set>
+#include "Message.h"
+
+
+
+UWC_SINGLETON_INSTANCE(MessageManager)
+
+
+namespace
+{
+    // Callbacks being called on this thread, so that a callback replacing itself does not wait for itself.
+    thread_local std::vector<const void*> t_callingCallbacks;
+}
+
+
+UINT MessageManager::GetCoalescingFlag(MessageType type)
+{
+    switch (type)
+    {
+        case MessageType::WindowCaptured    : return 1 << 0;
+        case MessageType::WindowSizeChanged : return 1 << 1;
+        case MessageType::IconCaptured      : return 1 << 2;
+        case MessageType::CursorCaptured    : return 1 << 3;
+        case MessageType::TextureNullError  : return 1 << 4;
+        case MessageType::TextureSizeError  : return 1 << 5;
+        case MessageType::WindowTitleChanged: return 1 << 6;
+        case MessageType::WindowMoved       : return 1 << 7;
+        case MessageType::WindowResized     : return 1 << 8;
+        case MessageType::WindowZOrderChanged: return 1 << 9;
+        default                             : return 0;
+    }
+}
+
+
+int MessageManager::GetTypeIndex(MessageType type)
+{
+    switch (type)
+    {
+        case MessageType::WindowAdded       : return 0;
+        case MessageType::WindowRemoved     : return 1;
+        case MessageType::WindowCaptured    : return 2;
+        case MessageType::WindowSizeChanged : return 3;
+        case MessageType::IconCaptured      : return 4;
+        case MessageType::CursorCaptured    : return 5;
+        case MessageType::Error             : return 6;
+        case MessageType::TextureNullError  : return 7;
+        case MessageType::TextureSizeError  : return 8;
+        case MessageType::WindowTitleChanged: return 9;
+        case MessageType::WindowMoved       : return 10;
+        case MessageType::WindowResized     : return 11;
+        case MessageType::WindowZOrderChanged: return 12;
+        default                             : return -1;
+    }
+}
+
+
+std::atomic<UINT>* MessageManager::GetWindowFlags(int windowId)
+{
+    if (windowId < 0) return &cursorFlags_;
+
+    const auto index = static_cast<size_t>(windowId);
+
+    auto& tableSlot = windowFlagsTables_[index / (kWindowFlagsChunkSize * kWindowFlagsTableSize)];
+    auto table = tableSlot.load(std::memory_order_acquire);
+    if (!table)
+    {
+        std::lock_guard<std::mutex> lock(windowFlagsChunkMutex_);
+
+        table = tableSlot.load(std::memory_order_relaxed);
+        if (!table)
+        {
+            table = windowFlagsTableStorage_.emplace_back(std::make_unique<WindowFlagsTable>()).get();
+            tableSlot.store(table, std::memory_order_release);
+        }
+    }
+
+    auto& chunkSlot = table->chunks[index / kWindowFlagsChunkSize % kWindowFlagsTableSize];
+    auto chunk = chunkSlot.load(std::memory_order_acquire);
+    if (!chunk)
+    {
+        std::lock_guard<std::mutex> lock(windowFlagsChunkMutex_);
+
+        chunk = chunkSlot.load(std::memory_order_relaxed);
+        if (!chunk)
+        {
+            chunk = windowFlagsChunkStorage_.emplace_back(std::make_unique<std::atomic<UINT>[]>(kWindowFlagsChunkSize)).get();
+            chunkSlot.store(chunk, std::memory_order_release);
+        }
+    }
+
+    return &chunk[index % kWindowFlagsChunkSize];
+}
+
+
+bool MessageManager::IsDeliverable(const Message& message)
+{
+    if (!IsTypeSubscribed(message.type)) return false;
+
+    if (message.windowId < 0 ||
+        message.type == MessageType::WindowAdded ||
+        message.type == MessageType::WindowRemoved)
+    {
+        return true;
+    }
+
+    UINT requiredFlag = 0;
+    switch (windowFilter_.load(std::memory_order_relaxed))
+    {
+        case MessageWindowFilter::Subscribed   : requiredFlag = kSubscribedWindowFlag; break;
+        case MessageWindowFilter::TextureBound : requiredFlag = kTextureBoundWindowFlag; break;
+        default                                : return true;
+    }
+
+    const auto flags = GetWindowFlags(message.windowId);
+    return flags && (flags->load(std::memory_order_relaxed) & requiredFlag);
+}
+
+
+void MessageManager::CountDelivered(const Message& message, int delta)
+{
+    const int index = GetTypeIndex(message.type);
+    if (index < 0) return;
+
+    deliveredCounts_[index].fetch_add(static_cast<UINT64>(delta), std::memory_order_relaxed);
+}
+
+
+void MessageManager::Add(Message message)
+{
+    const int index = GetTypeIndex(message.type);
+    if (index >= 0)
+    {
+        producedCounts_[index].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (!IsDeliverable(message)) return;
+
+    if (index >= 0 && (callbackTypes_.load(std::memory_order_acquire) & (1u << index)))
+    {
+        InvokeCallback(index, message);
+    }
+
+    if (const auto flag = GetCoalescingFlag(message.type))
+    {
+        if (auto flags = GetWindowFlags(message.windowId))
+        {
+            if (flags->fetch_or(flag) & flag) return;
+        }
+    }
+
+    ring_.Push(message);
+}
+
+
+void MessageManager::Collect()
+{
+    const auto head = batch_.size();
+
+    ring_.PopAll(batch_);
+
+    // Collected messages are no longer pending, so the same events can be queued again.
+    for (size_t i = head; i < batch_.size(); ++i)
+    {
+        const auto& collected = batch_[i];
+        CountDelivered(collected, 1);
+        if (const auto flag = GetCoalescingFlag(collected.type))
+        {
+            if (auto flags = GetWindowFlags(collected.windowId))
+            {
+                flags->fetch_and(~flag);
+            }
+        }
+    }
+}
+
+
+const Message* MessageManager::Swap(UINT* outCount)
+{
+    batch_.clear();
+    ExcludeRemovedWindowEvents();
+
+    if (outCount)
+    {
+        *outCount = static_cast<UINT>(batch_.size());
+    }
+
+    return GetHeadPointer();
+}
+
+
+UINT MessageManager::GetCount()
+{
+    Collect();
+    return static_cast<UINT>(batch_.size());
+}
+
+
+const Message* MessageManager::GetHeadPointer() const
+{
+    if (batch_.empty()) return nullptr;
+    return batch_.data();
+}
+
+
+void MessageManager::ClearAll()
+{
+    batch_.clear();
+}
+
+
+void MessageManager::ExcludeRemovedWindowEvents()
+{
+    Collect();
+
+    std::unordered_set<int> removedWindowIds;
+    for (const auto& message : batch_)
+    {
+        if (message.type == MessageType::WindowRemoved)
+        {
+            removedWindowIds.insert(message.windowId);
+        }
+    }
+
+    if (removedWindowIds.empty()) return;
+
+    const auto it = std::remove_if(batch_.begin(), batch_.end(), [&](const Message& message)
+    {
+        const bool isExcluded =
+            message.type != MessageType::WindowRemoved &&
+            removedWindowIds.find(message.windowId) != removedWindowIds.end();
+        if (isExcluded)
+        {
+            CountDelivered(message, -1);
+        }
+        return isExcluded;
+    });
+    batch_.erase(it, batch_.end());
+}
+
+
+void MessageManager::SubscribeType(MessageType type, bool subscribe)
+{
+    const int index = GetTypeIndex(type);
+    if (index < 0) return;
+
+    if (subscribe)
+    {
+        subscribedTypes_.fetch_or(1u << index);
+    }
+    else
+    {
+        subscribedTypes_.fetch_and(~(1u << index));
+    }
+}
+
+
+bool MessageManager::IsTypeSubscribed(MessageType type) const
+{
+    const int index = GetTypeIndex(type);
+    if (index < 0) return true;
+
+    return (subscribedTypes_.load(std::memory_order_relaxed) & (1u << index)) != 0;
+}
+
+
+void MessageManager::SetWindowFilter(MessageWindowFilter filter)
+{
+    windowFilter_ = filter;
+}
+
+
+MessageWindowFilter MessageManager::GetWindowFilter() const
+{
+    return windowFilter_;
+}
+
+
+void MessageManager::SubscribeWindow(int windowId, bool subscribe)
+{
+    if (windowId < 0) return;
+
+    if (auto flags = GetWindowFlags(windowId))
+    {
+        if (subscribe)
+        {
+            flags->fetch_or(kSubscribedWindowFlag);
+        }
+        else
+        {
+            flags->fetch_and(~kSubscribedWindowFlag);
+        }
+    }
+}
+
+
+void MessageManager::SetWindowTextureBound(int windowId, bool bound)
+{
+    if (windowId < 0) return;
+
+    if (auto flags = GetWindowFlags(windowId))
+    {
+        if (bound)
+        {
+            flags->fetch_or(kTextureBoundWindowFlag);
+        }
+        else
+        {
+            flags->fetch_and(~kTextureBoundWindowFlag);
+        }
+    }
+}
+
+
+UINT64 MessageManager::GetProducedCount(MessageType type) const
+{
+    const int index = GetTypeIndex(type);
+    if (index < 0) return 0;
+
+    return producedCounts_[index].load(std::memory_order_relaxed);
+}
+
+
+UINT64 MessageManager::GetDeliveredCount(MessageType type) const
+{
+    const int index = GetTypeIndex(type);
+    if (index < 0) return 0;
+
+    return deliveredCounts_[index].load(std::memory_order_relaxed);
+}
+
+
+void MessageManager::SetCallback(MessageType type, MessageCallbackFuncPtr func, void* userData, MessageCallbackMode mode)
+{
+    const int index = GetTypeIndex(type);
+    if (index < 0) return;
+
+    std::shared_ptr<Callback> callback;
+    if (func)
+    {
+        callback = std::make_shared<Callback>();
+        callback->func = func;
+        callback->userData = userData;
+        callback->mode = mode;
+    }
+    const auto previous = std::atomic_exchange(&callbacks_[index], std::shared_ptr<const Callback>(callback));
+
+    if (callback)
+    {
+        callbackTypes_.fetch_or(1u << index);
+    }
+    else
+    {
+        callbackTypes_.fetch_and(~(1u << index));
+    }
+
+    if (callback && mode == MessageCallbackMode::Dispatched)
+    {
+        // Concurrent SetCallback() calls must not start the loop twice.
+        std::call_once(dispatcherStartFlag_, [this]
+        {
+            dispatcherThreadLoop_.Start([this]
+            {
+                DispatchCallbacks();
+            }, std::chrono::microseconds(1000));
+        });
+    }
+
+    if (previous)
+    {
+        WaitForInvocations(*previous);
+    }
+}
+
+
+void MessageManager::InvokeCallback(int typeIndex, const Message& message)
+{
+    const auto callback = AcquireCallback(typeIndex);
+    if (!callback) return;
+
+    if (callback->mode == MessageCallbackMode::Immediate)
+    {
+        CallAndRelease(*callback, &message, 1);
+        return;
+    }
+
+    callback->invocationCount.fetch_sub(1);
+
+    std::lock_guard<std::mutex> lock(dispatchMutex_);
+    dispatchQueues_[typeIndex].push_back(message);
+}
+
+
+// Returns the current callback with its invocation counted, which CallAndRelease() or the caller ends.
+std::shared_ptr<const MessageManager::Callback> MessageManager::AcquireCallback(int typeIndex)
+{
+    for (;;)
+    {
+        const auto callback = std::atomic_load(&callbacks_[typeIndex]);
+        if (!callback) return nullptr;
+
+        // SetCallback() replaces the callback before it reads the count, so either
+        // it waits for this invocation or the reload below sees the replacement.
+        callback->invocationCount.fetch_add(1);
+        if (std::atomic_load(&callbacks_[typeIndex]) == callback) return callback;
+
+        callback->invocationCount.fetch_sub(1);
+    }
+}
+
+
+void MessageManager::CallAndRelease(const Callback& callback, const Message* messages, UINT count)
+{
+    t_callingCallbacks.push_back(&callback);
+    callback.func(messages, count, callback.userData);
+    t_callingCallbacks.pop_back();
+
+    callback.invocationCount.fetch_sub(1);
+}
+
+
+void MessageManager::WaitForInvocations(const Callback& callback)
+{
+    const auto ownCount = static_cast<UINT>(std::count(t_callingCallbacks.begin(), t_callingCallbacks.end(), &callback));
+    while (callback.invocationCount.load() > ownCount)
+    {
+        std::this_thread::yield();
+    }
+}
+
+
+void MessageManager::DispatchCallbacks()
+{
+    // Run this scope in the dispatcher thread.
+
+    {
+        std::lock_guard<std::mutex> lock(dispatchMutex_);
+        for (size_t i = 0; i < kTypeCount; ++i)
+        {
+            dispatchBatches_[i].swap(dispatchQueues_[i]);
+        }
+    }
+
+    for (size_t i = 0; i < kTypeCount; ++i)
+    {
+        auto& batch = dispatchBatches_[i];
+        if (batch.empty()) continue;
+
+        if (const auto callback = AcquireCallback(static_cast<int>(i)))
+        {
+            if (callback->mode == MessageCallbackMode::Dispatched)
+            {
+                CallAndRelease(*callback, batch.data(), static_cast<UINT>(batch.size()));
+            }
+            else
+            {
+                callback->invocationCount.fetch_sub(1);
+            }
+        }
+
+        batch.clear();
+    }
+}
\ No newline at end of file
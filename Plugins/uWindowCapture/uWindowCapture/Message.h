@@ -1,50 +1,166 @@
-#pragma once
-
-#include <Windows.h>
-#include <vector>
-#include <mutex>
-
-#include "Singleton.h"
-
-
-
-enum class MessageType : int
-{
-    None = -1,
-    WindowAdded = 0,
-    WindowRemoved = 1,
-    WindowCaptured = 2,
-    WindowSizeChanged = 3,
-    IconCaptured = 4,
-    CursorCaptured = 5,
-    Error = 1000,
-    TextureNullError = 1001,
-    TextureSizeError = 1002,
-};
-
-
-struct Message
-{
-    MessageType type = MessageType::None;
-    int windowId = -1;
-    void* userData = nullptr;
-    Message(MessageType type, int id, void* userData)
-        : type(type), windowId(id), userData(userData) {}
-};
-
-
-class MessageManager
-{
-    UWC_SINGLETON(MessageManager)
-
-public:
-    void Add(Message message);
-    void ClearAll();
-    void ExcludeRemovedWindowEvents();
-    UINT GetCount() const;
-    const Message* GetHeadPointer() const;
-
-private:
-    std::vector<Message> messages_;
-    mutable std::mutex mutex_;
+#pragma once
+
+#include <Windows.h>
+#include <climits>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+
+#include "IUnityInterface.h"
+#include "Singleton.h"
+#include "Thread.h"
+#include "MessageRing.h"
+
+
+
+enum class MessageType : int
+{
+    None = -1,
+    WindowAdded = 0,
+    WindowRemoved = 1,
+    WindowCaptured = 2,
+    WindowSizeChanged = 3,
+    IconCaptured = 4,
+    CursorCaptured = 5,
+    WindowTitleChanged = 6,
+    WindowMoved = 7,
+    WindowResized = 8,
+    WindowZOrderChanged = 9,
+    Error = 1000,
+    TextureNullError = 1001,
+    TextureSizeError = 1002,
+};
+
+
+enum class MessageWindowFilter : int
+{
+    // Deliver messages of every window.
+    All = 0,
+    // Deliver messages only of windows subscribed by SubscribeWindow().
+    Subscribed = 1,
+    // Deliver messages only of windows whose window or icon texture is set from Unity.
+    TextureBound = 2,
+};
+
+
+struct Message
+{
+    MessageType type = MessageType::None;
+    int windowId = -1;
+    void* userData = nullptr;
+    Message() = default;
+    Message(MessageType type, int id, void* userData)
+        : type(type), windowId(id), userData(userData) {}
+};
+
+
+using MessageCallbackFuncPtr = void(UNITY_INTERFACE_API *)(const Message* messages, UINT count, void* userData);
+
+
+enum class MessageCallbackMode : int
+{
+    // Called on the thread that produced the message with one message per call.
+    Immediate = 0,
+    // Called on the dispatcher thread with the messages produced since the last call.
+    Dispatched = 1,
+};
+
+
+// Producers on any thread push messages into a lock-free bounded ring.
+// The consumer (the thread calling Swap() or the legacy getters) moves them
+// into a batch that stays valid until the next Swap() or ClearAll().
+class MessageManager
+{
+    UWC_SINGLETON(MessageManager)
+
+public:
+    void Add(Message message);
+    const Message* Swap(UINT* outCount);
+    void ClearAll();
+    void ExcludeRemovedWindowEvents();
+    UINT GetCount();
+    const Message* GetHeadPointer() const;
+
+    // Subscriptions are checked on the producing thread, so filtered messages never enter the queue.
+    // WindowAdded / WindowRemoved and cursor messages are filtered only by type.
+    void SubscribeType(MessageType type, bool subscribe);
+    bool IsTypeSubscribed(MessageType type) const;
+    void SetWindowFilter(MessageWindowFilter filter);
+    MessageWindowFilter GetWindowFilter() const;
+    void SubscribeWindow(int windowId, bool subscribe);
+    void SetWindowTextureBound(int windowId, bool bound);
+
+    UINT64 GetProducedCount(MessageType type) const;
+    UINT64 GetDeliveredCount(MessageType type) const;
+
+    // Callbacks receive subscribed messages before they are coalesced, in addition to the queue.
+    // Passing nullptr as func unregisters the callback of the type. Returns after the replaced
+    // callback has returned on other threads so that its userData can be released; a callback
+    // may replace itself, in which case only its own invocation is still running.
+    void SetCallback(MessageType type, MessageCallbackFuncPtr func, void* userData, MessageCallbackMode mode);
+
+private:
+    static constexpr size_t kRingSize = 4096;
+    static constexpr size_t kTypeCount = 13;
+    static constexpr UINT kSubscribedWindowFlag = 1u << 30;
+    static constexpr UINT kTextureBoundWindowFlag = 1u << 31;
+
+    struct Callback
+    {
+        MessageCallbackFuncPtr func = nullptr;
+        void* userData = nullptr;
+        MessageCallbackMode mode = MessageCallbackMode::Immediate;
+        mutable std::atomic<UINT> invocationCount = 0;
+    };
+
+    void Collect();
+    bool IsDeliverable(const Message& message);
+    void CountDelivered(const Message& message, int delta);
+    void InvokeCallback(int typeIndex, const Message& message);
+    std::shared_ptr<const Callback> AcquireCallback(int typeIndex);
+    static void CallAndRelease(const Callback& callback, const Message* messages, UINT count);
+    static void WaitForInvocations(const Callback& callback);
+    void DispatchCallbacks();
+    std::atomic<UINT>* GetWindowFlags(int windowId);
+    static UINT GetCoalescingFlag(MessageType type);
+    static int GetTypeIndex(MessageType type);
+
+    MessageRing<Message> ring_ { kRingSize };
+
+    std::vector<Message> batch_;
+
+    // Per-window flags: the lower bits are message types waiting in the ring
+    // or the overflow buffer (a message whose type is already pending for the
+    // same window is dropped at insert time), the upper bits are subscription
+    // states. Window ids are never reused, so flags are kept in lazily
+    // allocated chunks indexed by id through a two-level table which covers
+    // every non-negative id. Allocations are kept until destruction.
+    static constexpr size_t kWindowFlagsChunkSize = 1024;
+    static constexpr size_t kWindowFlagsTableSize = 1024;
+    static constexpr size_t kWindowFlagsTableCount = (static_cast<size_t>(INT_MAX) / (kWindowFlagsChunkSize * kWindowFlagsTableSize)) + 1;
+    struct WindowFlagsTable
+    {
+        std::atomic<std::atomic<UINT>*> chunks[kWindowFlagsTableSize] = {};
+    };
+    std::atomic<WindowFlagsTable*> windowFlagsTables_[kWindowFlagsTableCount] = {};
+    std::vector<std::unique_ptr<WindowFlagsTable>> windowFlagsTableStorage_;
+    std::vector<std::unique_ptr<std::atomic<UINT>[]>> windowFlagsChunkStorage_;
+    std::atomic<UINT> cursorFlags_ = 0;
+    std::mutex windowFlagsChunkMutex_;
+
+    std::atomic<UINT> subscribedTypes_ = ~0u;
+    std::atomic<MessageWindowFilter> windowFilter_ = MessageWindowFilter::All;
+
+    std::atomic<UINT64> producedCounts_[kTypeCount] = {};
+    std::atomic<UINT64> deliveredCounts_[kTypeCount] = {};
+
+    // Read with std::atomic_load() on producer threads.
+    std::shared_ptr<const Callback> callbacks_[kTypeCount];
+    std::atomic<UINT> callbackTypes_ = 0;
+    std::vector<Message> dispatchQueues_[kTypeCount];
+    std::vector<Message> dispatchBatches_[kTypeCount];
+    std::mutex dispatchMutex_;
+    std::once_flag dispatcherStartFlag_;
+    ThreadLoop dispatcherThreadLoop_ = { L"uWindowCapture - Message Dispatcher Thread" };
 };
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+// Lock-free bounded ring for producers on any thread and a single consumer.
+// When the ring is full, items go to an overflow buffer until the consumer
+// drains it, so that no item is dropped and the order is kept.
+template <class T>
+class MessageRing
+{
+public:
+    // The size must be a power of two.
+    explicit MessageRing(size_t size)
+        : size_(size)
+        , slots_(std::make_unique<Slot[]>(size))
+    {
+        for (size_t i = 0; i < size_; ++i)
+        {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    void Push(const T& item)
+    {
+        // Once the ring has overflowed, keep appending to the overflow buffer
+        // until the consumer drains it so that items stay in order.
+        if (!hasOverflowed_.load(std::memory_order_acquire) && TryPush(item)) return;
+
+        std::lock_guard<std::mutex> lock(overflowMutex_);
+        overflow_.push_back(item);
+        hasOverflowed_ = true;
+    }
+
+    // Run this function only in the consumer thread.
+    void PopAll(std::vector<T>& outItems)
+    {
+        T item;
+        while (TryPop(item))
+        {
+            outItems.push_back(item);
+        }
+
+        if (!hasOverflowed_) return;
+
+        std::lock_guard<std::mutex> lock(overflowMutex_);
+
+        // Producers may have pushed into the ring before they saw the flag.
+        while (TryPop(item))
+        {
+            outItems.push_back(item);
+        }
+
+        outItems.insert(outItems.end(), overflow_.begin(), overflow_.end());
+        overflow_.clear();
+        hasOverflowed_ = false;
+    }
+
+    bool HasOverflowed() const
+    {
+        return hasOverflowed_;
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence = 0;
+        T item;
+    };
+
+    bool TryPush(const T& item)
+    {
+        const size_t mask = size_ - 1;
+
+        auto pos = enqueuePos_.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+
+        for (;;)
+        {
+            slot = &slots_[pos & mask];
+            const auto sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->item = item;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    bool TryPop(T& outItem)
+    {
+        const size_t mask = size_ - 1;
+
+        auto& slot = slots_[dequeuePos_ & mask];
+        const auto sequence = slot.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeuePos_ + 1) < 0)
+        {
+            return false;
+        }
+
+        outItem = slot.item;
+        slot.sequence.store(dequeuePos_ + size_, std::memory_order_release);
+        ++dequeuePos_;
+
+        return true;
+    }
+
+    const size_t size_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<size_t> enqueuePos_ = 0;
+    size_t dequeuePos_ = 0;
+
+    // Used only when the ring is full so that no item is dropped.
+    std::vector<T> overflow_;
+    std::atomic<bool> hasOverflowed_ = false;
+    std::mutex overflowMutex_;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+
+
+// Requests posted from any thread and taken as a batch by a polling thread.
+// Taking from an empty queue is a single atomic exchange without a lock,
+// so the consumer can poll it on every loop iteration.
+template <class T>
+class RequestQueue
+{
+public:
+    void Post(const T& request)
+    {
+        std::scoped_lock lock(mutex_);
+        requests_.push_back(request);
+        hasRequests_ = true;
+    }
+
+    // Moves the pending requests to outRequests and returns false when there were none.
+    bool TakeAll(std::vector<T>& outRequests)
+    {
+        if (!hasRequests_.exchange(false)) return false;
+
+        std::scoped_lock lock(mutex_);
+        outRequests.swap(requests_);
+        requests_.clear();
+        return !outRequests.empty();
+    }
+
+private:
+    std::vector<T> requests_;
+    std::atomic<bool> hasRequests_ = { false };
+    std::mutex mutex_;
+};
@@ -0,0 +1,45 @@
+#include "SharedTextureCache.h"
+
+
+
+SharedTextureCache::SharedTextureCache(std::shared_ptr<ISharedTextureDevice> device)
+    : device_(std::move(device))
+{
+}
+
+
+SharedTextureCache::~SharedTextureCache()
+{
+    Reset();
+}
+
+
+ID3D11Texture2D* SharedTextureCache::Open(HANDLE sharedHandle)
+{
+    if (!sharedHandle || !device_) return nullptr;
+
+    if (texture_ && sharedHandle_ == sharedHandle)
+    {
+        return texture_;
+    }
+
+    Reset();
+
+    texture_ = device_->OpenSharedTexture(sharedHandle);
+    if (!texture_) return nullptr;
+
+    sharedHandle_ = sharedHandle;
+
+    return texture_;
+}
+
+
+void SharedTextureCache::Reset()
+{
+    if (texture_)
+    {
+        device_->ReleaseSharedTexture(texture_);
+        texture_ = nullptr;
+    }
+    sharedHandle_ = nullptr;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Windows.h>
+#include <memory>
+
+
+struct ID3D11Texture2D;
+
+
+// Opens textures from shared handles on the device which renders them.
+// The Unity device implements this and tests replace it with a fake.
+class ISharedTextureDevice
+{
+public:
+    virtual ~ISharedTextureDevice() = default;
+
+    // Returns a texture with a reference owned by the caller or nullptr on failure.
+    virtual ID3D11Texture2D* OpenSharedTexture(HANDLE sharedHandle) = 0;
+    virtual void ReleaseSharedTexture(ID3D11Texture2D* texture) = 0;
+};
+
+
+// Keeps the texture opened from a shared handle on the device so that
+// OpenSharedTexture() runs only when the handle changes (i.e. on resize).
+class SharedTextureCache
+{
+public:
+    explicit SharedTextureCache(std::shared_ptr<ISharedTextureDevice> device);
+    ~SharedTextureCache();
+    SharedTextureCache(const SharedTextureCache&) = delete;
+    SharedTextureCache& operator=(const SharedTextureCache&) = delete;
+
+    ID3D11Texture2D* Open(HANDLE sharedHandle);
+    void Reset();
+
+private:
+    const std::shared_ptr<ISharedTextureDevice> device_;
+    HANDLE sharedHandle_ = nullptr;
+    ID3D11Texture2D* texture_ = nullptr;
+};
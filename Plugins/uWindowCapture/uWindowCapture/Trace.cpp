@@ -0,0 +1,255 @@
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include "Trace.h"
+#include "Util.h"
+
+
+
+decltype(Trace::mode_)                   Trace::mode_ = TraceMode::Off;
+decltype(Trace::flightRecorderDuration_) Trace::flightRecorderDuration_ = 10'000'000;
+
+
+namespace
+{
+    constexpr size_t kBufferCapacity = 8192;
+
+
+    struct TraceEvent
+    {
+        std::atomic<const char*> name = { nullptr };
+        std::atomic<INT64> start = { 0 };
+        std::atomic<INT64> duration = { 0 };
+    };
+
+
+    // Written only by its owner thread and read by the exporting thread.
+    class TraceBuffer
+    {
+    public:
+        TraceBuffer()
+            : threadId_(::GetCurrentThreadId())
+            , threadName_(GetCurrentThreadName())
+        {
+        }
+
+        void Record(const char* name, INT64 start, INT64 end, bool overwrite)
+        {
+            const auto count = count_.load(std::memory_order_relaxed);
+            if (!overwrite && count - clearedCount_.load(std::memory_order_relaxed) >= kBufferCapacity)
+            {
+                ++droppedCount_;
+                return;
+            }
+
+            auto& event = events_[count % kBufferCapacity];
+            event.name.store(name, std::memory_order_relaxed);
+            event.start.store(start, std::memory_order_relaxed);
+            event.duration.store(end - start, std::memory_order_relaxed);
+            count_.store(count + 1, std::memory_order_release);
+        }
+
+        template <class Func>
+        void ForEach(const Func& func) const
+        {
+            const auto count = count_.load(std::memory_order_acquire);
+            const auto cleared = clearedCount_.load();
+            const auto first = (std::max)(cleared, count > kBufferCapacity ? count - kBufferCapacity : 0);
+
+            for (auto i = first; i < count; ++i)
+            {
+                const auto& event = events_[i % kBufferCapacity];
+                const auto name = event.name.load(std::memory_order_relaxed);
+                const auto start = event.start.load(std::memory_order_relaxed);
+                const auto duration = event.duration.load(std::memory_order_relaxed);
+
+                // Skip slots which the owner may have overwritten while being read.
+                const auto latestCount = count_.load(std::memory_order_acquire);
+                if (latestCount > kBufferCapacity && i < latestCount - kBufferCapacity) continue;
+
+                func(name, start, duration);
+            }
+        }
+
+        void Clear()
+        {
+            clearedCount_ = count_.load();
+            droppedCount_ = 0;
+        }
+
+        DWORD GetThreadId() const { return threadId_; }
+        const std::string& GetThreadName() const { return threadName_; }
+        UINT64 GetDroppedCount() const { return droppedCount_; }
+
+        std::atomic<bool> isOwnerAlive = { true };
+
+    private:
+        static std::string GetCurrentThreadName()
+        {
+            std::string name;
+
+            PWSTR desc = nullptr;
+            if (SUCCEEDED(::GetThreadDescription(::GetCurrentThread(), &desc)) && desc)
+            {
+                const auto size = ::WideCharToMultiByte(CP_UTF8, 0, desc, -1, nullptr, 0, nullptr, nullptr);
+                if (size > 1)
+                {
+                    name.resize(size - 1);
+                    ::WideCharToMultiByte(CP_UTF8, 0, desc, -1, name.data(), size, nullptr, nullptr);
+                }
+                ::LocalFree(desc);
+            }
+
+            return name;
+        }
+
+        const DWORD threadId_;
+        const std::string threadName_;
+        std::unique_ptr<TraceEvent[]> events_ = std::make_unique<TraceEvent[]>(kBufferCapacity);
+        std::atomic<UINT64> count_ = { 0 };
+        std::atomic<UINT64> clearedCount_ = { 0 };
+        std::atomic<UINT64> droppedCount_ = { 0 };
+    };
+
+
+    struct TraceBufferHolder
+    {
+        ~TraceBufferHolder()
+        {
+            if (buffer) buffer->isOwnerAlive = false;
+        }
+
+        std::shared_ptr<TraceBuffer> buffer;
+    };
+
+
+    std::vector<std::shared_ptr<TraceBuffer>> g_buffers;
+    std::mutex g_buffersMutex;
+    thread_local TraceBufferHolder t_bufferHolder;
+
+
+    TraceBuffer& GetThreadBuffer()
+    {
+        if (!t_bufferHolder.buffer)
+        {
+            t_bufferHolder.buffer = std::make_shared<TraceBuffer>();
+            std::scoped_lock lock(g_buffersMutex);
+            g_buffers.push_back(t_bufferHolder.buffer);
+        }
+        return *t_bufferHolder.buffer;
+    }
+
+
+    void WriteEscapedString(std::ofstream& fs, const char* str)
+    {
+        fs << '"';
+        for (auto p = str; *p; ++p)
+        {
+            if (*p == '"' || *p == '\\') fs << '\\';
+            fs << *p;
+        }
+        fs << '"';
+    }
+}
+
+
+void Trace::SetMode(TraceMode mode)
+{
+    if (mode_ == mode) return;
+
+    // Start every recording from empty buffers but keep the events
+    // when turning it off so that they can still be exported.
+    if (mode != TraceMode::Off)
+    {
+        Clear();
+    }
+    mode_ = mode;
+}
+
+
+void Trace::Clear()
+{
+    std::scoped_lock lock(g_buffersMutex);
+
+    for (const auto& buffer : g_buffers)
+    {
+        buffer->Clear();
+    }
+
+    g_buffers.erase(
+        std::remove_if(
+            g_buffers.begin(),
+            g_buffers.end(),
+            [](const auto& buffer)
+            {
+                return !buffer->isOwnerAlive;
+            }),
+        g_buffers.end());
+}
+
+
+INT64 Trace::GetTimestamp()
+{
+    return GetTimestampInMicroseconds();
+}
+
+
+void Trace::Record(const char* name, INT64 start, INT64 end)
+{
+    const auto mode = mode_.load(std::memory_order_relaxed);
+    if (mode == TraceMode::Off) return;
+
+    GetThreadBuffer().Record(name, start, end, mode == TraceMode::FlightRecorder);
+}
+
+
+bool Trace::Export(const wchar_t* path)
+{
+    const std::filesystem::path filePath(path);
+    std::ofstream fs(filePath);
+    if (!fs.good()) return false;
+
+    const bool isFlightRecorder = mode_ == TraceMode::FlightRecorder;
+    const auto minStartTime = GetTimestamp() - flightRecorderDuration_;
+    const auto pid = ::GetCurrentProcessId();
+
+    fs << "{\"traceEvents\":[";
+    bool isFirst = true;
+    UINT64 droppedCount = 0;
+
+    std::scoped_lock lock(g_buffersMutex);
+
+    for (const auto& buffer : g_buffers)
+    {
+        const auto tid = buffer->GetThreadId();
+
+        if (!buffer->GetThreadName().empty())
+        {
+            fs << (isFirst ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << tid << ",\"args\":{\"name\":";
+            WriteEscapedString(fs, buffer->GetThreadName().c_str());
+            fs << "}}";
+            isFirst = false;
+        }
+
+        buffer->ForEach([&](const char* name, INT64 start, INT64 duration)
+        {
+            if (!name) return;
+            if (isFlightRecorder && start < minStartTime) return;
+
+            fs << (isFirst ? "" : ",") << "\n{\"name\":";
+            WriteEscapedString(fs, name);
+            fs << ",\"cat\":\"uwc\",\"ph\":\"X\",\"ts\":" << start << ",\"dur\":" << duration << ",\"pid\":" << pid << ",\"tid\":" << tid << "}";
+            isFirst = false;
+        });
+
+        droppedCount += buffer->GetDroppedCount();
+    }
+
+    fs << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEventCount\":" << droppedCount << "}}\n";
+
+    return fs.good();
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <Windows.h>
+
+
+enum class TraceMode
+{
+    Off = 0,
+    Recording = 1,
+    FlightRecorder = 2,
+};
+
+
+// Hot-path tracing recorded into per-thread buffers and exported as Chrome trace JSON.
+// Recording keeps events until a buffer is full, FlightRecorder keeps overwriting
+// the oldest ones and exports only the last N seconds.
+class Trace
+{
+public:
+    static void SetMode(TraceMode mode);
+    static TraceMode GetMode() { return mode_; }
+    static bool IsEnabled() { return mode_.load(std::memory_order_relaxed) != TraceMode::Off; }
+    static void SetFlightRecorderDuration(INT64 duration) { flightRecorderDuration_ = duration; } // [us]
+    static void Clear();
+    static bool Export(const wchar_t* path);
+
+    static INT64 GetTimestamp();
+    static void Record(const char* name, INT64 start, INT64 end);
+
+private:
+    static std::atomic<TraceMode> mode_;
+    static std::atomic<INT64> flightRecorderDuration_;
+};
+
+
+class TraceScope
+{
+public:
+    explicit TraceScope(const char* name)
+        : name_(Trace::IsEnabled() ? name : nullptr)
+        , start_(name_ ? Trace::GetTimestamp() : 0)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (name_)
+        {
+            Trace::Record(name_, start_, Trace::GetTimestamp());
+        }
+    }
+
+private:
+    const char* const name_;
+    const INT64 start_;
+};
+
+
+// Define UWC_TRACE_OFF to compile all the trace scopes out.
+#ifndef UWC_TRACE_OFF
+#define UWC_TRACE_CONCAT_IMPL(A, B) A##B
+#define UWC_TRACE_CONCAT(A, B) UWC_TRACE_CONCAT_IMPL(A, B)
+#define UWC_TRACE_SCOPE(Name) \
+    TraceScope UWC_TRACE_CONCAT(_traceScope_, __COUNTER__)(Name);
+#else
+#define UWC_TRACE_SCOPE(Name)
+#endif
@@ -1,22 +1,56 @@
-#pragma once
-
-#include <d3d11.h>
-
-#include "IUnityInterface.h"
-#include "IUnityGraphicsD3D11.h"
-
-
-
-extern IUnityInterfaces* g_unity;
-
-
-IUnityInterfaces* GetUnity()
-{
-    return g_unity;
-}
-
-
-ID3D11Device* GetUnityDevice()
-{
-    return GetUnity()->Get<IUnityGraphicsD3D11>()->GetDevice();
-}
\ No newline at end of file
+#pragma once
+
+#include <d3d11.h>
+
+#include "IUnityInterface.h"
+#include "IUnityGraphicsD3D11.h"
+#include "Unity.h"
+#include "SharedTextureCache.h"
+#include "Debug.h"
+
+
+
+extern IUnityInterfaces* g_unity;
+
+
+IUnityInterfaces* GetUnity()
+{
+    return g_unity;
+}
+
+
+ID3D11Device* GetUnityDevice()
+{
+    return GetUnity()->Get<IUnityGraphicsD3D11>()->GetDevice();
+}
+
+
+namespace
+{
+    class UnitySharedTextureDevice : public ISharedTextureDevice
+    {
+    public:
+        ID3D11Texture2D* OpenSharedTexture(HANDLE sharedHandle) override
+        {
+            ID3D11Texture2D* texture = nullptr;
+            if (FAILED(GetUnityDevice()->OpenSharedResource(sharedHandle, __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&texture))))
+            {
+                UWC_ERROR(__FUNCTION__, " => OpenSharedResource() failed.");
+                return nullptr;
+            }
+            return texture;
+        }
+
+        void ReleaseSharedTexture(ID3D11Texture2D* texture) override
+        {
+            texture->Release();
+        }
+    };
+}
+
+
+std::shared_ptr<ISharedTextureDevice> GetUnitySharedTextureDevice()
+{
+    static const auto device = std::make_shared<UnitySharedTextureDevice>();
+    return device;
+}
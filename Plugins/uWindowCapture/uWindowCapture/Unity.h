@@ -1,4 +1,9 @@
-#pragma once
-
-struct IUnityInterfaces* GetUnity();
-struct ID3D11Device* GetUnityDevice();
\ No newline at end of file
+#pragma once
+
+#include <memory>
+
+class ISharedTextureDevice;
+
+struct IUnityInterfaces* GetUnity();
+struct ID3D11Device* GetUnityDevice();
+std::shared_ptr<ISharedTextureDevice> GetUnitySharedTextureDevice();
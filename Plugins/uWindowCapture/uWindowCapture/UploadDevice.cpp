@@ -0,0 +1,104 @@
+#include <cstring>
+#include "UploadDevice.h"
+
+
+
+void CpuUploadDevice::AddTexture(ID3D11Texture2D* texture, UINT width, UINT height, UINT bytesPerPixel)
+{
+    auto& entry = textures_[texture];
+    entry.width = width;
+    entry.height = height;
+    entry.bytesPerPixel = bytesPerPixel;
+    entry.pixels.assign(static_cast<size_t>(width) * height * bytesPerPixel, 0);
+}
+
+
+void CpuUploadDevice::RemoveTexture(ID3D11Texture2D* texture)
+{
+    textures_.erase(texture);
+}
+
+
+const BYTE* CpuUploadDevice::GetPixels(ID3D11Texture2D* texture) const
+{
+    const auto it = textures_.find(texture);
+    if (it == textures_.end()) return nullptr;
+
+    return it->second.pixels.data();
+}
+
+
+CpuUploadDevice::Texture* CpuUploadDevice::Find(ID3D11Texture2D* texture)
+{
+    const auto it = textures_.find(texture);
+    if (it == textures_.end()) return nullptr;
+
+    return &it->second;
+}
+
+
+bool CpuUploadDevice::UpdateTexture(ID3D11Texture2D* texture, const void* data, UINT pitch)
+{
+    auto dst = Find(texture);
+    if (!dst || !data) return false;
+
+    const size_t rowSize = static_cast<size_t>(dst->width) * dst->bytesPerPixel;
+    if (pitch < rowSize) return false;
+
+    const auto src = static_cast<const BYTE*>(data);
+    if (pitch == rowSize)
+    {
+        memcpy(dst->pixels.data(), src, dst->pixels.size());
+        return true;
+    }
+
+    // The source rows may be a part of a larger buffer (e.g. a cropped window).
+    for (UINT y = 0; y < dst->height; ++y)
+    {
+        memcpy(dst->pixels.data() + y * rowSize, src + static_cast<size_t>(y) * pitch, rowSize);
+    }
+
+    return true;
+}
+
+
+bool CpuUploadDevice::CopyTexture(ID3D11Texture2D* dst, ID3D11Texture2D* src)
+{
+    auto dstTexture = Find(dst);
+    const auto srcTexture = Find(src);
+    if (!dstTexture || !srcTexture) return false;
+
+    // Same as CopyResource(), the textures must have the same layout.
+    if (dstTexture->width != srcTexture->width ||
+        dstTexture->height != srcTexture->height ||
+        dstTexture->bytesPerPixel != srcTexture->bytesPerPixel)
+    {
+        return false;
+    }
+
+    dstTexture->pixels = srcTexture->pixels;
+
+    return true;
+}
+
+
+bool CpuUploadDevice::CreateSharedTexture(ID3D11Texture2D* src, ID3D11Texture2D** outTexture, HANDLE* outSharedHandle)
+{
+    const auto srcTexture = Find(src);
+    if (!srcTexture || !outTexture || !outSharedHandle) return false;
+
+    const auto texture = reinterpret_cast<ID3D11Texture2D*>(lastSharedTextureId_--);
+    AddTexture(texture, srcTexture->width, srcTexture->height, srcTexture->bytesPerPixel);
+
+    *outTexture = texture;
+    *outSharedHandle = texture;
+
+    return true;
+}
+
+
+ID3D11Texture2D* CpuUploadDevice::OpenSharedTexture(HANDLE sharedHandle) const
+{
+    const auto texture = static_cast<ID3D11Texture2D*>(sharedHandle);
+    return textures_.count(texture) ? texture : nullptr;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Windows.h>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+
+struct ID3D11Texture2D;
+
+
+// Creates and writes textures in the upload thread. UploadManager uploads
+// through the D3D11 device; CpuUploadDevice keeps the pixels in memory so that
+// the same path runs in tests and benchmarks without a GPU.
+class IUploadDevice
+{
+public:
+    virtual ~IUploadDevice() = default;
+
+    // Return false when nothing has been written to the destination.
+    virtual bool UpdateTexture(ID3D11Texture2D* texture, const void* data, UINT pitch) = 0;
+    virtual bool CopyTexture(ID3D11Texture2D* dst, ID3D11Texture2D* src) = 0;
+
+    // Creates a texture in the layout of src which other devices open with outSharedHandle.
+    // The caller owns a reference to outTexture as with ID3D11Device::CreateTexture2D().
+    virtual bool CreateSharedTexture(ID3D11Texture2D* src, ID3D11Texture2D** outTexture, HANDLE* outSharedHandle) = 0;
+};
+
+
+class CpuUploadDevice : public IUploadDevice
+{
+public:
+    // The pointer only identifies the texture, it is never dereferenced.
+    void AddTexture(ID3D11Texture2D* texture, UINT width, UINT height, UINT bytesPerPixel);
+    void RemoveTexture(ID3D11Texture2D* texture);
+    const BYTE* GetPixels(ID3D11Texture2D* texture) const;
+
+    bool UpdateTexture(ID3D11Texture2D* texture, const void* data, UINT pitch) override;
+    bool CopyTexture(ID3D11Texture2D* dst, ID3D11Texture2D* src) override;
+
+    // A shared texture is kept until RemoveTexture(); its handle opens the same pixels.
+    bool CreateSharedTexture(ID3D11Texture2D* src, ID3D11Texture2D** outTexture, HANDLE* outSharedHandle) override;
+    ID3D11Texture2D* OpenSharedTexture(HANDLE sharedHandle) const;
+
+private:
+    struct Texture
+    {
+        UINT width = 0;
+        UINT height = 0;
+        UINT bytesPerPixel = 0;
+        std::vector<BYTE> pixels;
+    };
+
+    Texture* Find(ID3D11Texture2D* texture);
+
+    std::unordered_map<ID3D11Texture2D*, Texture> textures_;
+
+    // Shared textures take ids from the top of the address space so that they
+    // do not collide with the ones given to AddTexture().
+    uintptr_t lastSharedTextureId_ = UINTPTR_MAX;
+};
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
 #include <d3d11.h>
 #include <wrl/client.h>
 
 #include "WindowQueue.h"
+#include "UploadDevice.h"
 #include "Thread.h"
 
 
@@ -15,6 +17,7 @@ class UploadManager
 {
 public:
     using DevicePtr = Microsoft::WRL::ComPtr<ID3D11Device>;
+    using ContextPtr = Microsoft::WRL::ComPtr<ID3D11DeviceContext>;
     using TexturePtr = Microsoft::WRL::ComPtr<ID3D11Texture2D>;
 
     UploadManager();
@@ -22,19 +25,28 @@ public:
 
     bool IsReady() const { return isReady_; }
     DevicePtr GetDevice();
-    TexturePtr CreateCompatibleSharedTexture(const TexturePtr& texture);
+    bool CreateSharedTexture(ID3D11Texture2D* src, TexturePtr& outTexture, HANDLE& outSharedHandle);
+    bool UpdateTexture(const TexturePtr& texture, const void* data, UINT pitch);
+    bool CopyTexture(const TexturePtr& dst, ID3D11Texture2D* src);
     void RequestUploadWindow(int id);
     void RequestUploadIcon(int id);
     void StartUploadThread();
     void StopUploadThread();
+    UINT GetSharedTextureCreationCountPerSecond() const { return sharedTextureCreationCountPerSecond_; }
 
 private:
     void CreateDevice();
+    void UpdateSharedTextureCreationCount();
 
     bool isReady_ = false;
     DevicePtr device_;
+    ContextPtr context_;
+    std::unique_ptr<IUploadDevice> uploadDevice_;
     std::thread initThread_;
     ThreadLoop threadLoop_ = { L"uWindowCapture - Upload Thread" };
     WindowQueue windowUploadQueue_;
     WindowQueue iconUploadQueue_;
+    std::atomic<UINT> sharedTextureCreationCount_ = 0;
+    std::atomic<UINT> sharedTextureCreationCountPerSecond_ = 0;
+    std::chrono::steady_clock::time_point sharedTextureCreationCountTime_;
 };
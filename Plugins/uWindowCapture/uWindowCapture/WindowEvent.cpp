@@ -0,0 +1,175 @@
+#include "WindowEvent.h"
+#include "Debug.h"
+
+
+
+namespace
+{
+    thread_local WindowEventTracker* g_tracker = nullptr;
+
+
+    void CALLBACK OnWinEvent(
+        HWINEVENTHOOK hWinEventHook,
+        DWORD event,
+        HWND hWnd,
+        LONG idObject,
+        LONG idChild,
+        DWORD idEventThread,
+        DWORD dwmsEventTime)
+    {
+        if (!g_tracker) return;
+
+        WindowEventType type;
+        switch (event)
+        {
+            case EVENT_OBJECT_CREATE        : type = WindowEventType::Created;     break;
+            case EVENT_OBJECT_DESTROY       : type = WindowEventType::Destroyed;   break;
+            case EVENT_OBJECT_SHOW          : type = WindowEventType::Shown;       break;
+            case EVENT_SYSTEM_MINIMIZEEND   : type = WindowEventType::Shown;       break;
+            case EVENT_OBJECT_HIDE          : type = WindowEventType::Hidden;      break;
+            case EVENT_SYSTEM_MINIMIZESTART : type = WindowEventType::Hidden;      break;
+            case EVENT_OBJECT_LOCATIONCHANGE: type = WindowEventType::Moved;       break;
+            case EVENT_OBJECT_REORDER       : type = WindowEventType::Reordered;   break;
+            case EVENT_SYSTEM_FOREGROUND    : type = WindowEventType::Reordered;   break;
+            case EVENT_OBJECT_NAMECHANGE    : type = WindowEventType::NameChanged; break;
+            case EVENT_OBJECT_UNCLOAKED     : type = WindowEventType::Shown;       break;
+            case EVENT_OBJECT_CLOAKED       : type = WindowEventType::Hidden;      break;
+            default: return;
+        }
+
+        if (event == EVENT_OBJECT_REORDER)
+        {
+            // Reorder events are reported on the parent, so only the desktop
+            // reports a change of the top-level z-order.
+            if (hWnd != ::GetDesktopWindow()) return;
+        }
+        else
+        {
+            if (idObject != OBJID_WINDOW || idChild != CHILDID_SELF) return;
+
+            // Destroyed windows cannot be queried anymore; the window list ignores
+            // the ones it does not have, such as child windows.
+            if (::IsWindow(hWnd) && ::GetAncestor(hWnd, GA_PARENT) != ::GetDesktopWindow()) return;
+        }
+
+        g_tracker->Push({ type, hWnd });
+    }
+}
+
+
+WindowEventHook::WindowEventHook(WindowEventTracker& tracker)
+    : tracker_(tracker)
+{
+}
+
+
+WindowEventHook::~WindowEventHook()
+{
+    Stop();
+}
+
+
+bool WindowEventHook::Start()
+{
+    if (thread_.joinable()) return IsActive();
+
+    std::promise<bool> result;
+    auto isInstalled = result.get_future();
+
+    thread_ = std::thread([this, &result]
+    {
+        Run(result);
+    });
+
+    if (!isInstalled.get())
+    {
+        thread_.join();
+        return false;
+    }
+
+    return true;
+}
+
+
+void WindowEventHook::Stop()
+{
+    if (!thread_.joinable()) return;
+
+    ::PostThreadMessageW(threadId_, WM_QUIT, 0, 0);
+    thread_.join();
+}
+
+
+bool WindowEventHook::IsActive() const
+{
+    return isActive_;
+}
+
+
+void WindowEventHook::Run(std::promise<bool>& result)
+{
+    ::SetThreadDescription(::GetCurrentThread(), L"uWindowCapture - Window Event Hook Thread");
+
+    // Create the message queue before Stop() can post WM_QUIT.
+    MSG msg;
+    ::PeekMessageW(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+    threadId_ = ::GetCurrentThreadId();
+
+    g_tracker = &tracker_;
+
+    const auto hSystemHook = ::SetWinEventHook(
+        EVENT_SYSTEM_FOREGROUND,
+        EVENT_SYSTEM_MINIMIZEEND,
+        NULL,
+        OnWinEvent,
+        0,
+        0,
+        WINEVENT_OUTOFCONTEXT);
+    const auto hObjectHook = ::SetWinEventHook(
+        EVENT_OBJECT_CREATE,
+        EVENT_OBJECT_NAMECHANGE,
+        NULL,
+        OnWinEvent,
+        0,
+        0,
+        WINEVENT_OUTOFCONTEXT);
+
+    const auto hCloakHook = ::SetWinEventHook(
+        EVENT_OBJECT_CLOAKED,
+        EVENT_OBJECT_UNCLOAKED,
+        NULL,
+        OnWinEvent,
+        0,
+        0,
+        WINEVENT_OUTOFCONTEXT);
+
+    if (!hSystemHook || !hObjectHook || !hCloakHook)
+    {
+        OutputApiError(__FUNCTION__, "SetWinEventHook");
+        if (hSystemHook) ::UnhookWinEvent(hSystemHook);
+        if (hObjectHook) ::UnhookWinEvent(hObjectHook);
+        if (hCloakHook) ::UnhookWinEvent(hCloakHook);
+        g_tracker = nullptr;
+        result.set_value(false);
+        return;
+    }
+
+    isActive_ = true;
+    result.set_value(true);
+
+    while (::GetMessageW(&msg, NULL, 0, 0) > 0)
+    {
+        ::TranslateMessage(&msg);
+        ::DispatchMessageW(&msg);
+    }
+
+    isActive_ = false;
+
+    ::UnhookWinEvent(hSystemHook);
+    ::UnhookWinEvent(hObjectHook);
+    ::UnhookWinEvent(hCloakHook);
+    g_tracker = nullptr;
+
+    // Events received while the hook was down may have been missed.
+    tracker_.RequestFullUpdate();
+}
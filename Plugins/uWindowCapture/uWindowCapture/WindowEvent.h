@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Windows.h>
+#include <thread>
+#include <atomic>
+#include <future>
+#include "WindowEventTracker.h"
+
+
+
+// Receives window events with SetWinEventHook() on its own thread
+// and forwards events of top-level windows to the tracker.
+class WindowEventHook
+{
+public:
+    explicit WindowEventHook(WindowEventTracker& tracker);
+    ~WindowEventHook();
+    bool Start();
+    void Stop();
+    bool IsActive() const;
+
+private:
+    void Run(std::promise<bool>& result);
+
+    WindowEventTracker& tracker_;
+    std::thread thread_;
+    std::atomic<DWORD> threadId_ = 0;
+    std::atomic<bool> isActive_ = false;
+};
@@ -0,0 +1,97 @@
+#include "WindowEventTracker.h"
+
+
+
+bool WindowEventTracker::Changes::HasWindowListChanges() const
+{
+    return
+        needsZOrderUpdate ||
+        !shownWindows.empty() ||
+        !hiddenWindows.empty() ||
+        !movedWindows.empty();
+}
+
+
+void WindowEventTracker::Push(const WindowEvent& event)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    switch (event.type)
+    {
+        case WindowEventType::Moved:
+            movedWindows_.insert(event.hWnd);
+            break;
+        case WindowEventType::NameChanged:
+            renamedWindows_.insert(event.hWnd);
+            break;
+        case WindowEventType::Created:
+            visibilityChanges_[event.hWnd] = true;
+            break;
+        case WindowEventType::Destroyed:
+            visibilityChanges_[event.hWnd] = false;
+            break;
+        case WindowEventType::Shown:
+            // A visible window shifts the z-order of every window below it,
+            // even when the window itself is not listed.
+            visibilityChanges_[event.hWnd] = true;
+            needsZOrderUpdate_ = true;
+            break;
+        case WindowEventType::Hidden:
+            visibilityChanges_[event.hWnd] = false;
+            needsZOrderUpdate_ = true;
+            break;
+        case WindowEventType::Reordered:
+            needsZOrderUpdate_ = true;
+            break;
+    }
+}
+
+
+void WindowEventTracker::RequestFullUpdate()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    needsFullUpdate_ = true;
+}
+
+
+WindowEventTracker::Changes WindowEventTracker::Consume(INT64 now, INT64 fullUpdateInterval)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Changes changes;
+
+    // Hidden windows only need a lookup, but each shown window is queried.
+    size_t shownWindowCount = 0;
+    for (const auto& pair : visibilityChanges_)
+    {
+        if (pair.second) ++shownWindowCount;
+    }
+
+    // Resync periodically to recover from events that were missed or not reported.
+    if (needsFullUpdate_ ||
+        shownWindowCount > kMaxIncrementalShownWindows ||
+        now - lastFullUpdateTime_ >= fullUpdateInterval)
+    {
+        changes.needsFullUpdate = true;
+        needsFullUpdate_ = false;
+        lastFullUpdateTime_ = now;
+    }
+    else
+    {
+        changes.needsZOrderUpdate = needsZOrderUpdate_;
+        for (const auto& pair : visibilityChanges_)
+        {
+            auto& windows = pair.second ? changes.shownWindows : changes.hiddenWindows;
+            windows.push_back(pair.first);
+        }
+        changes.movedWindows.assign(movedWindows_.begin(), movedWindows_.end());
+    }
+    needsZOrderUpdate_ = false;
+    visibilityChanges_.clear();
+    movedWindows_.clear();
+
+    changes.renamedWindows.assign(renamedWindows_.begin(), renamedWindows_.end());
+    renamedWindows_.clear();
+
+    return changes;
+}
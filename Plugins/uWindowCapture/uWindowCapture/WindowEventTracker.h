@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+#include <unordered_set>
+#include <unordered_map>
+#include <mutex>
+
+
+
+enum class WindowEventType
+{
+    Created,
+    Destroyed,
+    Shown,
+    Hidden,
+    Moved,
+    Reordered,
+    NameChanged,
+};
+
+
+struct WindowEvent
+{
+    WindowEventType type;
+    HWND hWnd;
+};
+
+
+// Accumulates window events between two window list updates and decides
+// which part of the list has to be refreshed. This class does not call any
+// window API, so it can be fed by a recorded or synthetic event stream.
+class WindowEventTracker
+{
+public:
+    // Above this many shown windows in one update, enumerating all the
+    // windows is cheaper than querying each of them.
+    static constexpr size_t kMaxIncrementalShownWindows = 256;
+
+    struct Changes
+    {
+        bool needsFullUpdate = false;
+        bool needsZOrderUpdate = false;
+        std::vector<HWND> shownWindows; // created or shown
+        std::vector<HWND> hiddenWindows; // destroyed or hidden
+        std::vector<HWND> movedWindows;
+        std::vector<HWND> renamedWindows;
+
+        bool HasWindowListChanges() const;
+    };
+
+    void Push(const WindowEvent& event);
+    void RequestFullUpdate();
+    Changes Consume(INT64 now, INT64 fullUpdateInterval); // [us]
+
+private:
+    std::unordered_map<HWND, bool> visibilityChanges_; // the last state wins
+    std::unordered_set<HWND> movedWindows_;
+    std::unordered_set<HWND> renamedWindows_;
+    bool needsFullUpdate_ = true;
+    bool needsZOrderUpdate_ = false;
+    INT64 lastFullUpdateTime_ = 0;
+    std::mutex mutex_;
+};
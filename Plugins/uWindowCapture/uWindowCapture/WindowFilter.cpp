@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <cwctype>
+#include "WindowFilter.h"
+#include "Util.h"
+
+
+
+namespace
+{
+    std::wstring ToLower(std::wstring str)
+    {
+        std::transform(str.begin(), str.end(), str.begin(), [](wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+        return str;
+    }
+}
+
+
+void WindowFilter::Set(Settings settings)
+{
+    for (auto& p : settings.patterns)
+    {
+        p.pattern = ToLower(std::move(p.pattern));
+    }
+
+    std::lock_guard<std::mutex> lock(settingsMutex_);
+    settings_ = std::move(settings);
+    hasChanged_ = true;
+}
+
+
+void WindowFilter::SetAltTabOnly(bool isAltTabOnly)
+{
+    std::lock_guard<std::mutex> lock(settingsMutex_);
+    settings_.isAltTabOnly = isAltTabOnly;
+    hasChanged_ = true;
+}
+
+
+void WindowFilter::SetMinSize(int width, int height)
+{
+    std::lock_guard<std::mutex> lock(settingsMutex_);
+    settings_.minWidth = width;
+    settings_.minHeight = height;
+    hasChanged_ = true;
+}
+
+
+void WindowFilter::AddPattern(WindowFilterTarget target, WindowFilterMode mode, const std::wstring& pattern)
+{
+    std::lock_guard<std::mutex> lock(settingsMutex_);
+    settings_.patterns.push_back({ target, mode, ToLower(pattern) });
+    hasChanged_ = true;
+}
+
+
+void WindowFilter::Clear()
+{
+    std::lock_guard<std::mutex> lock(settingsMutex_);
+    settings_ = Settings();
+    hasChanged_ = true;
+}
+
+
+bool WindowFilter::ConsumeChanged()
+{
+    return hasChanged_.exchange(false);
+}
+
+
+void WindowFilter::BeginEnumeration()
+{
+    // Run this scope in the window handle list thread.
+
+    std::lock_guard<std::mutex> lock(settingsMutex_);
+    currentSettings_ = settings_;
+    isEnumerating_ = true;
+}
+
+
+void WindowFilter::EndEnumeration()
+{
+    // Drop the cache of windows and processes which were not visited in this enumeration.
+    std::swap(entries_[0], entries_[1]);
+    entries_[1].clear();
+    std::swap(processNames_[0], processNames_[1]);
+    processNames_[1].clear();
+    isEnumerating_ = false;
+}
+
+
+bool WindowFilter::IsMatch(HWND hWnd, const RECT& windowRect)
+{
+    // Run this scope in the window handle list thread.
+
+    const auto& settings = currentSettings_;
+
+    // Evaluate cheap conditions first.
+    if (windowRect.right - windowRect.left < settings.minWidth ||
+        windowRect.bottom - windowRect.top < settings.minHeight)
+    {
+        return false;
+    }
+
+    if (settings.patterns.empty() && !settings.isAltTabOnly)
+    {
+        return true;
+    }
+
+    const auto& entry = GetEntry(hWnd);
+
+    if (!MatchPatterns(WindowFilterTarget::ClassName, entry.className))
+    {
+        return false;
+    }
+
+    if (settings.isAltTabOnly && !IsAltTabWindow(hWnd))
+    {
+        return false;
+    }
+
+    if (HasPattern(WindowFilterTarget::Title))
+    {
+        // InternalGetWindowText() does not send WM_GETTEXT, so hung windows never block here.
+        WCHAR buf[256];
+        const int len = ::InternalGetWindowText(hWnd, buf, _countof(buf));
+        if (!MatchPatterns(WindowFilterTarget::Title, ToLower(std::wstring(buf, len))))
+        {
+            return false;
+        }
+    }
+
+    if (!MatchPatterns(WindowFilterTarget::ProcessName, entry.processName))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+
+const WindowFilter::Entry& WindowFilter::GetEntry(HWND hWnd)
+{
+    DWORD processId = 0;
+    ::GetWindowThreadProcessId(hWnd, &processId);
+
+    // The handle may have been reused by another process since the last enumeration.
+    const auto it = entries_[0].find(hWnd);
+    if (it != entries_[0].end() && it->second.processId == processId)
+    {
+        auto& entry = isEnumerating_ ? (entries_[1][hWnd] = std::move(it->second)) : it->second;
+        if (HasPattern(WindowFilterTarget::ProcessName) && entry.processName.empty())
+        {
+            entry.processName = GetProcessName(processId);
+        }
+        return entry;
+    }
+
+    // Outside an enumeration the entry goes to the cache of the last enumeration.
+    auto& entry = entries_[isEnumerating_ ? 1 : 0][hWnd];
+    entry = Entry();
+    entry.processId = processId;
+
+    WCHAR className[256];
+    const int len = ::GetClassNameW(hWnd, className, _countof(className));
+    entry.className = ToLower(std::wstring(className, len));
+
+    if (HasPattern(WindowFilterTarget::ProcessName))
+    {
+        entry.processName = GetProcessName(processId);
+    }
+
+    return entry;
+}
+
+
+const std::wstring& WindowFilter::GetProcessName(DWORD processId)
+{
+    const auto it = processNames_[0].find(processId);
+    if (it != processNames_[0].end())
+    {
+        return isEnumerating_ ? (processNames_[1][processId] = std::move(it->second)) : it->second;
+    }
+
+    auto& name = processNames_[isEnumerating_ ? 1 : 0][processId];
+
+    const auto hProcess = ::OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+    if (hProcess)
+    {
+        WCHAR path[MAX_PATH];
+        DWORD size = _countof(path);
+        if (::QueryFullProcessImageNameW(hProcess, 0, path, &size))
+        {
+            const std::wstring fullPath(path, size);
+            const auto pos = fullPath.find_last_of(L"\\/");
+            name = ToLower(pos == std::wstring::npos ? fullPath : fullPath.substr(pos + 1));
+        }
+        ::CloseHandle(hProcess);
+    }
+
+    return name;
+}
+
+
+bool WindowFilter::HasPattern(WindowFilterTarget target) const
+{
+    return std::any_of(
+        currentSettings_.patterns.begin(), 
+        currentSettings_.patterns.end(), 
+        [target](const auto& p) { return p.target == target; });
+}
+
+
+bool WindowFilter::MatchPatterns(WindowFilterTarget target, const std::wstring& value) const
+{
+    bool hasIncludePattern = false;
+    bool isIncluded = false;
+
+    for (const auto& p : currentSettings_.patterns)
+    {
+        if (p.target != target) continue;
+
+        const bool isMatched = MatchWildcard(p.pattern.c_str(), value.c_str());
+        if (p.mode == WindowFilterMode::Exclude)
+        {
+            if (isMatched) return false;
+        }
+        else
+        {
+            hasIncludePattern = true;
+            isIncluded = isIncluded || isMatched;
+        }
+    }
+
+    return !hasIncludePattern || isIncluded;
+}
+
+
+bool WindowFilter::MatchWildcard(const wchar_t* pattern, const wchar_t* str)
+{
+    // '*' matches any sequence and '?' matches any single character.
+    const wchar_t* star = nullptr;
+    const wchar_t* retry = nullptr;
+
+    while (*str)
+    {
+        if (*pattern == L'?' || *pattern == *str)
+        {
+            ++pattern;
+            ++str;
+        }
+        else if (*pattern == L'*')
+        {
+            star = pattern++;
+            retry = str;
+        }
+        else if (star)
+        {
+            pattern = star + 1;
+            str = ++retry;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (*pattern == L'*') ++pattern;
+
+    return *pattern == L'\0';
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+
+
+
+enum class WindowFilterTarget
+{
+    ClassName = 0,
+    Title = 1,
+    ProcessName = 2,
+};
+
+
+enum class WindowFilterMode
+{
+    Include = 0,
+    Exclude = 1,
+};
+
+
+// Layout of a pattern passed by UwcSetWindowFilter().
+struct WindowFilterPatternDesc
+{
+    WindowFilterTarget target;
+    WindowFilterMode mode;
+    const WCHAR* pattern;
+};
+
+
+// Decides during the enumeration which top-level windows become Window instances.
+// Rejected windows never get textures, icons or capture items; only a small cache
+// entry per window handle is kept so that they are not inspected from scratch on
+// every enumeration.
+class WindowFilter
+{
+public:
+    struct Pattern
+    {
+        WindowFilterTarget target;
+        WindowFilterMode mode;
+        std::wstring pattern;
+    };
+
+    struct Settings
+    {
+        bool isAltTabOnly = false;
+        int minWidth = 0;
+        int minHeight = 0;
+        std::vector<Pattern> patterns;
+    };
+
+    // Replaces the whole filter at once, so no enumeration sees a partially applied one.
+    void Set(Settings settings);
+    void SetAltTabOnly(bool isAltTabOnly);
+    void SetMinSize(int width, int height);
+    void AddPattern(WindowFilterTarget target, WindowFilterMode mode, const std::wstring& pattern);
+    void Clear();
+    bool ConsumeChanged();
+
+    // IsMatch() may also be called outside an enumeration for windows shown in between,
+    // in which case the settings and the cache of the last enumeration are used.
+    void BeginEnumeration();
+    bool IsMatch(HWND hWnd, const RECT& windowRect);
+    void EndEnumeration();
+
+private:
+    struct Entry
+    {
+        DWORD processId = 0;
+        std::wstring className;
+        std::wstring processName;
+    };
+
+    static bool MatchWildcard(const wchar_t* pattern, const wchar_t* str);
+    bool MatchPatterns(WindowFilterTarget target, const std::wstring& value) const;
+    bool HasPattern(WindowFilterTarget target) const;
+    const Entry& GetEntry(HWND hWnd);
+    const std::wstring& GetProcessName(DWORD processId);
+
+    Settings settings_;
+    std::mutex settingsMutex_;
+    std::atomic<bool> hasChanged_ = false;
+
+    // Accessed only from the window handle list thread.
+    Settings currentSettings_;
+    bool isEnumerating_ = false;
+    std::unordered_map<HWND, Entry> entries_[2];
+    std::unordered_map<DWORD, std::wstring> processNames_[2];
+};
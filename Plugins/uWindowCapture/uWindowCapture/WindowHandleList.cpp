@@ -0,0 +1,149 @@
+#include <tuple>
+#include <algorithm>
+#include <unordered_set>
+#include "WindowHandleList.h"
+
+
+
+bool IsWindowHandleDataOrderedBefore(const WindowHandleData& a, const WindowHandleData& b)
+{
+    const auto keyA = a.isDesktop ? reinterpret_cast<uintptr_t>(a.hMonitor) : reinterpret_cast<uintptr_t>(a.hWnd);
+    const auto keyB = b.isDesktop ? reinterpret_cast<uintptr_t>(b.hMonitor) : reinterpret_cast<uintptr_t>(b.hWnd);
+    const bool isDesktopA = a.isDesktop != FALSE;
+    const bool isDesktopB = b.isDesktop != FALSE;
+    return std::tie(isDesktopA, keyA) < std::tie(isDesktopB, keyB);
+}
+
+
+void EnumerateWindowHandleData(IWindowHandleSource& source, std::vector<WindowHandleData>& dataList)
+{
+    dataList.clear();
+
+    WindowZOrderCounter zOrderCounter;
+    source.ForEachTopLevelWindow([&](HWND hWnd, bool isVisible)
+    {
+        const UINT zOrder = zOrderCounter.Visit(isVisible);
+        if (!isVisible) return;
+
+        WindowHandleData data;
+        if (!source.GetWindowData(hWnd, data)) return;
+
+        data.zOrder = zOrder;
+        dataList.push_back(data);
+    });
+
+    source.GetDesktopData(dataList);
+
+    std::sort(dataList.begin(), dataList.end(), IsWindowHandleDataOrderedBefore);
+}
+
+
+void ApplyWindowChanges(
+    IWindowHandleSource& source,
+    const WindowEventTracker::Changes& changes,
+    std::vector<WindowHandleData>& dataList)
+{
+    const auto find = [&](HWND hWnd) -> WindowHandleData*
+    {
+        WindowHandleData key {};
+        key.hWnd = hWnd;
+        const auto it = std::lower_bound(dataList.begin(), dataList.end(), key, IsWindowHandleDataOrderedBefore);
+        return (it != dataList.end() && !it->isDesktop && it->hWnd == hWnd) ? &*it : nullptr;
+    };
+
+    std::unordered_set<HWND> removedWindows;
+    std::vector<WindowHandleData> addedWindows;
+
+    const auto refresh = [&](HWND hWnd, WindowHandleData* current)
+    {
+        WindowHandleData data;
+        const bool isListed = source.GetWindowData(hWnd, data);
+
+        if (current)
+        {
+            if (isListed)
+            {
+                data.zOrder = current->zOrder;
+                *current = data;
+            }
+            else
+            {
+                removedWindows.insert(hWnd);
+            }
+        }
+        else if (isListed)
+        {
+            addedWindows.push_back(data);
+        }
+    };
+
+    // Minimized and cloaked windows are still visible to the window API and stay
+    // listed, so hidden windows are queried again as well unless they are unknown.
+    for (const auto hWnd : changes.hiddenWindows)
+    {
+        if (auto current = find(hWnd)) refresh(hWnd, current);
+    }
+
+    for (const auto hWnd : changes.shownWindows)
+    {
+        refresh(hWnd, find(hWnd));
+    }
+
+    for (const auto hWnd : changes.movedWindows)
+    {
+        if (auto current = find(hWnd))
+        {
+            source.UpdateWindowRect(*current);
+        }
+    }
+
+    if (!removedWindows.empty())
+    {
+        dataList.erase(
+            std::remove_if(dataList.begin(), dataList.end(), [&](const WindowHandleData& data)
+            {
+                return !data.isDesktop && removedWindows.find(data.hWnd) != removedWindows.end();
+            }),
+            dataList.end());
+    }
+
+    if (!addedWindows.empty())
+    {
+        const auto middle = dataList.insert(dataList.end(), addedWindows.begin(), addedWindows.end());
+        std::sort(middle, dataList.end(), IsWindowHandleDataOrderedBefore);
+        std::inplace_merge(dataList.begin(), middle, dataList.end(), IsWindowHandleDataOrderedBefore);
+    }
+
+    if (changes.needsZOrderUpdate || !removedWindows.empty() || !addedWindows.empty())
+    {
+        // Collect the walk and join it with the list by handle, which is cheaper
+        // than looking up every visited window in the list.
+        std::vector<std::pair<HWND, UINT>> zOrders;
+        zOrders.reserve(dataList.size());
+
+        WindowZOrderCounter zOrderCounter;
+        source.ForEachTopLevelWindow([&](HWND hWnd, bool isVisible)
+        {
+            const UINT zOrder = zOrderCounter.Visit(isVisible);
+            if (isVisible) zOrders.emplace_back(hWnd, zOrder);
+        });
+
+        std::sort(zOrders.begin(), zOrders.end(), [](const auto& a, const auto& b)
+        {
+            return reinterpret_cast<uintptr_t>(a.first) < reinterpret_cast<uintptr_t>(b.first);
+        });
+
+        auto it = zOrders.begin();
+        for (auto& data : dataList)
+        {
+            if (data.isDesktop) continue;
+
+            const auto key = reinterpret_cast<uintptr_t>(data.hWnd);
+            while (it != zOrders.end() && reinterpret_cast<uintptr_t>(it->first) < key) ++it;
+            if (it != zOrders.end() && it->first == data.hWnd)
+            {
+                data.zOrder = it->second;
+            }
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+#include <utility>
+#include <functional>
+#include "WindowEventTracker.h"
+
+
+
+// Data of a top-level window or a monitor gathered by the window handle list thread.
+struct WindowHandleData
+{
+    BOOL isDesktop;
+    HWND hWnd;
+    HMONITOR hMonitor;
+    HWND hOwner;
+    RECT windowRect;
+    RECT clientRect;
+    UINT zOrder;
+    BOOL isHitTestVisible;
+};
+
+
+// Windows are keyed by their handle and desktops by their monitor.
+bool IsWindowHandleDataOrderedBefore(const WindowHandleData& a, const WindowHandleData& b);
+
+
+// Window API queries used to build and update the window handle list,
+// so that the list logic can run against synthetic windows.
+class IWindowHandleSource
+{
+public:
+    virtual ~IWindowHandleSource() = default;
+
+    // Visits the top-level windows from the top of the z-order.
+    virtual void ForEachTopLevelWindow(const std::function<void(HWND hWnd, bool isVisible)>& func) = 0;
+    // Fills all but zOrder; returns false if the window is not (or no longer) listed.
+    virtual bool GetWindowData(HWND hWnd, WindowHandleData& data) = 0;
+    virtual void UpdateWindowRect(WindowHandleData& data) = 0;
+    virtual void GetDesktopData(std::vector<WindowHandleData>& dataList) = 0;
+};
+
+
+// The z-order of a window is the number of visible windows above it, which is
+// derived from the sequence of a top-level window walk from the top.
+class WindowZOrderCounter
+{
+public:
+    UINT Visit(bool isVisible)
+    {
+        const UINT zOrder = visibleWindowCount_;
+        if (isVisible) ++visibleWindowCount_;
+        return zOrder;
+    }
+
+private:
+    UINT visibleWindowCount_ = 0;
+};
+
+
+// Builds the sorted list of all the listed windows and desktops from scratch.
+void EnumerateWindowHandleData(IWindowHandleSource& source, std::vector<WindowHandleData>& dataList);
+
+// Applies the changes reported since the last update to a sorted list, querying only
+// the windows in the changes. Hidden or destroyed windows which are not in the list,
+// such as child windows, are ignored. Z-orders are refreshed by a top-level walk
+// only when the stack may have changed.
+void ApplyWindowChanges(
+    IWindowHandleSource& source,
+    const WindowEventTracker::Changes& changes,
+    std::vector<WindowHandleData>& dataList);
+
+
+// Merges the entries of the previous update with a new data list in a single pass.
+// Both are sorted by IsWindowHandleDataOrderedBefore() and Entry has a data member.
+// onAdded() returns the entry of a new window, onKept() updates an existing one.
+template <class Entry, class OnRemoved, class OnAdded, class OnKept>
+std::vector<Entry> MergeWindowHandleData(
+    std::vector<Entry>&& prevEntries,
+    const std::vector<WindowHandleData>& dataList,
+    const OnRemoved& onRemoved,
+    const OnAdded& onAdded,
+    const OnKept& onKept)
+{
+    std::vector<Entry> entries;
+    entries.reserve(dataList.size());
+
+    auto prevIt = prevEntries.begin();
+    auto dataIt = dataList.begin();
+
+    while (prevIt != prevEntries.end() || dataIt != dataList.end())
+    {
+        if (dataIt == dataList.end() ||
+            (prevIt != prevEntries.end() && IsWindowHandleDataOrderedBefore(prevIt->data, *dataIt)))
+        {
+            onRemoved(*prevIt);
+            ++prevIt;
+        }
+        else if (prevIt == prevEntries.end() || IsWindowHandleDataOrderedBefore(*dataIt, prevIt->data))
+        {
+            entries.push_back(onAdded(*dataIt));
+            ++dataIt;
+        }
+        else
+        {
+            onKept(*prevIt, *dataIt);
+            entries.push_back(std::move(*prevIt));
+            ++prevIt;
+            ++dataIt;
+        }
+    }
+
+    prevEntries.clear();
+    return entries;
+}
@@ -1,449 +1,789 @@
-#include <algorithm>
-#include <oleacc.h>
-#include "WindowManager.h"
-#include "WindowTexture.h"
-#include "Message.h"
-#include "Util.h"
-#include "Debug.h"
-
-using namespace Microsoft::WRL;
-
-
-
-UWC_SINGLETON_INSTANCE(WindowManager)
-
-
-void WindowManager::Initialize()
-{
-    {
-        UWC_SCOPE_TIMER(InitWindowsGraphicsCaptureManager);
-        windowsGraphicsCaptureManager_ = std::make_unique<WindowsGraphicsCaptureManager>();
-    }
-    {
-        UWC_SCOPE_TIMER(InitUploadManager);
-        uploadManager_ = std::make_unique<UploadManager>();
-    }
-    {
-        UWC_SCOPE_TIMER(InitCaptureManager);
-        captureManager_ = std::make_unique<CaptureManager>();
-    }
-    {
-        UWC_SCOPE_TIMER(Cursor);
-        cursor_ = std::make_unique<Cursor>();
-    }
-    {
-        UWC_SCOPE_TIMER(StartThread);
-        StartWindowHandleListThread();
-    }
-}
-
-
-void WindowManager::Finalize()
-{
-    StopWindowHandleListThread();
-    cursor_.reset();
-    captureManager_.reset();
-    uploadManager_.reset();
-    windowsGraphicsCaptureManager_.reset();
-    {
-        std::scoped_lock lock(windowsListMutex_);
-        windows_.clear();
-    }
-}
-
-
-void WindowManager::Update(float dt)
-{
-    if (windowsGraphicsCaptureManager_) 
-    {
-        windowsGraphicsCaptureManager_->UpdateFromMainThread(dt);
-    }
-}
-
-
-void WindowManager::Render()
-{
-    RenderWindows();
-    cursor_->Render();
-}
-
-
-void WindowManager::StartWindowHandleListThread()
-{
-    windowHandleListThreadLoop_.Start([this]
-    {
-        UpdateWindowHandleList();
-        UpdateWindows();
-    }, std::chrono::milliseconds(16));
-}
-
-
-void WindowManager::StopWindowHandleListThread()
-{
-    windowHandleListThreadLoop_.Stop();
-}
-
-
-const std::unique_ptr<CaptureManager>& WindowManager::GetCaptureManager()
-{
-    return WindowManager::Get().captureManager_;
-}
-
-
-const std::unique_ptr<UploadManager>& WindowManager::GetUploadManager()
-{
-    return WindowManager::Get().uploadManager_;
-}
-
-
-const std::unique_ptr<WindowsGraphicsCaptureManager>& WindowManager::GetWindowsGraphicsCaptureManager()
-{
-    return WindowManager::Get().windowsGraphicsCaptureManager_;
-}
-
-
-const std::unique_ptr<Cursor>& WindowManager::GetCursor()
-{
-    return WindowManager::Get().cursor_;
-}
-
-
-bool WindowManager::CheckExistence(int id) const
-{
-    std::scoped_lock lock(windowsListMutex_);
-    return windows_.find(id) != windows_.end();
-}
-
-
-std::shared_ptr<Window> WindowManager::GetWindow(int id) const
-{
-    std::scoped_lock lock(windowsListMutex_);
-
-    auto it = windows_.find(id);
-    if (it == windows_.end())
-    {
-        return nullptr;
-    }
-
-    return it->second;
-}
-
-
-std::shared_ptr<Window> WindowManager::GetWindowFromPoint(POINT point) const
-{
-    auto hWnd = ::WindowFromPoint(point);
-
-    while (hWnd != NULL)
-    {
-        DWORD thread, process;
-        thread = ::GetWindowThreadProcessId(hWnd, &process);
-
-        std::shared_ptr<Window> parent;
-        int maxZOrder = INT_MAX;
-
-        {
-            std::scoped_lock lock(windowsListMutex_);
-
-            for (const auto& pair : windows_)
-            {
-                const auto& window = pair.second;
-
-                // Return the window whose handle is same
-                if (window->GetWindowHandle() == hWnd) 
-                {
-                    return window;
-                }
-
-                // Keep windows whose process and thread ids are same
-                if ((window->GetThreadId() == thread) &&
-                    (window->GetProcessId() == process))
-                {
-                    const int zOrder = window->GetZOrder();
-                    if (zOrder > maxZOrder)
-                    {
-                        maxZOrder = zOrder;
-                        parent = window;
-                    }
-                }
-            }
-        }
-
-        // Return parent if found.
-        if (parent)
-        {
-            return parent;
-        }
-
-        // Move next
-        hWnd = ::GetAncestor(hWnd, GA_PARENT);
-    }
-
-    return nullptr;
-}
-
-
-std::shared_ptr<Window> WindowManager::GetCursorWindow() const
-{
-    return cursorWindow_.lock();
-}
-
-
-std::shared_ptr<Window> WindowManager::FindParentWindow(const std::shared_ptr<Window>& window) const
-{
-    std::shared_ptr<Window> parent = nullptr;
-    int minDeltaZOrder = INT_MAX;
-    int selfZOrder = window->GetZOrder();
-
-    for (const auto& pair : windows_)
-    {
-        const auto& other = pair.second;
-
-        if (other->GetId() == window->GetId()) 
-        {
-            continue;
-        }
-
-        if ((
-            other->GetWindowHandle() == window->GetParentHandle() ||
-            other->GetWindowHandle() == window->GetOwnerHandle()
-        ) || 
-        (
-            ((other->GetParentId()  == -1 || other->IsAltTab()) &&
-            other->GetProcessId() == window->GetProcessId() &&
-            other->GetThreadId()  == window->GetThreadId()) 
-        ))
-        {
-            // TODO: This is not accurate, should find the correct way to detect the parent.
-            const int zOrder = other->GetZOrder();
-            const int deltaZOrder = zOrder - selfZOrder;
-            if (deltaZOrder > 0 && deltaZOrder < minDeltaZOrder)
-            {
-                minDeltaZOrder = deltaZOrder;
-                parent = other;
-            }
-        }
-    }
-
-    return parent;
-}
-
-
-std::shared_ptr<Window> WindowManager::FindOrAddWindow(const Window::Data1 &data)
-{
-    std::scoped_lock lock(windowsListMutex_);
-
-    const auto it = std::find_if(
-        windows_.begin(),
-        windows_.end(),
-        [&](const auto& pair) 
-        { 
-            const auto& window = pair.second;
-            return data.isDesktop ?
-                (window->IsDesktop() && window->GetMonitorHandle() == data.hMonitor) :
-                (window->GetWindowHandle() == data.hWnd);
-        });
-
-    if (it != windows_.end())
-    {
-        return it->second;
-    }
-
-    const auto id = lastWindowId_++;
-    auto window = std::make_shared<Window>(id, data);
-    windows_.emplace(id, window);
-
-    return window;
-}
-
-
-void WindowManager::UpdateWindows()
-{
-    UWC_SCOPE_TIMER(UpdateWindows);
-
-    {
-        std::scoped_lock lock(windowsListMutex_);
-
-        for (const auto& pair : windows_)
-        {
-            pair.second->isAlive_ = false;
-        }
-    }
-
-    {
-        std::lock_guard<std::mutex> lock(windowsDataListMutex_);
-
-        for (auto&& data1 : windowDataList_[0])
-        {
-            auto window = FindOrAddWindow(data1);
-            if (window)
-            {
-                window->SetData(data1);
-                window->isAlive_ = true;
-
-                if (window->IsJustAdded())
-                {
-                    auto &data2 = window->data2_;
-                    const auto hWnd = window->GetWindowHandle();
-
-                    if (!window->IsDesktop())
-                    {
-                        data2.hParent = ::GetParent(hWnd);
-                        data2.hInstance = reinterpret_cast<HINSTANCE>(::GetWindowLongPtr(hWnd, GWLP_HINSTANCE));
-                        data2.threadId = ::GetWindowThreadProcessId(hWnd, &data2.processId);
-                        data2.isAltTabWindow = IsAltTabWindow(hWnd);
-                        GetWindowClassName(hWnd, data2.className);
-                        data2.isApplicationFrameWindow = IsApplicationFrameWindow(data2.className);
-                        data2.isUWP = data2.isApplicationFrameWindow || IsUWP(data2.processId);
-                        window->UpdateIsBackground();
-                    }
-                    else
-                    {
-                        data2.hParent = NULL;
-                        data2.hInstance = NULL;
-                        data2.threadId = ::GetWindowThreadProcessId(hWnd, &data2.processId);
-                        data2.isAltTabWindow = false;
-                        data2.isApplicationFrameWindow = false;
-                        data2.isUWP = false;
-                        data2.isBackground = false;
-                        data2.className = "";
-                    }
-
-                    if (auto parent = FindParentWindow(window))
-                    {
-                        window->parentId_ = parent->GetId();
-                    }
-
-                    window->InitTexture();
-                    window->UpdateTitle();
-
-                    MessageManager::Get().Add({ MessageType::WindowAdded, window->GetId(), window->GetWindowHandle() });
-                }
-                else
-                {
-                    if (window->hasTitleUpdateRequested_ || window->GetTitle().empty()) 
-                    {
-                        window->hasTitleUpdateRequested_ = false;
-                        window->UpdateTitle();
-                    }
-                    window->UpdateIsBackground();
-                }
-
-                window->UpdateFrameCount();
-            }
-        }
-    }
-
-    {
-        std::scoped_lock lock(windowsListMutex_);
-
-        for (auto it = windows_.begin(); it != windows_.end();)
-        {
-            const auto id = it->first;
-            auto& window = it->second;
-
-            if (!window->isAlive_)
-            {
-                MessageManager::Get().Add({ MessageType::WindowRemoved, id, window->GetWindowHandle() });
-                windows_.erase(it++);
-            }
-            else
-            {
-                it++;
-            }
-        }
-    }
-}
-
-
-void WindowManager::UpdateWindowHandleList()
-{
-    UWC_SCOPE_TIMER(UpdateWindowHandleList);
-
-    static const auto _EnumWindowsCallback = [](HWND hWnd, LPARAM lParam) -> BOOL
-    {
-        if (!::IsWindow(hWnd) || !::IsWindowVisible(hWnd) || ::IsHungAppWindow(hWnd))
-        {
-            return TRUE;
-        }
-
-        Window::Data1 data;
-        data.hWnd = hWnd;
-        data.hOwner = ::GetWindow(hWnd, GW_OWNER);
-        ::GetWindowRect(hWnd, &data.windowRect);
-        ::GetClientRect(hWnd, &data.clientRect);
-        data.zOrder = ::GetWindowZOrder(hWnd);
-        data.hMonitor = ::MonitorFromWindow(hWnd, MONITOR_DEFAULTTOPRIMARY);
-        data.isDesktop = false;
-
-        auto thiz = reinterpret_cast<WindowManager*>(lParam);
-        thiz->windowDataList_[1].push_back(data);
-
-        return TRUE;
-    };
-
-    using EnumWindowsCallbackType = BOOL(CALLBACK *)(HWND, LPARAM);
-    static const auto EnumWindowsCallback = static_cast<EnumWindowsCallbackType>(_EnumWindowsCallback);
-    if (!::EnumWindows(EnumWindowsCallback, reinterpret_cast<LPARAM>(this)))
-    {
-        OutputApiError(__FUNCTION__, "EnumWindows");
-    }
-
-    static const auto _EnumDisplayMonitorsCallback = [](HMONITOR hMonitor, HDC hDc, LPRECT lpRect, LPARAM lParam) -> BOOL
-    {
-        const auto hWnd = GetDesktopWindow();;
-
-        Window::Data1 data;
-        data.hWnd = hWnd;
-        data.hOwner = NULL;
-        data.windowRect = *lpRect;
-        data.clientRect = *lpRect;
-        data.zOrder = 0;
-        data.hMonitor = hMonitor;
-        data.isDesktop = true;
-
-        auto thiz = reinterpret_cast<WindowManager*>(lParam);
-        thiz->windowDataList_[1].push_back(data);
-
-        return TRUE;
-    };
-
-    using EnumDisplayMonitorsCallbackType = BOOL(CALLBACK *)(HMONITOR, HDC, LPRECT, LPARAM);
-    static const auto EnumDisplayMonitorsCallback = static_cast<EnumDisplayMonitorsCallbackType>(_EnumDisplayMonitorsCallback);
-    if (!::EnumDisplayMonitors(NULL, NULL, EnumDisplayMonitorsCallback, reinterpret_cast<LPARAM>(this)))
-    {
-        OutputApiError(__FUNCTION__, "EnumDisplayMonitors");
-    }
-
-    std::sort(
-        windowDataList_[1].begin(), 
-        windowDataList_[1].end(), 
-        [](const auto& a, const auto& b) 
-        {
-            return 
-                a.hOwner == nullptr &&
-                b.hOwner != nullptr;
-        });
-
-    {
-        std::lock_guard<std::mutex> lock(windowsDataListMutex_);
-        std::swap(windowDataList_[0], windowDataList_[1]);
-    }
-    windowDataList_[1].clear();
-
-    POINT cursorPos;
-    if (::GetCursorPos(&cursorPos))
-    {
-        cursorWindow_ = GetWindowFromPoint(cursorPos);
-    }
-}
-
-
-void WindowManager::RenderWindows()
-{
-    std::scoped_lock lock(windowsListMutex_);
-
-    for (auto&& pair : windows_)
-    {
-        pair.second->Render();
-    }
+#include <algorithm>
+#include <unordered_set>
+#include <oleacc.h>
+#include "WindowManager.h"
+#include "WindowTexture.h"
+#include "Message.h"
+#include "Util.h"
+#include "Debug.h"
+
+using namespace Microsoft::WRL;
+
+
+
+UWC_SINGLETON_INSTANCE(WindowManager)
+
+
+namespace
+{
+    class Win32WindowHandleSource : public IWindowHandleSource
+    {
+    public:
+        explicit Win32WindowHandleSource(WindowFilter& filter)
+            : filter_(filter)
+        {
+        }
+
+        void ForEachTopLevelWindow(const std::function<void(HWND, bool)>& func) override
+        {
+            static const auto _EnumWindowsCallback = [](HWND hWnd, LPARAM lParam) -> BOOL
+            {
+                const auto& func = *reinterpret_cast<const std::function<void(HWND, bool)>*>(lParam);
+                func(hWnd, ::IsWindowVisible(hWnd) != FALSE);
+                return TRUE;
+            };
+
+            using EnumWindowsCallbackType = BOOL(CALLBACK *)(HWND, LPARAM);
+            static const auto EnumWindowsCallback = static_cast<EnumWindowsCallbackType>(_EnumWindowsCallback);
+            if (!::EnumWindows(EnumWindowsCallback, reinterpret_cast<LPARAM>(&func)))
+            {
+                OutputApiError(__FUNCTION__, "EnumWindows");
+            }
+        }
+
+        bool GetWindowData(HWND hWnd, WindowHandleData& data) override
+        {
+            if (!::IsWindow(hWnd) || !::IsWindowVisible(hWnd) || ::IsHungAppWindow(hWnd))
+            {
+                return false;
+            }
+
+            // Shown events may come from windows which have been reparented since.
+            if (::GetAncestor(hWnd, GA_PARENT) != ::GetDesktopWindow())
+            {
+                return false;
+            }
+
+            data.hWnd = hWnd;
+            ::GetWindowRect(hWnd, &data.windowRect);
+
+            if (!filter_.IsMatch(hWnd, data.windowRect))
+            {
+                return false;
+            }
+
+            data.hOwner = ::GetWindow(hWnd, GW_OWNER);
+            ::GetClientRect(hWnd, &data.clientRect);
+            data.zOrder = 0;
+            data.hMonitor = ::MonitorFromWindow(hWnd, MONITOR_DEFAULTTOPRIMARY);
+            data.isDesktop = false;
+
+            // WindowFromPoint() skips cloaked windows and click-through layered windows.
+            const auto exStyle = ::GetWindowLongPtr(hWnd, GWL_EXSTYLE);
+            const bool isClickThrough = (exStyle & WS_EX_TRANSPARENT) && (exStyle & WS_EX_LAYERED);
+            data.isHitTestVisible = !isClickThrough && !IsCloakedWindow(hWnd);
+
+            return true;
+        }
+
+        void UpdateWindowRect(WindowHandleData& data) override
+        {
+            ::GetWindowRect(data.hWnd, &data.windowRect);
+            ::GetClientRect(data.hWnd, &data.clientRect);
+            data.hMonitor = ::MonitorFromWindow(data.hWnd, MONITOR_DEFAULTTOPRIMARY);
+        }
+
+        void GetDesktopData(std::vector<WindowHandleData>& dataList) override
+        {
+            static const auto _EnumDisplayMonitorsCallback = [](HMONITOR hMonitor, HDC hDc, LPRECT lpRect, LPARAM lParam) -> BOOL
+            {
+                WindowHandleData data;
+                data.hWnd = ::GetDesktopWindow();
+                data.hOwner = NULL;
+                data.windowRect = *lpRect;
+                data.clientRect = *lpRect;
+                data.zOrder = 0;
+                data.hMonitor = hMonitor;
+                data.isDesktop = true;
+                data.isHitTestVisible = TRUE;
+
+                reinterpret_cast<std::vector<WindowHandleData>*>(lParam)->push_back(data);
+
+                return TRUE;
+            };
+
+            using EnumDisplayMonitorsCallbackType = BOOL(CALLBACK *)(HMONITOR, HDC, LPRECT, LPARAM);
+            static const auto EnumDisplayMonitorsCallback = static_cast<EnumDisplayMonitorsCallbackType>(_EnumDisplayMonitorsCallback);
+            if (!::EnumDisplayMonitors(NULL, NULL, EnumDisplayMonitorsCallback, reinterpret_cast<LPARAM>(&dataList)))
+            {
+                OutputApiError(__FUNCTION__, "EnumDisplayMonitors");
+            }
+        }
+
+    private:
+        WindowFilter& filter_;
+    };
+}
+
+
+
+void WindowManager::Initialize(const WindowFilter::Settings& filterSettings)
+{
+    {
+        UWC_SCOPE_TIMER(InitWindowsGraphicsCaptureManager);
+        windowsGraphicsCaptureManager_ = std::make_unique<WindowsGraphicsCaptureManager>();
+    }
+    {
+        UWC_SCOPE_TIMER(InitUploadManager);
+        uploadManager_ = std::make_unique<UploadManager>();
+    }
+    {
+        UWC_SCOPE_TIMER(InitCaptureManager);
+        captureManager_ = std::make_unique<CaptureManager>();
+    }
+    {
+        UWC_SCOPE_TIMER(Cursor);
+        cursor_ = std::make_unique<Cursor>();
+    }
+    {
+        UWC_SCOPE_TIMER(InitWindowFilter);
+        windowFilter_ = std::make_unique<WindowFilter>();
+        windowFilter_->Set(filterSettings);
+    }
+    {
+        UWC_SCOPE_TIMER(InitWindowTitleManager);
+        windowTitleManager_ = std::make_unique<WindowTitleManager>();
+    }
+    {
+        UWC_SCOPE_TIMER(StartThread);
+        StartWindowHandleListThread();
+    }
+}
+
+
+void WindowManager::Finalize()
+{
+    StopWindowHandleListThread();
+    windowTitleManager_.reset();
+    windowFilter_.reset();
+    cursor_.reset();
+    captureManager_.reset();
+    uploadManager_.reset();
+    windowsGraphicsCaptureManager_.reset();
+    renderQueue_.Clear();
+    {
+        std::scoped_lock lock(windowsListMutex_);
+        windows_.clear();
+        windowsByHandle_.clear();
+    }
+    windowEntries_.clear();
+    spatialIndexChangedWindows_.clear();
+    spatialIndexRemovedIds_.clear();
+    std::atomic_store(&spatialIndex_, std::shared_ptr<const WindowSpatialIndex>());
+    snapshotPublisher_.Clear();
+}
+
+
+void WindowManager::Update(float)
+{
+    // WGC sessions are driven by timestamps on the capture thread.
+}
+
+
+void WindowManager::Render()
+{
+    UWC_SCOPE_TIMER(RenderEvent)
+
+    RenderWindows();
+    cursor_->Render();
+}
+
+
+void WindowManager::StartWindowHandleListThread()
+{
+    // Without the hook, the window list falls back to full enumeration on every update.
+    if (!windowEventHook_.Start())
+    {
+        UWC_ERROR(__FUNCTION__, " => Failed to start the window event hook.");
+    }
+
+    windowHandleListThreadLoop_.Start([this]
+    {
+        UpdateWindowHandleList();
+        UpdateWindows();
+        PublishSnapshot();
+        PostPendingMessages();
+        UpdateSpatialIndex();
+        UpdateCursorWindow();
+    }, std::chrono::milliseconds(16));
+}
+
+
+void WindowManager::StopWindowHandleListThread()
+{
+    windowHandleListThreadLoop_.Stop();
+    windowEventHook_.Stop();
+}
+
+
+const std::unique_ptr<CaptureManager>& WindowManager::GetCaptureManager()
+{
+    return WindowManager::Get().captureManager_;
+}
+
+
+const std::unique_ptr<UploadManager>& WindowManager::GetUploadManager()
+{
+    return WindowManager::Get().uploadManager_;
+}
+
+
+const std::unique_ptr<WindowsGraphicsCaptureManager>& WindowManager::GetWindowsGraphicsCaptureManager()
+{
+    return WindowManager::Get().windowsGraphicsCaptureManager_;
+}
+
+
+const std::unique_ptr<Cursor>& WindowManager::GetCursor()
+{
+    return WindowManager::Get().cursor_;
+}
+
+
+const std::unique_ptr<WindowTitleManager>& WindowManager::GetWindowTitleManager()
+{
+    return WindowManager::Get().windowTitleManager_;
+}
+
+
+const std::unique_ptr<WindowFilter>& WindowManager::GetWindowFilter()
+{
+    return WindowManager::Get().windowFilter_;
+}
+
+
+bool WindowManager::CheckExistence(int id) const
+{
+    const WindowSnapshotPublisher::ReadGuard guard(snapshotPublisher_);
+    const auto list = guard.Get();
+    return list && list->Find(id);
+}
+
+
+bool WindowManager::GetWindowSnapshot(int id, WindowSnapshot& snapshot) const
+{
+    // Copy the entry since the list can be deleted after the guard is released.
+    const WindowSnapshotPublisher::ReadGuard guard(snapshotPublisher_);
+    const auto list = guard.Get();
+    if (!list) return false;
+
+    const auto window = list->Find(id);
+    if (!window) return false;
+
+    snapshot = *window;
+    return true;
+}
+
+
+UINT WindowManager::CopyWindowInfos(WindowInfo* buffer, UINT capacity)
+{
+    return snapshotPublisher_.CopyWindowInfos(buffer, capacity);
+}
+
+
+std::shared_ptr<Window> WindowManager::GetWindow(int id) const
+{
+    std::scoped_lock lock(windowsListMutex_);
+
+    auto it = windows_.find(id);
+    if (it == windows_.end())
+    {
+        return nullptr;
+    }
+
+    return it->second;
+}
+
+
+std::shared_ptr<Window> WindowManager::GetWindowFromPoint(POINT point) const
+{
+    if (const auto index = std::atomic_load(&spatialIndex_))
+    {
+        return index->Find(point);
+    }
+
+    return nullptr;
+}
+
+
+std::shared_ptr<Window> WindowManager::GetCursorWindow() const
+{
+    return cursorWindow_.lock();
+}
+
+
+UINT64 WindowManager::GetThreadWindowKey(DWORD processId, DWORD threadId)
+{
+    return (static_cast<UINT64>(processId) << 32) | threadId;
+}
+
+
+void WindowManager::BuildThreadWindowIndex()
+{
+    // Run this scope in the window handle list thread, which is the only writer of windows_.
+
+    windowsByThread_.clear();
+
+    for (const auto& pair : windows_)
+    {
+        const auto& window = pair.second;
+        const auto key = GetThreadWindowKey(window->GetProcessId(), window->GetThreadId());
+        windowsByThread_[key].push_back(window);
+    }
+
+    for (auto&& pair : windowsByThread_)
+    {
+        auto& windows = pair.second;
+        std::sort(
+            windows.begin(), 
+            windows.end(), 
+            [](const auto& a, const auto& b)
+            {
+                return static_cast<int>(a->GetZOrder()) < static_cast<int>(b->GetZOrder());
+            });
+    }
+}
+
+
+std::shared_ptr<Window> WindowManager::FindParentWindow(const std::shared_ptr<Window>& window) const
+{
+    std::shared_ptr<Window> parent = nullptr;
+    int minDeltaZOrder = INT_MAX;
+    const int selfZOrder = window->GetZOrder();
+
+    // TODO: This is not accurate, should find the correct way to detect the parent.
+    const auto selectIfNearest = [&](const std::shared_ptr<Window>& other)
+    {
+        if (other->GetId() == window->GetId()) return;
+
+        const int deltaZOrder = static_cast<int>(other->GetZOrder()) - selfZOrder;
+        if (deltaZOrder > 0 && deltaZOrder < minDeltaZOrder)
+        {
+            minDeltaZOrder = deltaZOrder;
+            parent = other;
+        }
+    };
+
+    // Windows whose handle is the parent or owner handle
+    for (const auto hWnd : { window->GetParentHandle(), window->GetOwnerHandle() })
+    {
+        if (hWnd == NULL) continue;
+
+        const auto it = windowsByHandle_.find(hWnd);
+        if (it != windowsByHandle_.end())
+        {
+            selectIfNearest(it->second);
+        }
+    }
+
+    // The nearest root or alt-tab window above in the same process and thread
+    const auto it = windowsByThread_.find(GetThreadWindowKey(window->GetProcessId(), window->GetThreadId()));
+    if (it != windowsByThread_.end())
+    {
+        const auto& windows = it->second;
+        auto other = std::upper_bound(
+            windows.begin(), 
+            windows.end(), 
+            selfZOrder, 
+            [](int zOrder, const auto& w)
+            {
+                return zOrder < static_cast<int>(w->GetZOrder());
+            });
+
+        for (; other != windows.end(); ++other)
+        {
+            const auto& candidate = *other;
+            if (static_cast<int>(candidate->GetZOrder()) - selfZOrder >= minDeltaZOrder) break;
+
+            if (candidate->GetParentId() == -1 || candidate->IsAltTab())
+            {
+                selectIfNearest(candidate);
+                break;
+            }
+        }
+    }
+
+    return parent;
+}
+
+
+std::shared_ptr<Window> WindowManager::CreateNewWindow(const Window::Data1& data)
+{
+    // Run this scope in the window handle list thread.
+
+    auto window = std::make_shared<Window>(lastWindowId_++, data);
+    auto &data2 = window->data2_;
+    const auto hWnd = window->GetWindowHandle();
+
+    if (!window->IsDesktop())
+    {
+        data2.hParent = ::GetParent(hWnd);
+        data2.hInstance = reinterpret_cast<HINSTANCE>(::GetWindowLongPtr(hWnd, GWLP_HINSTANCE));
+        data2.threadId = ::GetWindowThreadProcessId(hWnd, &data2.processId);
+        data2.isAltTabWindow = IsAltTabWindow(hWnd);
+        GetWindowClassName(hWnd, data2.className);
+        data2.isApplicationFrameWindow = IsApplicationFrameWindow(data2.className);
+        data2.isUWP = data2.isApplicationFrameWindow || IsUWP(data2.processId);
+        window->UpdateIsBackground();
+    }
+    else
+    {
+        data2.hParent = NULL;
+        data2.hInstance = NULL;
+        data2.threadId = ::GetWindowThreadProcessId(hWnd, &data2.processId);
+        data2.isAltTabWindow = false;
+        data2.isApplicationFrameWindow = false;
+        data2.isUWP = false;
+        data2.isBackground = false;
+        data2.className = "";
+    }
+
+    return window;
+}
+
+
+void WindowManager::UpdateWindows()
+{
+    UWC_SCOPE_TIMER(UpdateWindows);
+
+    // Both windowEntries_ and windowDataList_[0] are sorted by IsWindowHandleDataOrderedBefore(),
+    // so added, removed and changed windows are found by a single linear merge and only
+    // those touch windows_.
+    std::vector<std::shared_ptr<Window>> addedWindows;
+    std::vector<std::shared_ptr<Window>> removedWindows;
+    std::vector<std::shared_ptr<Window>> reownedWindows;
+
+    const auto updateEntry = [&](WindowEntry& entry, const Window::Data1& data, bool isRenamed)
+    {
+        auto& window = entry.window;
+        const auto& prev = entry.data;
+
+        const bool isMoved = 
+            prev.windowRect.left != data.windowRect.left || 
+            prev.windowRect.top != data.windowRect.top;
+        const bool isResized = 
+            prev.windowRect.right - prev.windowRect.left != data.windowRect.right - data.windowRect.left ||
+            prev.windowRect.bottom - prev.windowRect.top != data.windowRect.bottom - data.windowRect.top ||
+            !::EqualRect(&prev.clientRect, &data.clientRect);
+        const bool isZOrderChanged = prev.zOrder != data.zOrder;
+        const bool isOwnerChanged = prev.hOwner != data.hOwner;
+        const bool isHitTestChanged = prev.isHitTestVisible != data.isHitTestVisible;
+
+        if (isMoved || isResized || isZOrderChanged || isOwnerChanged || isHitTestChanged || prev.hMonitor != data.hMonitor)
+        {
+            window->SetData(data);
+            entry.data = data;
+        }
+
+        if (isMoved || isResized || isZOrderChanged || isHitTestChanged)
+        {
+            spatialIndexChangedWindows_.push_back(window);
+        }
+
+        const auto id = window->GetId();
+        const auto hWnd = window->GetWindowHandle();
+        if (isMoved) pendingMessages_.push_back({ MessageType::WindowMoved, id, hWnd });
+        if (isResized) pendingMessages_.push_back({ MessageType::WindowResized, id, hWnd });
+        if (isZOrderChanged) pendingMessages_.push_back({ MessageType::WindowZOrderChanged, id, hWnd });
+
+        if (isOwnerChanged)
+        {
+            if (!window->IsDesktop())
+            {
+                window->data2_.hParent = ::GetParent(hWnd);
+            }
+            reownedWindows.push_back(window);
+        }
+
+        const bool isTitleUpdateRequested = window->hasTitleUpdateRequested_.exchange(false) || isRenamed;
+        if (isTitleUpdateRequested || window->GetTitle().empty()) 
+        {
+            window->UpdateTitle(isTitleUpdateRequested);
+        }
+        window->UpdateIsBackground();
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(windowsDataListMutex_);
+
+        const std::unordered_set<HWND> renamedWindowHandles(
+            renamedWindowHandles_.begin(), 
+            renamedWindowHandles_.end());
+        renamedWindowHandles_.clear();
+
+        windowEntries_ = MergeWindowHandleData(
+            std::move(windowEntries_),
+            windowDataList_[0],
+            [&](WindowEntry& entry)
+            {
+                removedWindows.push_back(std::move(entry.window));
+            },
+            [&](const Window::Data1& data)
+            {
+                auto window = CreateNewWindow(data);
+                addedWindows.push_back(window);
+                return WindowEntry { data, std::move(window) };
+            },
+            [&](WindowEntry& entry, const Window::Data1& data)
+            {
+                const bool isRenamed = 
+                    !renamedWindowHandles.empty() && 
+                    renamedWindowHandles.find(data.hWnd) != renamedWindowHandles.end();
+                updateEntry(entry, data, isRenamed);
+            });
+    }
+
+    if (!addedWindows.empty())
+    {
+        std::scoped_lock lock(windowsListMutex_);
+
+        for (const auto& window : addedWindows)
+        {
+            windows_.emplace(window->GetId(), window);
+            if (!window->IsDesktop())
+            {
+                windowsByHandle_.emplace(window->GetWindowHandle(), window);
+            }
+        }
+
+        spatialIndexChangedWindows_.insert(
+            spatialIndexChangedWindows_.end(), 
+            addedWindows.begin(), 
+            addedWindows.end());
+    }
+
+    // Resolve parents after all windows have their latest z-order.
+    if (!addedWindows.empty() || !reownedWindows.empty())
+    {
+        BuildThreadWindowIndex();
+
+        for (const auto& window : reownedWindows)
+        {
+            const auto parent = FindParentWindow(window);
+            window->parentId_ = parent ? parent->GetId() : -1;
+        }
+
+        for (const auto& window : addedWindows)
+        {
+            if (auto parent = FindParentWindow(window))
+            {
+                window->parentId_ = parent->GetId();
+            }
+
+            window->InitTexture();
+            window->UpdateTitle(true);
+
+            pendingMessages_.push_back({ MessageType::WindowAdded, window->GetId(), window->GetWindowHandle() });
+        }
+
+        windowsByThread_.clear();
+    }
+
+    for (auto&& result : windowTitleManager_->TakeResults())
+    {
+        const auto it = windows_.find(result.windowId);
+        if (it != windows_.end())
+        {
+            it->second->SetTitle(result.title);
+        }
+    }
+
+    if (!removedWindows.empty())
+    {
+        {
+            std::scoped_lock lock(windowsListMutex_);
+
+            for (const auto& window : removedWindows)
+            {
+                windows_.erase(window->GetId());
+                if (!window->IsDesktop())
+                {
+                    windowsByHandle_.erase(window->GetWindowHandle());
+                }
+            }
+        }
+
+        for (const auto& window : removedWindows)
+        {
+            const auto id = window->GetId();
+            pendingMessages_.push_back({ MessageType::WindowRemoved, id, window->GetWindowHandle() });
+            captureManager_->OnWindowRemoved(id);
+            windowTitleManager_->OnWindowRemoved(id);
+            spatialIndexRemovedIds_.push_back(id);
+        }
+    }
+}
+
+
+void WindowManager::UpdateWindowHandleList()
+{
+    UWC_SCOPE_TIMER(UpdateWindowHandleList);
+
+    // Created, destroyed, shown, hidden and reordered windows are applied incrementally,
+    // so the full enumeration only recovers from events which were missed.
+    constexpr INT64 fullUpdateInterval = 5'000'000; // [us]
+
+    // Windows accepted or rejected by the previous filter are re-evaluated by a full enumeration.
+    if (windowFilter_->ConsumeChanged())
+    {
+        windowEventTracker_.RequestFullUpdate();
+    }
+
+    const auto changes = windowEventTracker_.Consume(GetTimestampInMicroseconds(), fullUpdateInterval);
+
+    if (changes.needsFullUpdate || !windowEventHook_.IsActive())
+    {
+        EnumerateWindowHandleList();
+    }
+    else if (changes.HasWindowListChanges())
+    {
+        UpdateChangedWindowData(changes);
+    }
+
+    if (!changes.renamedWindows.empty())
+    {
+        std::lock_guard<std::mutex> lock(windowsDataListMutex_);
+        renamedWindowHandles_.insert(
+            renamedWindowHandles_.end(), 
+            changes.renamedWindows.begin(), 
+            changes.renamedWindows.end());
+    }
+}
+
+
+void WindowManager::PublishSnapshot()
+{
+    // Run this scope in the window handle list thread, which is the only writer of windows_.
+
+    UWC_SCOPE_TIMER(PublishSnapshot)
+
+    std::vector<WindowSnapshot> windows;
+    windows.reserve(windows_.size());
+
+    for (const auto& pair : windows_)
+    {
+        windows.push_back(pair.second->GetSnapshot());
+    }
+
+    snapshotPublisher_.Publish(std::move(windows));
+}
+
+
+void WindowManager::PostPendingMessages()
+{
+    // Run this scope after PublishSnapshot() so that a message handler
+    // querying the window always finds the state the message describes.
+
+    for (const auto& message : pendingMessages_)
+    {
+        MessageManager::Get().Add(message);
+    }
+    pendingMessages_.clear();
+}
+
+
+void WindowManager::UpdateSpatialIndex()
+{
+    // Run this scope in the window handle list thread, which is the only writer of windows_.
+
+    if (spatialIndexChangedWindows_.empty() && spatialIndexRemovedIds_.empty()) return;
+
+    UWC_SCOPE_TIMER(UpdateSpatialIndex);
+
+    std::vector<WindowSpatialIndex::Entry> changedEntries;
+    changedEntries.reserve(spatialIndexChangedWindows_.size());
+
+    for (const auto& window : spatialIndexChangedWindows_)
+    {
+        // Windows which turned click-through or cloaked leave the index.
+        if (!window->IsHitTestVisible())
+        {
+            spatialIndexRemovedIds_.push_back(window->GetId());
+            continue;
+        }
+
+        changedEntries.push_back({
+            window->GetId(),
+            window->GetWindowRect(),
+            window->GetZOrder(),
+            window->IsDesktop(),
+            window });
+    }
+    spatialIndexChangedWindows_.clear();
+
+    const auto prevIndex = std::atomic_load(&spatialIndex_);
+    auto index = prevIndex ? 
+        std::make_shared<WindowSpatialIndex>(*prevIndex, std::move(changedEntries), spatialIndexRemovedIds_) :
+        std::make_shared<WindowSpatialIndex>(std::move(changedEntries));
+    spatialIndexRemovedIds_.clear();
+
+    std::atomic_store(&spatialIndex_, std::shared_ptr<const WindowSpatialIndex>(std::move(index)));
+}
+
+
+void WindowManager::UpdateCursorWindow()
+{
+    UWC_SCOPE_TIMER(UpdateCursorWindow)
+
+    POINT cursorPos;
+    if (::GetCursorPos(&cursorPos))
+    {
+        cursorWindow_ = GetWindowFromPoint(cursorPos);
+    }
+}
+
+
+void WindowManager::UpdateChangedWindowData(const WindowEventTracker::Changes& changes)
+{
+    UWC_SCOPE_TIMER(UpdateChangedWindowData);
+
+    {
+        std::lock_guard<std::mutex> lock(windowsDataListMutex_);
+        windowDataList_[1] = windowDataList_[0];
+    }
+
+    Win32WindowHandleSource source(*windowFilter_);
+    ApplyWindowChanges(source, changes, windowDataList_[1]);
+
+    {
+        std::lock_guard<std::mutex> lock(windowsDataListMutex_);
+        std::swap(windowDataList_[0], windowDataList_[1]);
+    }
+    windowDataList_[1].clear();
+}
+
+
+void WindowManager::EnumerateWindowHandleList()
+{
+    UWC_SCOPE_TIMER(EnumerateWindowHandleList);
+
+    Win32WindowHandleSource source(*windowFilter_);
+    windowFilter_->BeginEnumeration();
+    EnumerateWindowHandleData(source, windowDataList_[1]);
+    windowFilter_->EndEnumeration();
+
+    {
+        std::lock_guard<std::mutex> lock(windowsDataListMutex_);
+        std::swap(windowDataList_[0], windowDataList_[1]);
+    }
+    windowDataList_[1].clear();
+}
+
+
+void WindowManager::RequestRender(const std::shared_ptr<Window>& window)
+{
+    // Skip if the window is already waiting for the next render.
+    if (window->isRenderRequested_.exchange(true)) return;
+
+    renderQueue_.Push(window);
+}
+
+
+void WindowManager::RenderWindows()
+{
+    renderQueue_.Drain([](const std::shared_ptr<Window>& window)
+    {
+        window->isRenderRequested_ = false;
+        window->Render();
+    });
 }
\ No newline at end of file
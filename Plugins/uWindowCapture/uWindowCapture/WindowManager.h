@@ -1,63 +1,106 @@
-#pragma once
-
-#include <Windows.h>
-#include <map>
-#include <vector>
-#include <deque>
-#include <memory>
-#include <mutex>
-
-#include "Singleton.h"
-#include "Thread.h"
-#include "CaptureManager.h"
-#include "UploadManager.h"
-#include "WindowsGraphicsCapture.h"
-#include "Window.h"
-#include "Cursor.h"
-
-
-class WindowManager
-{
-    UWC_SINGLETON(WindowManager)
-
-public:
-    void Initialize();
-    void Finalize();
-    void Update(float dt);
-    void Render();
-    bool CheckExistence(int id) const;
-    std::shared_ptr<Window> GetWindow(int id) const;
-    std::shared_ptr<Window> GetWindowFromPoint(POINT point) const;
-    std::shared_ptr<Window> GetCursorWindow() const;
-
-    static const std::unique_ptr<CaptureManager>& GetCaptureManager();
-    static const std::unique_ptr<UploadManager>& GetUploadManager();
-    static const std::unique_ptr<WindowsGraphicsCaptureManager>& GetWindowsGraphicsCaptureManager();
-    static const std::unique_ptr<Cursor>& GetCursor();
-
-private:
-    std::shared_ptr<Window> FindParentWindow(const std::shared_ptr<Window>& window) const;
-    std::shared_ptr<Window> FindOrAddWindow(const Window::Data1 &data);
-
-    void StartWindowHandleListThread();
-    void StopWindowHandleListThread();
-    void UpdateWindowHandleList();
-    void UpdateWindows();
-    void RenderWindows();
-
-    std::unique_ptr<CaptureManager> captureManager_;
-    std::unique_ptr<UploadManager> uploadManager_;
-    std::unique_ptr<WindowsGraphicsCaptureManager> windowsGraphicsCaptureManager_;
-    std::unique_ptr<Cursor> cursor_;
-
-    std::map<int, std::shared_ptr<Window>> windows_;
-    int lastWindowId_ = 0;
-    std::weak_ptr<Window> cursorWindow_;
-    mutable std::mutex windowsListMutex_;
-
-    ThreadLoop windowHandleListThreadLoop_ = { L"uWindowCapture - Window Handle List Thread" };
-
-    std::vector<Window::Data1> windowDataList_[2];
-    mutable std::mutex windowsDataListMutex_;
-};
-
+#pragma once
+
+#include <Windows.h>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "Singleton.h"
+#include "Thread.h"
+#include "CaptureManager.h"
+#include "UploadManager.h"
+#include "WindowsGraphicsCapture.h"
+#include "WindowRenderQueue.h"
+#include "WindowEvent.h"
+#include "WindowSpatialIndex.h"
+#include "WindowSnapshot.h"
+#include "WindowTitleManager.h"
+#include "WindowFilter.h"
+#include "Message.h"
+#include "Window.h"
+#include "Cursor.h"
+
+
+class WindowManager
+{
+    UWC_SINGLETON(WindowManager)
+
+public:
+    // The filter is applied before the first enumeration starts.
+    void Initialize(const WindowFilter::Settings& filterSettings);
+    void Finalize();
+    void Update(float dt);
+    void Render();
+    bool CheckExistence(int id) const;
+    std::shared_ptr<Window> GetWindow(int id) const;
+    bool GetWindowSnapshot(int id, WindowSnapshot& snapshot) const;
+    UINT CopyWindowInfos(WindowInfo* buffer, UINT capacity);
+    std::shared_ptr<Window> GetWindowFromPoint(POINT point) const;
+    std::shared_ptr<Window> GetCursorWindow() const;
+    void RequestRender(const std::shared_ptr<Window>& window);
+
+    static const std::unique_ptr<CaptureManager>& GetCaptureManager();
+    static const std::unique_ptr<UploadManager>& GetUploadManager();
+    static const std::unique_ptr<WindowsGraphicsCaptureManager>& GetWindowsGraphicsCaptureManager();
+    static const std::unique_ptr<Cursor>& GetCursor();
+    static const std::unique_ptr<WindowTitleManager>& GetWindowTitleManager();
+    static const std::unique_ptr<WindowFilter>& GetWindowFilter();
+
+private:
+    static UINT64 GetThreadWindowKey(DWORD processId, DWORD threadId);
+    void BuildThreadWindowIndex();
+    std::shared_ptr<Window> FindParentWindow(const std::shared_ptr<Window>& window) const;
+    std::shared_ptr<Window> CreateNewWindow(const Window::Data1& data);
+
+    void StartWindowHandleListThread();
+    void StopWindowHandleListThread();
+    void UpdateWindowHandleList();
+    void EnumerateWindowHandleList();
+    void UpdateChangedWindowData(const WindowEventTracker::Changes& changes);
+    void UpdateWindows();
+    void UpdateSpatialIndex();
+    void PublishSnapshot();
+    void PostPendingMessages();
+    void UpdateCursorWindow();
+    void RenderWindows();
+
+    std::unique_ptr<CaptureManager> captureManager_;
+    std::unique_ptr<UploadManager> uploadManager_;
+    std::unique_ptr<WindowsGraphicsCaptureManager> windowsGraphicsCaptureManager_;
+    std::unique_ptr<Cursor> cursor_;
+    std::unique_ptr<WindowTitleManager> windowTitleManager_;
+    std::unique_ptr<WindowFilter> windowFilter_;
+
+    std::map<int, std::shared_ptr<Window>> windows_;
+    std::unordered_map<HWND, std::shared_ptr<Window>> windowsByHandle_;
+    std::unordered_map<UINT64, std::vector<std::shared_ptr<Window>>> windowsByThread_;
+    int lastWindowId_ = 0;
+    std::weak_ptr<Window> cursorWindow_;
+    std::shared_ptr<const WindowSpatialIndex> spatialIndex_;
+    WindowSnapshotPublisher snapshotPublisher_;
+    std::vector<Message> pendingMessages_;
+    std::vector<std::shared_ptr<Window>> spatialIndexChangedWindows_;
+    std::vector<int> spatialIndexRemovedIds_;
+    mutable std::mutex windowsListMutex_;
+    WindowRenderQueue renderQueue_;
+
+    ThreadLoop windowHandleListThreadLoop_ = { L"uWindowCapture - Window Handle List Thread" };
+
+    struct WindowEntry
+    {
+        Window::Data1 data;
+        std::shared_ptr<Window> window;
+    };
+    std::vector<WindowEntry> windowEntries_;
+
+    std::vector<Window::Data1> windowDataList_[2];
+    std::vector<HWND> renamedWindowHandles_;
+    mutable std::mutex windowsDataListMutex_;
+
+    WindowEventTracker windowEventTracker_;
+    WindowEventHook windowEventHook_ { windowEventTracker_ };
+};
+
@@ -0,0 +1,21 @@
+#include "WindowRenderQueue.h"
+
+
+
+WindowRenderQueue::~WindowRenderQueue()
+{
+    Clear();
+}
+
+
+void WindowRenderQueue::Push(const std::shared_ptr<Window>& window)
+{
+    auto node = new Node { window, head_.load(std::memory_order_relaxed) };
+    while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed));
+}
+
+
+void WindowRenderQueue::Clear()
+{
+    Drain([](const std::shared_ptr<Window>&) {});
+}
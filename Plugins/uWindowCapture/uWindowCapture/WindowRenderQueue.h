@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <atomic>
+
+
+class Window;
+
+
+// Lock-free multi-producer / single-consumer list of windows that have new
+// textures to render. Producers push from the upload thread and the render
+// thread takes the whole list at once, so neither touches the window map.
+class WindowRenderQueue
+{
+public:
+    WindowRenderQueue() = default;
+    ~WindowRenderQueue();
+    WindowRenderQueue(const WindowRenderQueue&) = delete;
+    WindowRenderQueue& operator=(const WindowRenderQueue&) = delete;
+
+    void Push(const std::shared_ptr<Window>& window);
+
+    template <class Func>
+    void Drain(Func&& func)
+    {
+        auto node = head_.exchange(nullptr, std::memory_order_acquire);
+        while (node)
+        {
+            if (auto window = node->window.lock())
+            {
+                func(window);
+            }
+            const auto next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    void Clear();
+
+private:
+    struct Node
+    {
+        std::weak_ptr<Window> window;
+        Node* next = nullptr;
+    };
+
+    std::atomic<Node*> head_ = nullptr;
+};
@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <memory>
+#include "WindowSnapshot.h"
+
+
+
+namespace
+{
+    std::atomic<UINT64> g_lastPublisherId = 0;
+
+
+    bool IsSameSize(const RECT& a, const RECT& b)
+    {
+        return
+            a.right - a.left == b.right - b.left &&
+            a.bottom - a.top == b.bottom - b.top;
+    }
+}
+
+
+UINT WindowSnapshot::GetDirtyFlags(const WindowSnapshot* previous) const
+{
+    if (!previous) return static_cast<UINT>(WindowInfoDirtyFlags::Added);
+
+    UINT flags = 0;
+    if (windowRect.left != previous->windowRect.left || windowRect.top != previous->windowRect.top)
+    {
+        flags |= static_cast<UINT>(WindowInfoDirtyFlags::Moved);
+    }
+    if (!IsSameSize(windowRect, previous->windowRect))
+    {
+        flags |= static_cast<UINT>(WindowInfoDirtyFlags::Resized);
+    }
+    if (zOrder != previous->zOrder)
+    {
+        flags |= static_cast<UINT>(WindowInfoDirtyFlags::ZOrderChanged);
+    }
+    if (parentId != previous->parentId)
+    {
+        flags |= static_cast<UINT>(WindowInfoDirtyFlags::ParentChanged);
+    }
+    if (textureWidth != previous->textureWidth || textureHeight != previous->textureHeight)
+    {
+        flags |= static_cast<UINT>(WindowInfoDirtyFlags::TextureSizeChanged);
+    }
+    if (frameId != previous->frameId)
+    {
+        flags |= static_cast<UINT>(WindowInfoDirtyFlags::FrameUpdated);
+    }
+    return flags;
+}
+
+
+WindowInfo WindowSnapshot::ToWindowInfo() const
+{
+    UINT flags = 0;
+    if (isDesktop) flags |= static_cast<UINT>(WindowInfoFlags::Desktop);
+    if (isAltTabWindow) flags |= static_cast<UINT>(WindowInfoFlags::AltTabWindow);
+    if (isApplicationFrameWindow) flags |= static_cast<UINT>(WindowInfoFlags::ApplicationFrameWindow);
+    if (isUWP) flags |= static_cast<UINT>(WindowInfoFlags::UWP);
+    if (isBackground) flags |= static_cast<UINT>(WindowInfoFlags::Background);
+
+    WindowInfo info;
+    info.id = id;
+    info.parentId = parentId;
+    info.x = windowRect.left;
+    info.y = windowRect.top;
+    info.width = windowRect.right - windowRect.left;
+    info.height = windowRect.bottom - windowRect.top;
+    info.zOrder = zOrder;
+    info.flags = flags;
+    info.dirtyFlags = 0;
+    info.textureWidth = textureWidth;
+    info.textureHeight = textureHeight;
+    info.textureOffsetX = textureOffsetX;
+    info.textureOffsetY = textureOffsetY;
+    info.processId = processId;
+    info.frameId = frameId;
+    return info;
+}
+
+
+WindowListSnapshot::WindowListSnapshot(std::vector<WindowSnapshot>&& windows)
+    : windows_(std::move(windows))
+{
+    std::sort(
+        windows_.begin(),
+        windows_.end(),
+        [](const WindowSnapshot& a, const WindowSnapshot& b)
+        {
+            return a.id < b.id;
+        });
+}
+
+
+const WindowSnapshot* WindowListSnapshot::Find(int id) const
+{
+    const auto it = std::lower_bound(
+        windows_.begin(),
+        windows_.end(),
+        id,
+        [](const WindowSnapshot& window, int id)
+        {
+            return window.id < id;
+        });
+
+    if (it == windows_.end() || it->id != id) return nullptr;
+
+    return &*it;
+}
+
+
+UINT WindowListSnapshot::CopyWindowInfos(WindowInfo* buffer, UINT capacity) const
+{
+    const auto count = static_cast<UINT>(windows_.size());
+    if (!buffer) return count;
+
+    const auto n = (std::min)(count, capacity);
+    for (UINT i = 0; i < n; ++i)
+    {
+        buffer[i] = windows_[i].ToWindowInfo();
+    }
+
+    return count;
+}
+
+
+WindowSnapshotPublisher::ReadGuard::ReadGuard(const WindowSnapshotPublisher& publisher)
+    : slot_(publisher.GetReaderSlot())
+{
+    // The epoch is pinned before the pointer is loaded, so a snapshot loaded here
+    // was replaced in this epoch or later and is not deleted while pinned.
+    if (slot_->depth++ == 0)
+    {
+        slot_->epoch.store(publisher.epoch_.load());
+    }
+    snapshot_ = publisher.current_.load();
+}
+
+
+WindowSnapshotPublisher::ReadGuard::~ReadGuard()
+{
+    if (--slot_->depth == 0)
+    {
+        slot_->epoch.store(0);
+    }
+}
+
+
+WindowSnapshotPublisher::WindowSnapshotPublisher()
+    : id_(++g_lastPublisherId)
+{
+}
+
+
+WindowSnapshotPublisher::~WindowSnapshotPublisher()
+{
+    // No reader remains at destruction.
+    delete current_.load();
+    for (const auto& retired : retiredSnapshots_)
+    {
+        delete retired.first;
+    }
+}
+
+
+WindowSnapshotPublisher::ReaderSlot* WindowSnapshotPublisher::GetReaderSlot() const
+{
+    thread_local std::vector<std::pair<UINT64, ReaderSlot*>> slots;
+
+    for (const auto& slot : slots)
+    {
+        if (slot.first == id_) return slot.second;
+    }
+
+    ReaderSlot* slot = nullptr;
+    {
+        std::scoped_lock lock(readerSlotsMutex_);
+        slot = &readerSlots_.emplace_back();
+    }
+    slots.emplace_back(id_, slot);
+
+    return slot;
+}
+
+
+void WindowSnapshotPublisher::Replace(const WindowListSnapshot* snapshot)
+{
+    const auto previous = current_.exchange(snapshot);
+    if (previous)
+    {
+        // Readers which may have loaded previous pinned an epoch before this increment.
+        retiredSnapshots_.emplace_back(previous, epoch_.fetch_add(1) + 1);
+    }
+
+    Reclaim();
+}
+
+
+void WindowSnapshotPublisher::Reclaim()
+{
+    if (retiredSnapshots_.empty()) return;
+
+    UINT64 minEpoch = UINT64_MAX;
+    {
+        std::scoped_lock lock(readerSlotsMutex_);
+        for (const auto& slot : readerSlots_)
+        {
+            const auto epoch = slot.epoch.load();
+            if (epoch != 0) minEpoch = (std::min)(minEpoch, epoch);
+        }
+    }
+
+    auto it = std::remove_if(retiredSnapshots_.begin(), retiredSnapshots_.end(), [&](const auto& retired)
+    {
+        if (retired.second > minEpoch) return false;
+        delete retired.first;
+        return true;
+    });
+    retiredSnapshots_.erase(it, retiredSnapshots_.end());
+}
+
+
+void WindowSnapshotPublisher::Publish(std::vector<WindowSnapshot>&& windows)
+{
+    auto snapshot = std::make_unique<const WindowListSnapshot>(std::move(windows));
+
+    // Only this thread replaces the snapshot, so the current one cannot be deleted here.
+    const auto previous = current_.load();
+
+    std::vector<std::pair<int, UINT>> changes;
+    for (const auto& window : snapshot->GetWindows())
+    {
+        const auto flags = window.GetDirtyFlags(previous ? previous->Find(window.id) : nullptr);
+        if (flags != 0)
+        {
+            changes.emplace_back(window.id, flags);
+        }
+    }
+
+    // Swap the snapshot together with its flags so that the consumer never
+    // reads flags which describe a snapshot it cannot see yet.
+    std::scoped_lock lock(dirtyFlagsMutex_);
+
+    for (const auto& change : changes)
+    {
+        dirtyFlags_[change.first] |= change.second;
+    }
+
+    for (auto it = dirtyFlags_.begin(); it != dirtyFlags_.end();)
+    {
+        if (snapshot->Find(it->first))
+        {
+            ++it;
+        }
+        else
+        {
+            it = dirtyFlags_.erase(it);
+        }
+    }
+
+    Replace(snapshot.release());
+}
+
+
+void WindowSnapshotPublisher::Clear()
+{
+    std::scoped_lock lock(dirtyFlagsMutex_);
+    dirtyFlags_.clear();
+    Replace(nullptr);
+}
+
+
+UINT WindowSnapshotPublisher::CopyWindowInfos(WindowInfo* buffer, UINT capacity)
+{
+    std::scoped_lock lock(dirtyFlagsMutex_);
+
+    const ReadGuard guard(*this);
+    const auto snapshot = guard.Get();
+    if (!snapshot) return 0;
+
+    const auto count = snapshot->CopyWindowInfos(buffer, capacity);
+    if (!buffer) return count;
+
+    const bool isComplete = capacity >= count;
+    const auto n = (std::min)(count, capacity);
+    for (UINT i = 0; i < n; ++i)
+    {
+        auto& info = buffer[i];
+        const auto it = dirtyFlags_.find(info.id);
+        if (it == dirtyFlags_.end()) continue;
+
+        info.dirtyFlags = it->second;
+        if (isComplete)
+        {
+            dirtyFlags_.erase(it);
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+
+
+enum class WindowInfoFlags : UINT
+{
+    None = 0,
+    Desktop = 1 << 0,
+    AltTabWindow = 1 << 1,
+    ApplicationFrameWindow = 1 << 2,
+    UWP = 1 << 3,
+    Background = 1 << 4,
+};
+
+
+// Changes since the previous UwcGetWindowInfos() call which received every window.
+enum class WindowInfoDirtyFlags : UINT
+{
+    None = 0,
+    Added = 1 << 0,
+    Moved = 1 << 1,
+    Resized = 1 << 2,
+    ZOrderChanged = 1 << 3,
+    ParentChanged = 1 << 4,
+    TextureSizeChanged = 1 << 5,
+    FrameUpdated = 1 << 6,
+};
+
+
+// Packed and blittable per-window data returned by UwcGetWindowInfos().
+struct WindowInfo
+{
+    int id;
+    int parentId;
+    int x;
+    int y;
+    int width;
+    int height;
+    UINT zOrder;
+    UINT flags; // WindowInfoFlags
+    UINT dirtyFlags; // WindowInfoDirtyFlags
+    UINT textureWidth;
+    UINT textureHeight;
+    UINT textureOffsetX;
+    UINT textureOffsetY;
+    DWORD processId;
+    UINT64 frameId;
+};
+
+
+// Metadata of a window at the time of a window list update.
+struct WindowSnapshot
+{
+    int id;
+    int parentId;
+    HWND hWnd;
+    HMONITOR hMonitor;
+    HWND hOwner;
+    HWND hParent;
+    HINSTANCE hInstance;
+    DWORD processId;
+    DWORD threadId;
+    RECT windowRect;
+    RECT clientRect;
+    UINT zOrder;
+    bool isDesktop;
+    bool isAltTabWindow;
+    bool isApplicationFrameWindow;
+    bool isUWP;
+    bool isBackground;
+    UINT textureWidth;
+    UINT textureHeight;
+    UINT textureOffsetX;
+    UINT textureOffsetY;
+    UINT64 frameId;
+
+    UINT GetDirtyFlags(const WindowSnapshot* previous) const;
+    WindowInfo ToWindowInfo() const;
+};
+
+
+// Immutable metadata of all windows sorted by id.
+class WindowListSnapshot
+{
+public:
+    explicit WindowListSnapshot(std::vector<WindowSnapshot>&& windows);
+    const WindowSnapshot* Find(int id) const;
+    UINT CopyWindowInfos(WindowInfo* buffer, UINT capacity) const;
+    const std::vector<WindowSnapshot>& GetWindows() const { return windows_; }
+
+private:
+    std::vector<WindowSnapshot> windows_;
+};
+
+
+// Publishes snapshots through an atomic raw pointer (read-copy-update) with
+// epoch-based reclamation. A reader pins the current epoch in a slot owned by
+// its thread while it reads, so reads take no lock and touch no shared reference
+// count. A replaced snapshot is deleted by a later publication once no reader
+// has pinned an epoch older than the replacement.
+// Dirty flags are accumulated per window over publications until the consumer reads them.
+class WindowSnapshotPublisher
+{
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<UINT64> epoch = 0; // 0 while the owning thread is not reading
+        UINT depth = 0; // nested guards, accessed only by the owning thread
+    };
+
+public:
+    // Keeps the snapshot current at construction alive in its scope. Guards can be nested.
+    class ReadGuard
+    {
+    public:
+        explicit ReadGuard(const WindowSnapshotPublisher& publisher);
+        ~ReadGuard();
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        const WindowListSnapshot* Get() const { return snapshot_; }
+
+    private:
+        ReaderSlot* slot_;
+        const WindowListSnapshot* snapshot_;
+    };
+
+    WindowSnapshotPublisher();
+    ~WindowSnapshotPublisher();
+    WindowSnapshotPublisher(const WindowSnapshotPublisher&) = delete;
+    WindowSnapshotPublisher& operator=(const WindowSnapshotPublisher&) = delete;
+
+    // Run these functions in the window handle list thread.
+    void Publish(std::vector<WindowSnapshot>&& windows);
+    void Clear();
+
+    // Thread-safe. Fills the accumulated dirty flags and clears them when
+    // the buffer can hold every window, so a call that only asks for the count
+    // or is retried with a larger buffer does not lose them.
+    UINT CopyWindowInfos(WindowInfo* buffer, UINT capacity);
+
+private:
+    ReaderSlot* GetReaderSlot() const;
+    void Replace(const WindowListSnapshot* snapshot);
+    void Reclaim();
+
+    const UINT64 id_; // key of the per-thread slot cache, never reused unlike the address
+    std::atomic<const WindowListSnapshot*> current_ = nullptr;
+    std::atomic<UINT64> epoch_ = 1;
+
+    // A slot is registered once per reader thread and kept until destruction.
+    mutable std::deque<ReaderSlot> readerSlots_;
+    mutable std::mutex readerSlotsMutex_;
+
+    // Replaced snapshots with the epoch which started after the replacement.
+    std::vector<std::pair<const WindowListSnapshot*, UINT64>> retiredSnapshots_;
+
+    std::unordered_map<int, UINT> dirtyFlags_;
+    std::mutex dirtyFlagsMutex_;
+};
@@ -0,0 +1,331 @@
+#include <algorithm>
+#include "WindowSpatialIndex.h"
+
+
+
+namespace
+{
+    bool Contains(const RECT& rect, POINT point)
+    {
+        return
+            point.x >= rect.left && point.x < rect.right &&
+            point.y >= rect.top  && point.y < rect.bottom;
+    }
+
+
+    bool IsSameRect(const RECT& a, const RECT& b)
+    {
+        return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+    }
+
+
+    // Topmost windows first and desktops behind all windows.
+    bool IsAbove(const WindowSpatialIndex::Entry& a, const WindowSpatialIndex::Entry& b)
+    {
+        if (a.isDesktop != b.isDesktop) return b.isDesktop;
+        return a.zOrder < b.zOrder;
+    }
+
+
+    bool IsIdLess(const WindowSpatialIndex::Entry& a, const WindowSpatialIndex::Entry& b)
+    {
+        return a.id < b.id;
+    }
+}
+
+
+WindowSpatialIndex::WindowSpatialIndex(std::vector<Entry>&& entries)
+    : entries_(std::move(entries))
+{
+    std::stable_sort(entries_.begin(), entries_.end(), IsIdLess);
+    isRemoved_.assign(entries_.size(), false);
+    Build();
+}
+
+
+WindowSpatialIndex::WindowSpatialIndex(
+    const WindowSpatialIndex& prev,
+    std::vector<Entry>&& changedEntries,
+    const std::vector<int>& removedIds)
+    : entries_(prev.entries_)
+    , isRemoved_(prev.isRemoved_)
+    , removedCount_(prev.removedCount_)
+    , cells_(prev.cells_)
+    , bounds_(prev.bounds_)
+    , columns_(prev.columns_)
+    , rows_(prev.rows_)
+{
+    // Desktops define the bounds of the grid, so changing one rebuilds all cells.
+    bool needsRebuild = false;
+
+    // Cells covered by a changed entry are copied and edited. Cells whose entries
+    // changed their z-order are sorted again at the end.
+    struct EditedCell
+    {
+        bool isEdited = false;
+        bool needsSort = false;
+        Cell cell;
+    };
+    std::vector<EditedCell> editedCells(cells_.size());
+
+    enum class Edit { Remove, Insert, Reorder };
+    const auto editCells = [&](const RECT& rect, UINT slot, Edit edit)
+    {
+        int column0, row0, column1, row1;
+        if (!GetCellRange(rect, column0, row0, column1, row1)) return;
+
+        for (int row = row0; row <= row1; ++row)
+        {
+            for (int column = column0; column <= column1; ++column)
+            {
+                const size_t cellIndex = static_cast<size_t>(row) * columns_ + column;
+                auto& edited = editedCells[cellIndex];
+                if (!edited.isEdited)
+                {
+                    edited.isEdited = true;
+                    edited.cell = *cells_[cellIndex];
+                }
+
+                auto& cell = edited.cell;
+                switch (edit)
+                {
+                    case Edit::Remove:
+                    {
+                        const auto pos = std::find(cell.begin(), cell.end(), slot);
+                        if (pos != cell.end()) cell.erase(pos);
+                        break;
+                    }
+                    case Edit::Insert:
+                        cell.insert(
+                            std::lower_bound(cell.begin(), cell.end(), slot, [this](UINT a, UINT b) { return IsSlotAbove(a, b); }),
+                            slot);
+                        break;
+                    case Edit::Reorder:
+                        edited.needsSort = true;
+                        break;
+                }
+            }
+        }
+    };
+
+    for (const auto id : removedIds)
+    {
+        auto entry = FindEntry(id);
+        if (!entry) continue;
+
+        const UINT slot = static_cast<UINT>(entry - entries_.data());
+        if (isRemoved_[slot]) continue;
+
+        needsRebuild |= entry->isDesktop;
+        editCells(entry->rect, slot, Edit::Remove);
+        *entry = { id, { 0, 0, 0, 0 }, 0, false, {} };
+        isRemoved_[slot] = true;
+        ++removedCount_;
+    }
+
+    for (auto& changed : changedEntries)
+    {
+        auto entry = FindEntry(changed.id);
+        if (entry)
+        {
+            needsRebuild |= entry->isDesktop || changed.isDesktop;
+            const UINT slot = static_cast<UINT>(entry - entries_.data());
+            if (isRemoved_[slot])
+            {
+                isRemoved_[slot] = false;
+                --removedCount_;
+            }
+            if (!IsSameRect(entry->rect, changed.rect))
+            {
+                editCells(entry->rect, slot, Edit::Remove);
+                *entry = std::move(changed);
+                editCells(entry->rect, slot, Edit::Insert);
+            }
+            else if (entry->zOrder != changed.zOrder)
+            {
+                *entry = std::move(changed);
+                editCells(entry->rect, slot, Edit::Reorder);
+            }
+            else
+            {
+                *entry = std::move(changed);
+            }
+        }
+        else
+        {
+            // Window ids only grow, so new windows are appended; anything else rebuilds.
+            needsRebuild |= changed.isDesktop || (!entries_.empty() && changed.id < entries_.back().id);
+            entries_.push_back(std::move(changed));
+            isRemoved_.push_back(false);
+            editCells(entries_.back().rect, static_cast<UINT>(entries_.size() - 1), Edit::Insert);
+        }
+    }
+
+    if (needsRebuild || removedCount_ > entries_.size() / 2)
+    {
+        std::vector<Entry> entries;
+        entries.reserve(entries_.size() - removedCount_);
+        for (size_t slot = 0; slot < entries_.size(); ++slot)
+        {
+            if (!isRemoved_[slot]) entries.push_back(std::move(entries_[slot]));
+        }
+        entries_ = std::move(entries);
+        std::stable_sort(entries_.begin(), entries_.end(), IsIdLess);
+        isRemoved_.assign(entries_.size(), false);
+        removedCount_ = 0;
+        Build();
+        return;
+    }
+
+    for (size_t cellIndex = 0; cellIndex < editedCells.size(); ++cellIndex)
+    {
+        auto& edited = editedCells[cellIndex];
+        if (!edited.isEdited) continue;
+
+        // Bringing a window to the front shifts the z-order of the windows above it
+        // but keeps their relative order, so most of the cells are still sorted.
+        const auto isSlotAbove = [this](UINT a, UINT b) { return IsSlotAbove(a, b); };
+        if (edited.needsSort && !std::is_sorted(edited.cell.begin(), edited.cell.end(), isSlotAbove))
+        {
+            std::sort(edited.cell.begin(), edited.cell.end(), isSlotAbove);
+        }
+        cells_[cellIndex] = std::make_shared<const Cell>(std::move(edited.cell));
+    }
+}
+
+
+void WindowSpatialIndex::Build()
+{
+    // Minimized windows are placed far outside of the screens,
+    // so the grid covers only the area of the monitors.
+    bool hasBounds = false;
+    for (const auto& entry : entries_)
+    {
+        if (!entry.isDesktop) continue;
+
+        if (!hasBounds)
+        {
+            bounds_ = entry.rect;
+            hasBounds = true;
+        }
+        else
+        {
+            bounds_.left   = (std::min)(bounds_.left,   entry.rect.left);
+            bounds_.top    = (std::min)(bounds_.top,    entry.rect.top);
+            bounds_.right  = (std::max)(bounds_.right,  entry.rect.right);
+            bounds_.bottom = (std::max)(bounds_.bottom, entry.rect.bottom);
+        }
+    }
+
+    cells_.clear();
+    columns_ = rows_ = 0;
+    if (!hasBounds) return;
+
+    columns_ = static_cast<int>((bounds_.right - bounds_.left + kCellSize - 1) / kCellSize);
+    rows_ = static_cast<int>((bounds_.bottom - bounds_.top + kCellSize - 1) / kCellSize);
+    if (columns_ <= 0 || rows_ <= 0)
+    {
+        columns_ = rows_ = 0;
+        return;
+    }
+
+    std::vector<Cell> cells(static_cast<size_t>(columns_) * rows_);
+
+    // Visit the topmost entries first so that every cell is sorted.
+    std::vector<UINT> slots(entries_.size());
+    for (UINT slot = 0; slot < static_cast<UINT>(slots.size()); ++slot)
+    {
+        slots[slot] = slot;
+    }
+    std::sort(slots.begin(), slots.end(), [this](UINT a, UINT b) { return IsSlotAbove(a, b); });
+
+    for (const auto slot : slots)
+    {
+        int column0, row0, column1, row1;
+        if (!GetCellRange(entries_[slot].rect, column0, row0, column1, row1)) continue;
+
+        for (int row = row0; row <= row1; ++row)
+        {
+            for (int column = column0; column <= column1; ++column)
+            {
+                cells[static_cast<size_t>(row) * columns_ + column].push_back(slot);
+            }
+        }
+    }
+
+    cells_.reserve(cells.size());
+    for (auto& cell : cells)
+    {
+        cells_.push_back(std::make_shared<const Cell>(std::move(cell)));
+    }
+}
+
+
+bool WindowSpatialIndex::GetCell(POINT point, int& outColumn, int& outRow) const
+{
+    if (cells_.empty() || !Contains(bounds_, point)) return false;
+
+    outColumn = static_cast<int>((point.x - bounds_.left) / kCellSize);
+    outRow = static_cast<int>((point.y - bounds_.top) / kCellSize);
+
+    return true;
+}
+
+
+bool WindowSpatialIndex::GetCellRange(const RECT& rect, int& outColumn0, int& outRow0, int& outColumn1, int& outRow1) const
+{
+    if (columns_ <= 0 || rows_ <= 0) return false;
+
+    const LONG left   = (std::max)(rect.left,   bounds_.left);
+    const LONG top    = (std::max)(rect.top,    bounds_.top);
+    const LONG right  = (std::min)(rect.right,  bounds_.right);
+    const LONG bottom = (std::min)(rect.bottom, bounds_.bottom);
+    if (left >= right || top >= bottom) return false;
+
+    outColumn0 = static_cast<int>((left - bounds_.left) / kCellSize);
+    outColumn1 = static_cast<int>((right - 1 - bounds_.left) / kCellSize);
+    outRow0 = static_cast<int>((top - bounds_.top) / kCellSize);
+    outRow1 = static_cast<int>((bottom - 1 - bounds_.top) / kCellSize);
+
+    return true;
+}
+
+
+bool WindowSpatialIndex::IsSlotAbove(UINT a, UINT b) const
+{
+    // Of windows with the same z-order, the older one wins.
+    const auto& entryA = entries_[a];
+    const auto& entryB = entries_[b];
+    if (IsAbove(entryA, entryB)) return true;
+    if (IsAbove(entryB, entryA)) return false;
+    return a < b;
+}
+
+
+WindowSpatialIndex::Entry* WindowSpatialIndex::FindEntry(int id)
+{
+    Entry key {};
+    key.id = id;
+    const auto it = std::lower_bound(entries_.begin(), entries_.end(), key, IsIdLess);
+    return (it != entries_.end() && it->id == id) ? &*it : nullptr;
+}
+
+
+std::shared_ptr<Window> WindowSpatialIndex::Find(POINT point) const
+{
+    int column, row;
+    if (!GetCell(point, column, row)) return nullptr;
+
+    for (const auto slot : *cells_[static_cast<size_t>(row) * columns_ + column])
+    {
+        const auto& entry = entries_[slot];
+        if (!Contains(entry.rect, point)) continue;
+
+        if (auto window = entry.window.lock())
+        {
+            return window;
+        }
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Windows.h>
+#include <memory>
+#include <vector>
+
+
+class Window;
+
+
+// Immutable uniform grid over window rects for point queries. It is built
+// on the window handle list thread and shared with readers by pointer swap,
+// so queries neither lock the window list nor call WindowFromPoint().
+//
+// Only the rects of listed, hit-test visible windows are indexed. Unlike the
+// former WindowFromPoint() resolution, a point over a window which is not listed
+// (e.g. rejected by the window filter) hits the listed window or desktop below it
+// instead of the first desktop, and there is no fallback to a window of the
+// same thread.
+class WindowSpatialIndex
+{
+public:
+    struct Entry
+    {
+        int id;
+        RECT rect;
+        UINT zOrder;
+        bool isDesktop;
+        // Weak so that the index never keeps a removed window alive;
+        // Find() skips windows which have been released since.
+        std::weak_ptr<Window> window;
+    };
+
+    explicit WindowSpatialIndex(std::vector<Entry>&& entries);
+
+    // Applies changed (by id) and removed entries to prev, rebuilding only the cells
+    // covered by the old and new rects of the changes and sharing the other cells.
+    WindowSpatialIndex(
+        const WindowSpatialIndex& prev,
+        std::vector<Entry>&& changedEntries,
+        const std::vector<int>& removedIds);
+
+    std::shared_ptr<Window> Find(POINT point) const;
+
+private:
+    using Cell = std::vector<UINT>; // slots of the topmost entries first
+    static constexpr LONG kCellSize = 256;
+
+    void Build();
+    bool GetCell(POINT point, int& outColumn, int& outRow) const;
+    bool GetCellRange(const RECT& rect, int& outColumn0, int& outRow0, int& outColumn1, int& outRow1) const;
+    bool IsSlotAbove(UINT a, UINT b) const;
+    Entry* FindEntry(int id);
+
+    std::vector<Entry> entries_; // sorted by id; removed ones are kept as empty slots
+    std::vector<bool> isRemoved_;
+    size_t removedCount_ = 0;
+    std::vector<std::shared_ptr<const Cell>> cells_;
+    RECT bounds_ = { 0, 0, 0, 0 };
+    int columns_ = 0;
+    int rows_ = 0;
+};
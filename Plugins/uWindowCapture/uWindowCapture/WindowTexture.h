@@ -1,94 +1,139 @@
-#pragma once
-
-#include <Windows.h>
-#include <d3d11.h>
-#include <wrl/client.h>
-#include <mutex>
-#include <atomic>
-
-#include "Buffer.h"
-
-
-enum class CaptureMode
-{
-    None = -1,
-    PrintWindow = 0,
-    BitBlt = 1,
-    WindowsGraphicsCapture = 2,
-    Auto = 3,
-};
-
-
-class Window;
-class WindowsGraphicsCapture;
-
-
-class WindowTexture
-{
-public:
-    explicit WindowTexture(Window* window);
-    ~WindowTexture();
-
-    void SetUnityTexturePtr(ID3D11Texture2D* ptr);
-    ID3D11Texture2D* GetUnityTexturePtr() const;
-
-    void SetCaptureMode(CaptureMode mode);
-    CaptureMode GetCaptureMode() const;
-
-    void SetCursorDraw(bool draw);
-    bool GetCursorDraw() const;
-
-    UINT GetWidth() const;
-    UINT GetHeight() const;
-    UINT GetOffsetX() const;
-    UINT GetOffsetY() const;
-
-    bool Capture();
-    bool Upload();
-    bool Render();
-
-    BYTE* GetBuffer();
-
-    UINT GetPixel(int x, int y) const;
-    bool GetPixels(BYTE* output, int x, int y, int width, int height) const;
-
-    bool IsWindowsGraphicsCaptureAvailable() const;
-    std::shared_ptr<WindowsGraphicsCapture> GetWindowsGraphicsCapture() const;
-
-private:
-    CaptureMode GetCaptureModeInternal() const;
-    bool IsWindowsGraphicsCapture() const;
-    bool CaptureByWin32API();
-    void CreateBitmapIfNeeded(HDC hDc, UINT width, UINT height);
-    void DeleteBitmap();
-    void DrawCursorByWin32API(HWND hWnd, HDC hDcMem);
-    bool CaptureByWindowsGraphicsCapture();
-    bool RecreateSharedTextureIfNeeded();
-    bool UploadByWin32API();
-    bool UploadByWindowsGraphicsCapture();
-
-    const Window* const window_;
-    CaptureMode captureMode_ = CaptureMode::Auto;
-    std::weak_ptr<WindowsGraphicsCapture> windowsGraphicsCapture_;
-    bool isPrintWindowFailed_ = false;
-
-    std::atomic<ID3D11Texture2D*> unityTexture_ = nullptr;
-    Microsoft::WRL::ComPtr<ID3D11Texture2D> sharedTexture_;
-    HANDLE sharedHandle_ = nullptr;
-    std::mutex sharedTextureMutex_;
-
-    Buffer<BYTE> buffer_;
-    Buffer<BYTE> bufferForGetBuffer_;
-    HBITMAP bitmap_ = nullptr;
-    std::atomic<UINT> bufferWidth_ = 0;
-    std::atomic<UINT> bufferHeight_ = 0;
-    std::atomic<UINT> offsetX_ = 0;
-    std::atomic<UINT> offsetY_ = 0;
-    std::atomic<UINT> textureWidth_ = 0;
-    std::atomic<UINT> textureHeight_ = 0;
-    std::atomic<bool> drawCursor_ = true;
-    mutable std::mutex bufferMutex_;
-
-    float dpiScaleX_ = 1.f;
-    float dpiScaleY_ = 1.f;
+#pragma once
+
+#include <Windows.h>
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <mutex>
+#include <atomic>
+
+#include "Buffer.h"
+#include "SharedTextureCache.h"
+#include "Unity.h"
+
+
+enum class CaptureMode
+{
+    None = -1,
+    PrintWindow = 0,
+    BitBlt = 1,
+    WindowsGraphicsCapture = 2,
+    Auto = 3,
+};
+
+
+// Options below are used only by Windows Graphics Capture.
+enum class CapturePixelFormat
+{
+    B8G8R8A8UIntNormalized = 0,
+    R16G16B16A16Float = 1,
+};
+
+
+enum class CaptureFrameArrivalMode
+{
+    // The upload thread drains the frame pool when it uploads.
+    Polling = 0,
+    // A free-threaded FrameArrived handler stages the newest frame into a mailbox.
+    // Use a pool depth of 3 or more so that the staged frame does not starve the pool.
+    Mailbox = 1,
+};
+
+
+struct CaptureFrameStats
+{
+    UINT64 arrivedFrameCount;
+    UINT64 droppedFrameCount;
+    UINT64 uploadedFrameCount;
+    UINT64 totalLatency; // [us] from the frame presentation to the upload
+    UINT64 lastLatency; // [us]
+};
+
+
+class Window;
+class WindowsGraphicsCapture;
+
+
+class WindowTexture
+{
+public:
+    explicit WindowTexture(Window* window);
+    ~WindowTexture();
+
+    void SetUnityTexturePtr(ID3D11Texture2D* ptr);
+    ID3D11Texture2D* GetUnityTexturePtr() const;
+
+    void SetCaptureMode(CaptureMode mode);
+    CaptureMode GetCaptureMode() const;
+
+    void SetCursorDraw(bool draw);
+    bool GetCursorDraw() const;
+
+    void SetCapturePoolDepth(int depth);
+    int GetCapturePoolDepth() const;
+    void SetCapturePixelFormat(CapturePixelFormat format);
+    CapturePixelFormat GetCapturePixelFormat() const;
+    void SetCaptureFrameArrivalMode(CaptureFrameArrivalMode mode);
+    CaptureFrameArrivalMode GetCaptureFrameArrivalMode() const;
+    CaptureFrameStats GetCaptureFrameStats() const;
+
+    UINT GetWidth() const;
+    UINT GetHeight() const;
+    UINT GetOffsetX() const;
+    UINT GetOffsetY() const;
+
+    bool Capture();
+    bool Upload();
+    bool Render();
+
+    BYTE* GetBuffer();
+
+    UINT GetPixel(int x, int y) const;
+    bool GetPixels(BYTE* output, int x, int y, int width, int height) const;
+
+    bool IsWindowsGraphicsCaptureAvailable() const;
+    std::shared_ptr<WindowsGraphicsCapture> GetWindowsGraphicsCapture() const;
+
+private:
+    void InitWindowsGraphicsCaptureIfNeeded();
+    CaptureMode GetCaptureModeInternal() const;
+    bool IsWindowsGraphicsCapture() const;
+    bool CaptureByWin32API();
+    void CreateBitmapIfNeeded(HDC hDc, UINT width, UINT height);
+    void DeleteBitmap();
+    void DrawCursorByWin32API(HWND hWnd, HDC hDcMem);
+    bool CaptureByWindowsGraphicsCapture();
+    bool RecreateSharedTextureIfNeeded();
+    bool UploadByWin32API();
+    bool UploadByWindowsGraphicsCapture();
+
+    const Window* const window_;
+    CaptureMode captureMode_ = CaptureMode::Auto;
+    std::weak_ptr<WindowsGraphicsCapture> windowsGraphicsCapture_;
+    std::once_flag initWindowsGraphicsCaptureFlag_;
+    std::atomic<bool> hasWindowsGraphicsCaptureInitialized_ = false;
+    bool isPrintWindowFailed_ = false;
+
+    std::atomic<ID3D11Texture2D*> unityTexture_ = nullptr;
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> sharedTexture_;
+    HANDLE sharedHandle_ = nullptr;
+    SharedTextureCache openedSharedTexture_ { GetUnitySharedTextureDevice() };
+    std::mutex sharedTextureMutex_;
+
+    Buffer<BYTE> buffer_;
+    Buffer<BYTE> bufferForGetBuffer_;
+    HBITMAP bitmap_ = nullptr;
+    std::atomic<UINT> bufferWidth_ = 0;
+    std::atomic<UINT> bufferHeight_ = 0;
+    std::atomic<UINT> offsetX_ = 0;
+    std::atomic<UINT> offsetY_ = 0;
+    std::atomic<UINT> textureWidth_ = 0;
+    std::atomic<UINT> textureHeight_ = 0;
+    std::atomic<bool> drawCursor_ = true;
+    std::atomic<int> capturePoolDepth_ = 2;
+    std::atomic<CapturePixelFormat> capturePixelFormat_ = CapturePixelFormat::B8G8R8A8UIntNormalized;
+    std::atomic<CaptureFrameArrivalMode> captureFrameArrivalMode_ = CaptureFrameArrivalMode::Polling;
+    mutable std::mutex bufferMutex_;
+
+    float dpiScaleX_ = 1.f;
+    float dpiScaleY_ = 1.f;
 };
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include "WindowTitleManager.h"
+#include "Util.h"
+
+
+
+namespace
+{
+    constexpr int kThreadCount = 2;
+    constexpr int kQueryTimeout = 100; // [ms]
+    constexpr INT64 kMinBackoff = 500'000; // [us]
+    constexpr INT64 kMaxBackoff = 30'000'000; // [us]
+}
+
+
+WindowTitleManager::WindowTitleManager()
+{
+    for (int i = 0; i < kThreadCount; ++i)
+    {
+        threads_.emplace_back([this, i]
+        {
+            const auto name = L"uWindowCapture - Window Title Thread " + std::to_wstring(i);
+            ::SetThreadDescription(::GetCurrentThread(), name.c_str());
+            Run();
+        });
+    }
+}
+
+
+WindowTitleManager::~WindowTitleManager()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isRunning_ = false;
+    }
+    cv_.notify_all();
+
+    for (auto&& thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+
+void WindowTitleManager::Request(int windowId, HWND hWnd, bool force)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto& entry = entries_[windowId];
+        entry.hWnd = hWnd;
+
+        if (entry.isQueued) return;
+        if (!force && GetTimestampInMicroseconds() < entry.nextQueryTime) return;
+
+        entry.isQueued = true;
+        queue_.push_back(windowId);
+    }
+
+    cv_.notify_one();
+}
+
+
+void WindowTitleManager::OnWindowRemoved(int windowId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.erase(windowId);
+}
+
+
+std::vector<WindowTitleManager::Result> WindowTitleManager::TakeResults()
+{
+    std::vector<Result> results;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    results.swap(results_);
+
+    return results;
+}
+
+
+void WindowTitleManager::Run()
+{
+    for (;;)
+    {
+        int windowId;
+        HWND hWnd;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return !isRunning_ || !queue_.empty(); });
+            if (!isRunning_) return;
+
+            windowId = queue_.front();
+            queue_.pop_front();
+
+            const auto it = entries_.find(windowId);
+            if (it == entries_.end()) continue;
+            hWnd = it->second.hWnd;
+        }
+
+        Query(windowId, hWnd);
+    }
+}
+
+
+void WindowTitleManager::Query(int windowId, HWND hWnd)
+{
+    // Run this scope in a worker thread without the lock.
+
+    std::wstring title;
+    const bool hasSucceeded = GetWindowTitle(hWnd, title, kQueryTimeout);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // The window may have been removed during the query.
+    const auto it = entries_.find(windowId);
+    if (it == entries_.end()) return;
+
+    auto& entry = it->second;
+    entry.isQueued = false;
+
+    if (hasSucceeded && !title.empty())
+    {
+        entry.failureCount = 0;
+        entry.nextQueryTime = 0;
+    }
+    else
+    {
+        // Back off exponentially while the title is unavailable.
+        const auto shift = std::min<UINT>(entry.failureCount, 16);
+        const auto backoff = (std::min)(kMinBackoff << shift, kMaxBackoff);
+        entry.nextQueryTime = GetTimestampInMicroseconds() + backoff;
+        ++entry.failureCount;
+        if (!hasSucceeded) return;
+    }
+
+    if (title == entry.title) return;
+
+    entry.title = title;
+    results_.push_back({ windowId, title });
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+
+// Retrieves window titles with WM_GETTEXT on worker threads so that slow or
+// hung applications do not stall the window handle list thread. Windows
+// whose title cannot be retrieved or is empty are not queried again until
+// their backoff time passes, unless an update is forced.
+class WindowTitleManager
+{
+public:
+    struct Result
+    {
+        int windowId;
+        std::wstring title;
+    };
+
+    WindowTitleManager();
+    ~WindowTitleManager();
+
+    void Request(int windowId, HWND hWnd, bool force);
+    void OnWindowRemoved(int windowId);
+    std::vector<Result> TakeResults();
+
+private:
+    struct Entry
+    {
+        HWND hWnd = NULL;
+        std::wstring title;
+        INT64 nextQueryTime = 0; // [us]
+        UINT failureCount = 0;
+        bool isQueued = false;
+    };
+
+    void Run();
+    void Query(int windowId, HWND hWnd);
+
+    std::unordered_map<int, Entry> entries_;
+    std::deque<int> queue_;
+    std::vector<Result> results_;
+    std::vector<std::thread> threads_;
+    bool isRunning_ = true;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
@@ -1,558 +1,785 @@
-#include "WindowsGraphicsCapture.h"
-#include "WindowManager.h"
-#include "UploadManager.h"
-#include "Debug.h"
-#include "Util.h"
-#include "Window.h"
-#include <inspectable.h>
-#include <winrt/base.h>
-#include <winrt/Windows.Foundation.h>
-#include <winrt/Windows.Foundation.Metadata.h>
-#include <winrt/Windows.System.h>
-#include <winrt/Windows.Graphics.h>
-#include <winrt/Windows.Graphics.DirectX.h>
-#include <winrt/Windows.Graphics.DirectX.Direct3D11.h>
-#include <windows.graphics.directx.direct3d11.interop.h>
-#include <Windows.Graphics.Capture.Interop.h>
-#include <windows.foundation.h>
-#include <Windows.h>
-
-#pragma comment(lib, "windowsapp")
-
-using namespace winrt;
-using namespace winrt::Windows;
-using namespace winrt::Windows::Graphics::Capture;
-using namespace winrt::Windows::Graphics::DirectX;
-using namespace winrt::Windows::Graphics::DirectX::Direct3D11;
-using namespace ::Windows::Graphics::DirectX::Direct3D11;
-
-
-namespace
-{
-
-
-bool CallWinRtApiWithExceptionCheck(const std::function<void()> &func, const std::string& name) noexcept
-{
-    try
-    {
-        func();
-    }
-    catch (const winrt::hresult_error& e)
-    {
-        const int code = e.code();
-        char buf[256];
-        sprintf_s(buf, 256, "0x%x", code);
-        const auto msg = winrt::to_string(e.message());
-        Debug::Error(name, " threw an WinRT exception: ", buf, " ", msg);
-        return false;
-    }
-    catch (const std::exception& e)
-    {
-        Debug::Error(name, " threw an std exception: ", e.what());
-        return false;
-    }
-    catch (...)
-    {
-        Debug::Error(name, " threw an unknown exception.");
-        return false;
-    }
-
-    return true;
-}
-
-
-}
-
-
-// ---
-
-
-bool WindowsGraphicsCapture::IsSupported()
-{
-    using ApiInfo = winrt::Windows::Foundation::Metadata::ApiInformation;
-
-    static bool isChecked = false;
-    static bool isAvailable = false;
-    if (isChecked) return isAvailable;
-    isChecked = true;
-
-    if (!CallWinRtApiWithExceptionCheck([&]
-    {
-        isAvailable = ApiInfo::IsApiContractPresent(L"Windows.Foundation.UniversalApiContract", 8);
-    }, "WindowsGraphicsCapture::IsSupported()"))
-    {
-        return false;
-    }
-
-    return isAvailable;
-}
-
-
-bool WindowsGraphicsCapture::IsCursorCaptureEnabledApiSupported()
-{
-    using ApiInfo = winrt::Windows::Foundation::Metadata::ApiInformation;
-
-    if (!IsSupported()) return false;
-
-    static bool isChecked = false;
-    static bool isEnabled = false;
-    if (isChecked) return isEnabled;
-    isChecked = true;
-
-    if (!CallWinRtApiWithExceptionCheck([&]
-    {
-        isEnabled = ApiInfo::IsPropertyPresent(
-            L"Windows.Graphics.Capture.GraphicsCaptureSession",
-            L"IsCursorCaptureEnabled");
-    }, "WindowsGraphicsCapture::IsCursorCaptureEnabledApiAvailable()"))
-    {
-        return false;
-    }
-
-    return isEnabled;
-}
-
-
-WindowsGraphicsCapture::WindowsGraphicsCapture(HWND hWnd)
-    : hWnd_(hWnd)
-    , hMonitor_(NULL)
-{
-    CreateItem();
-}
-
-
-WindowsGraphicsCapture::WindowsGraphicsCapture(HMONITOR hMonitor)
-    : hMonitor_(hMonitor)
-    , hWnd_(NULL)
-{
-    CreateItem();
-}
-
-
-bool WindowsGraphicsCapture::CreateItem()
-{
-    if (!IsSupported()) return false;
-
-    std::scoped_lock lock(itemMutex_);
-
-    CallWinRtApiWithExceptionCheck([&]
-    {
-        const auto factory = get_activation_factory<GraphicsCaptureItem>();
-        const auto interop = factory.as<IGraphicsCaptureItemInterop>();
-        if (hWnd_)
-        {
-            interop->CreateForWindow(
-                hWnd_,
-                guid_of<ABI::Windows::Graphics::Capture::IGraphicsCaptureItem>(), 
-                reinterpret_cast<void**>(put_abi(item_)));
-        }
-        else
-        {
-            interop->CreateForMonitor(
-                hMonitor_,
-                guid_of<ABI::Windows::Graphics::Capture::IGraphicsCaptureItem>(), 
-                reinterpret_cast<void**>(put_abi(item_)));
-        }
-    }, "WindowsGraphicsCapture::CreateItem()");
-
-    if (!item_) return false;
-
-    size_ = item_.Size();
-
-    return true;
-}
-
-
-bool WindowsGraphicsCapture::CreatePoolAndSession()
-{
-    std::scoped_lock lock(itemMutex_);
-
-    if (!item_) return false;
-
-    bool ret = CallWinRtApiWithExceptionCheck([&]
-    {
-        size_ = item_.Size();
-    }, "WindowsGraphicsCapture::CreatePoolAndSession() - Size");
-    if (!ret) return false;
-
-    if (size_.Width == 0 || size_.Height == 0) return false;
-
-    const auto& manager = WindowManager::GetWindowsGraphicsCaptureManager();
-    if (!manager) return false;
-
-    auto& device = manager->GetDevice();
-
-    return CallWinRtApiWithExceptionCheck([&]
-    {
-        std::scoped_lock lock(sessionAndPoolMutex_);
-
-        pool_ = Direct3D11CaptureFramePool::CreateFreeThreaded(
-            device,
-            DirectXPixelFormat::B8G8R8A8UIntNormalized,
-            2,
-            size_);
-        session_ = pool_.CreateCaptureSession(item_);
-        session_.StartCapture();
-    }, "WindowsGraphicsCapture::CreatePoolAndSession() - Capture");
-}
-
-
-void WindowsGraphicsCapture::DestroyPoolAndSession()
-{
-    ReleaseLatestResult();
-
-    std::scoped_lock lock(sessionAndPoolMutex_);
-
-    if (pool_)
-    {
-        CallWinRtApiWithExceptionCheck(
-            [&] { pool_.Close(); }, 
-            "WindowsGraphicsCapture::DestroyPoolAndSession() - Pool");
-    }
-
-    if (session_)
-    {
-        CallWinRtApiWithExceptionCheck(
-            [&] { session_.Close(); }, 
-            "WindowsGraphicsCapture::DestroyPoolAndSession() - Session");
-    }
-
-    pool_ = nullptr;
-    session_ = nullptr;
-}
-
-
-WindowsGraphicsCapture::~WindowsGraphicsCapture()
-{
-}
-
-
-void WindowsGraphicsCapture::RequestStart()
-{
-    isStartRequested_ = true;
-}
-
-
-void WindowsGraphicsCapture::Start()
-{
-    isStartRequested_ = false;
-    stopTimer_ = 0.f;
-
-    if (isStarted_) return;
-
-    if (CreatePoolAndSession())
-    {
-        isStarted_ = true;
-        restartTimer_ = 0.f;
-    }
-}
-
-
-void WindowsGraphicsCapture::Stop()
-{
-    stopTimer_ = 0.f;
-
-    if (!isStarted_) return;
-    isStarted_ = false;
-
-    DestroyPoolAndSession();
-}
-
-
-bool WindowsGraphicsCapture::ShouldStop() const
-{
-    constexpr float timer = 1.f;
-    return stopTimer_ > timer;
-}
-
-
-bool WindowsGraphicsCapture::ShouldRestart() const
-{
-    return isRestartRequested_;
-}
-
-
-void WindowsGraphicsCapture::Restart()
-{
-    restartTimer_ = 0.f;
-    isRestartRequested_ = false;
-
-    Stop();
-    if (!CreateItem()) return;
-    Start();
-}
-
-
-bool WindowsGraphicsCapture::IsAvailable() const
-{
-    std::scoped_lock lock(itemMutex_);
-
-    return item_ != nullptr;
-}
-
-
-void WindowsGraphicsCapture::Update(float dt)
-{
-    stopTimer_ = stopTimer_ + dt;
-    restartTimer_ = restartTimer_ + dt;
-}
-
-
-void WindowsGraphicsCapture::EnableCursorCapture(bool enabled)
-{
-    if (isCursorCaptureEnabled_ == enabled) return;
-
-    isCursorCaptureEnabled_ = enabled;
-
-    if (!IsCursorCaptureEnabledApiSupported())
-    {
-        Debug::Log("CursorCaptureEnabled API is not available.");
-        return;
-    }
-
-    std::scoped_lock lock(sessionAndPoolMutex_);
-
-    if (session_) 
-    {
-        session_.IsCursorCaptureEnabled(enabled);
-    }
-}
-
-
-WindowsGraphicsCapture::Result WindowsGraphicsCapture::TryGetLatestResult()
-{
-    UWC_SCOPE_TIMER(TryGetLatestResult)
-
-    stopTimer_ = 0.f;
-
-    std::scoped_lock lock(sessionAndPoolMutex_);
-
-    if (!pool_) return {};
-
-    while (const auto nextFrame = pool_.TryGetNextFrame())
-    {
-        frame_ = nextFrame;
-    }
-
-    if (!frame_)
-    {
-        constexpr float timer = 1.f;
-        if (restartTimer_ > timer)
-        {
-            isRestartRequested_ = true;
-        }
-        return {};
-    };
-
-    const auto surface = frame_.Surface();
-    if (!surface) return {};
-
-    restartTimer_ = 0.f;
-
-    auto access = surface.as<IDirect3DDxgiInterfaceAccess>();
-    com_ptr<ID3D11Texture2D> texture;
-    const auto hr = access->GetInterface(guid_of<ID3D11Texture2D>(), texture.put_void());
-    if (FAILED(hr)) return {};
-
-    const auto size = frame_.ContentSize();
-    const bool hasSizeChanged = 
-        (size_.Width != size.Width) || 
-        (size_.Height != size.Height);
-
-    return { texture.get(), size.Width, size.Height, hasSizeChanged };
-}
-
-
-void WindowsGraphicsCapture::ReleaseLatestResult()
-{
-    std::scoped_lock lock(sessionAndPoolMutex_);
-
-    if (frame_)
-    {
-        frame_ = nullptr;
-    }
-}
-
-
-void WindowsGraphicsCapture::ChangePoolSize(int width, int height)
-{
-    std::scoped_lock lock(sessionAndPoolMutex_);
-
-    if (!pool_) return;
-
-    const auto& manager = WindowManager::GetWindowsGraphicsCaptureManager();
-    if (!manager) return;
-
-    auto &device = manager->GetDevice();
-    size_ = { width, height };
-
-    pool_.Recreate(
-        device, 
-        DirectXPixelFormat::B8G8R8A8UIntNormalized,
-        2,
-        size_);
-}
-
-
-const wchar_t * WindowsGraphicsCapture::GetDisplayName() const
-{
-    std::scoped_lock lock(itemMutex_);
-
-    static const wchar_t invalid[] = L"";
-    if (!item_) return invalid;
-
-    if (!CallWinRtApiWithExceptionCheck([&]
-    {
-        const auto displayName = item_.DisplayName();
-    }, "WindowsGraphicsCapture::GetDisplayName()"))
-    {
-        return invalid;
-    }
-
-    return item_.DisplayName().c_str();
-}
-
-
-// ---
-
-
-IDirect3DDevice & WindowsGraphicsCaptureManager::GetDevice()
-{
-    if (!deviceWinRt_)
-    {
-        const auto& uploader = WindowManager::GetUploadManager();
-        while (!uploader->IsReady())
-        {
-            const std::chrono::microseconds waitTime(100);
-            std::this_thread::sleep_for(waitTime);
-        }
-
-        if (auto device = uploader->GetDevice())
-        {
-            com_ptr<IDXGIDevice> dxgiDevice;
-            const auto hr = device->QueryInterface<IDXGIDevice>(dxgiDevice.put());
-            if (SUCCEEDED(hr))
-            {
-                com_ptr<::IInspectable> deviceWinRt;
-                ::CreateDirect3D11DeviceFromDXGIDevice(dxgiDevice.get(), deviceWinRt.put());
-                deviceWinRt_ = deviceWinRt.as<IDirect3DDevice>();
-            }
-        }
-    }
-
-    return deviceWinRt_;
-}
-
-
-std::shared_ptr<WindowsGraphicsCapture> WindowsGraphicsCaptureManager::Create(HWND hWnd)
-{
-    auto instance = std::make_shared<WindowsGraphicsCapture>(hWnd);
-    if (!instance->IsAvailable()) return nullptr;
-
-    std::scoped_lock lock(allInstancesMutex_);
-    allInstances_.push_back(instance);
-
-    return instance;
-}
-
-
-std::shared_ptr<WindowsGraphicsCapture> WindowsGraphicsCaptureManager::Create(HMONITOR hMonitor)
-{
-    auto instance = std::make_shared<WindowsGraphicsCapture>(hMonitor);
-    if (!instance->IsAvailable()) return nullptr;
-
-    std::scoped_lock lock(allInstancesMutex_);
-    allInstances_.push_back(instance);
-
-    return instance;
-}
-
-
-void WindowsGraphicsCaptureManager::Destroy(const std::shared_ptr<WindowsGraphicsCapture> &instance)
-{
-    std::scoped_lock lock(allInstancesMutex_);
-    allInstances_.remove(instance);
-}
-
-
-void WindowsGraphicsCaptureManager::UpdateFromMainThread(float dt)
-{
-    std::scoped_lock lock(activeInstancesMutex_);
-
-    for (const auto& instance : activeInstances_)
-    {
-        instance->Update(dt);
-    }
-}
-
-
-void WindowsGraphicsCaptureManager::UpdateFromCaptureThread()
-{
-    StartInstances();
-    RestartInstances();
-    StopInstances();
-}
-
-
-void WindowsGraphicsCaptureManager::StartInstances()
-{
-    std::scoped_lock lock(allInstancesMutex_);
-
-    for (const auto& instance : allInstances_)
-    {
-        if (instance->isStartRequested_)
-        {
-            instance->Start();
-
-            if (instance->IsStarted())
-            {
-                std::scoped_lock lock(activeInstancesMutex_);
-                activeInstances_.push_back(instance);
-            }
-        }
-    }
-}
-
-
-void WindowsGraphicsCaptureManager::RestartInstances()
-{
-    std::scoped_lock lock(activeInstancesMutex_);
-
-    for (const auto& instance : activeInstances_)
-    {
-        if (instance->ShouldRestart())
-        {
-            instance->Restart();
-        }
-    }
-}
-
-
-void WindowsGraphicsCaptureManager::StopInstances()
-{
-    std::scoped_lock lock(activeInstancesMutex_);
-
-    for (auto it = activeInstances_.begin(); it != activeInstances_.end();)
-    {
-        auto instance = *it;
-        if (instance->ShouldStop())
-        {
-            instance->Stop();
-            it = activeInstances_.erase(it);
-            continue;
-        }
-        ++it;
-    }
-}
-
-
-void WindowsGraphicsCaptureManager::StopAllInstances()
-{
-    std::scoped_lock lock(activeInstancesMutex_);
-
-    for (const auto& instance : activeInstances_)
-    {
-        instance->Stop();
-    }
-    activeInstances_.clear();
-}
+#include "WindowsGraphicsCapture.h"
+#include "WindowManager.h"
+#include "UploadManager.h"
+#include "Debug.h"
+#include "Util.h"
+#include "Window.h"
+#include <algorithm>
+#include <vector>
+#include <inspectable.h>
+#include <winrt/base.h>
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Foundation.Metadata.h>
+#include <winrt/Windows.System.h>
+#include <winrt/Windows.Graphics.h>
+#include <winrt/Windows.Graphics.DirectX.h>
+#include <winrt/Windows.Graphics.DirectX.Direct3D11.h>
+#include <windows.graphics.directx.direct3d11.interop.h>
+#include <Windows.Graphics.Capture.Interop.h>
+#include <windows.foundation.h>
+#include <Windows.h>
+
+#pragma comment(lib, "windowsapp")
+
+using namespace winrt;
+using namespace winrt::Windows;
+using namespace winrt::Windows::Graphics::Capture;
+using namespace winrt::Windows::Graphics::DirectX;
+using namespace winrt::Windows::Graphics::DirectX::Direct3D11;
+using namespace ::Windows::Graphics::DirectX::Direct3D11;
+
+
+namespace
+{
+
+
+bool CallWinRtApiWithExceptionCheck(const std::function<void()> &func, const std::string& name) noexcept
+{
+    try
+    {
+        func();
+    }
+    catch (const winrt::hresult_error& e)
+    {
+        const int code = e.code();
+        char buf[256];
+        sprintf_s(buf, 256, "0x%x", code);
+        const auto msg = winrt::to_string(e.message());
+        UWC_ERROR(name, " threw an WinRT exception: ", buf, " ", msg);
+        return false;
+    }
+    catch (const std::exception& e)
+    {
+        UWC_ERROR(name, " threw an std exception: ", e.what());
+        return false;
+    }
+    catch (...)
+    {
+        UWC_ERROR(name, " threw an unknown exception.");
+        return false;
+    }
+
+    return true;
+}
+
+
+DirectXPixelFormat ToDirectXPixelFormat(CapturePixelFormat format)
+{
+    switch (format)
+    {
+        case CapturePixelFormat::R16G16B16A16Float : return DirectXPixelFormat::R16G16B16A16Float;
+        default                                    : return DirectXPixelFormat::B8G8R8A8UIntNormalized;
+    }
+}
+
+
+}
+
+
+// ---
+
+
+bool WindowsGraphicsCapture::IsSupported()
+{
+    using ApiInfo = winrt::Windows::Foundation::Metadata::ApiInformation;
+
+    static bool isChecked = false;
+    static bool isAvailable = false;
+    if (isChecked) return isAvailable;
+    isChecked = true;
+
+    if (!CallWinRtApiWithExceptionCheck([&]
+    {
+        isAvailable = ApiInfo::IsApiContractPresent(L"Windows.Foundation.UniversalApiContract", 8);
+    }, "WindowsGraphicsCapture::IsSupported()"))
+    {
+        return false;
+    }
+
+    return isAvailable;
+}
+
+
+bool WindowsGraphicsCapture::IsCursorCaptureEnabledApiSupported()
+{
+    using ApiInfo = winrt::Windows::Foundation::Metadata::ApiInformation;
+
+    if (!IsSupported()) return false;
+
+    static bool isChecked = false;
+    static bool isEnabled = false;
+    if (isChecked) return isEnabled;
+    isChecked = true;
+
+    if (!CallWinRtApiWithExceptionCheck([&]
+    {
+        isEnabled = ApiInfo::IsPropertyPresent(
+            L"Windows.Graphics.Capture.GraphicsCaptureSession",
+            L"IsCursorCaptureEnabled");
+    }, "WindowsGraphicsCapture::IsCursorCaptureEnabledApiAvailable()"))
+    {
+        return false;
+    }
+
+    return isEnabled;
+}
+
+
+WindowsGraphicsCapture::WindowsGraphicsCapture(HWND hWnd)
+    : hWnd_(hWnd)
+    , hMonitor_(NULL)
+{
+    CreateItem();
+}
+
+
+WindowsGraphicsCapture::WindowsGraphicsCapture(HMONITOR hMonitor)
+    : hMonitor_(hMonitor)
+    , hWnd_(NULL)
+{
+    CreateItem();
+}
+
+
+bool WindowsGraphicsCapture::CreateItem()
+{
+    if (!IsSupported()) return false;
+
+    std::scoped_lock lock(itemMutex_);
+
+    CallWinRtApiWithExceptionCheck([&]
+    {
+        const auto factory = get_activation_factory<GraphicsCaptureItem>();
+        const auto interop = factory.as<IGraphicsCaptureItemInterop>();
+        if (hWnd_)
+        {
+            interop->CreateForWindow(
+                hWnd_,
+                guid_of<ABI::Windows::Graphics::Capture::IGraphicsCaptureItem>(), 
+                reinterpret_cast<void**>(put_abi(item_)));
+        }
+        else
+        {
+            interop->CreateForMonitor(
+                hMonitor_,
+                guid_of<ABI::Windows::Graphics::Capture::IGraphicsCaptureItem>(), 
+                reinterpret_cast<void**>(put_abi(item_)));
+        }
+    }, "WindowsGraphicsCapture::CreateItem()");
+
+    if (!item_) return false;
+
+    size_ = item_.Size();
+
+    return true;
+}
+
+
+bool WindowsGraphicsCapture::CreatePoolAndSession()
+{
+    std::scoped_lock lock(itemMutex_);
+
+    if (!item_) return false;
+
+    bool ret = CallWinRtApiWithExceptionCheck([&]
+    {
+        size_ = item_.Size();
+    }, "WindowsGraphicsCapture::CreatePoolAndSession() - Size");
+    if (!ret) return false;
+
+    if (size_.Width == 0 || size_.Height == 0) return false;
+
+    const auto& manager = WindowManager::GetWindowsGraphicsCaptureManager();
+    if (!manager) return false;
+
+    auto& device = manager->GetDevice();
+
+    return CallWinRtApiWithExceptionCheck([&]
+    {
+        std::scoped_lock lock(sessionAndPoolMutex_);
+
+        pool_ = Direct3D11CaptureFramePool::CreateFreeThreaded(
+            device,
+            ToDirectXPixelFormat(options_.pixelFormat),
+            options_.poolDepth,
+            size_);
+
+        isFrameArrivedHandled_ = (options_.frameArrivalMode == CaptureFrameArrivalMode::Mailbox);
+        if (isFrameArrivedHandled_)
+        {
+            // The pool is free-threaded, so the handler is called on a system worker thread.
+            frameArrivedRevoker_ = pool_.FrameArrived(
+                auto_revoke, 
+                [weak = weak_from_this()](const Direct3D11CaptureFramePool& pool, const auto&)
+                {
+                    if (const auto self = weak.lock())
+                    {
+                        self->OnFrameArrived(pool);
+                    }
+                });
+        }
+
+        session_ = pool_.CreateCaptureSession(item_);
+        session_.StartCapture();
+    }, "WindowsGraphicsCapture::CreatePoolAndSession() - Capture");
+}
+
+
+void WindowsGraphicsCapture::DestroyPoolAndSession()
+{
+    ReleaseLatestResult();
+
+    std::scoped_lock lock(sessionAndPoolMutex_);
+
+    frameArrivedRevoker_.revoke();
+    isFrameArrivedHandled_ = false;
+    {
+        std::scoped_lock mailboxLock(mailboxMutex_);
+        mailboxFrame_ = nullptr;
+    }
+
+    if (pool_)
+    {
+        CallWinRtApiWithExceptionCheck(
+            [&] { pool_.Close(); }, 
+            "WindowsGraphicsCapture::DestroyPoolAndSession() - Pool");
+    }
+
+    if (session_)
+    {
+        CallWinRtApiWithExceptionCheck(
+            [&] { session_.Close(); }, 
+            "WindowsGraphicsCapture::DestroyPoolAndSession() - Session");
+    }
+
+    pool_ = nullptr;
+    session_ = nullptr;
+}
+
+
+WindowsGraphicsCapture::~WindowsGraphicsCapture()
+{
+}
+
+
+void WindowsGraphicsCapture::RequestStart()
+{
+    bool isActive;
+    {
+        std::scoped_lock lock(stateMutex_);
+        stateMachine_.OnRequested(GetTimestampInMicroseconds());
+        isActive = stateMachine_.GetState() == CaptureSessionState::Active;
+    }
+
+    // Active sessions only refresh their timestamp; timeouts are checked periodically.
+    if (isActive) return;
+
+    if (!isUpdateRequested_.exchange(true))
+    {
+        if (const auto& manager = WindowManager::GetWindowsGraphicsCaptureManager())
+        {
+            manager->RequestUpdate(shared_from_this());
+        }
+    }
+}
+
+
+bool WindowsGraphicsCapture::IsStarted() const
+{
+    return GetState() != CaptureSessionState::Stopped;
+}
+
+
+CaptureSessionState WindowsGraphicsCapture::GetState() const
+{
+    std::scoped_lock lock(stateMutex_);
+    return stateMachine_.GetState();
+}
+
+
+INT64 WindowsGraphicsCapture::GetLastRequestTime() const
+{
+    std::scoped_lock lock(stateMutex_);
+    return stateMachine_.GetLastRequestTime();
+}
+
+
+CaptureSessionAction WindowsGraphicsCapture::UpdateState(INT64 now, const CaptureSessionTimeouts& timeouts)
+{
+    // Run this scope in the thread loop managed by CaptureManager.
+
+    CaptureSessionAction action;
+    {
+        std::scoped_lock lock(stateMutex_);
+        action = stateMachine_.Update(now, timeouts);
+    }
+
+    switch (action)
+    {
+        case CaptureSessionAction::Start   : Start(); break;
+        case CaptureSessionAction::Stop    : Stop(); break;
+        case CaptureSessionAction::Restart : Restart(); break;
+        default                            : break;
+    }
+
+    return action;
+}
+
+
+void WindowsGraphicsCapture::Start()
+{
+    const bool succeeded = CreatePoolAndSession();
+
+    std::scoped_lock lock(stateMutex_);
+    stateMachine_.OnStarted(succeeded, GetTimestampInMicroseconds());
+}
+
+
+void WindowsGraphicsCapture::Stop()
+{
+    DestroyPoolAndSession();
+
+    std::scoped_lock lock(stateMutex_);
+    stateMachine_.OnStopped();
+}
+
+
+void WindowsGraphicsCapture::Restart()
+{
+    Stop();
+    if (!CreateItem()) return;
+    Start();
+}
+
+
+bool WindowsGraphicsCapture::IsAvailable() const
+{
+    std::scoped_lock lock(itemMutex_);
+
+    return item_ != nullptr;
+}
+
+
+void WindowsGraphicsCapture::EnableCursorCapture(bool enabled)
+{
+    if (isCursorCaptureEnabled_ == enabled) return;
+
+    isCursorCaptureEnabled_ = enabled;
+
+    if (!IsCursorCaptureEnabledApiSupported())
+    {
+        UWC_LOG("CursorCaptureEnabled API is not available.");
+        return;
+    }
+
+    std::scoped_lock lock(sessionAndPoolMutex_);
+
+    if (session_) 
+    {
+        session_.IsCursorCaptureEnabled(enabled);
+    }
+}
+
+
+WindowsGraphicsCapture::Result WindowsGraphicsCapture::TryGetLatestResult()
+{
+    UWC_SCOPE_TIMER(TryGetLatestResult)
+
+    std::scoped_lock lock(sessionAndPoolMutex_);
+
+    if (!pool_) return {};
+
+    if (isFrameArrivedHandled_)
+    {
+        std::scoped_lock mailboxLock(mailboxMutex_);
+        if (mailboxFrame_)
+        {
+            frame_ = mailboxFrame_;
+            mailboxFrame_ = nullptr;
+        }
+    }
+    else
+    {
+        while (const auto nextFrame = pool_.TryGetNextFrame())
+        {
+            ++arrivedFrameCount_;
+            if (frame_) ++droppedFrameCount_;
+            frame_ = nextFrame;
+        }
+    }
+
+    if (!frame_) return {};
+
+    const auto surface = frame_.Surface();
+    if (!surface) return {};
+
+    {
+        std::scoped_lock stateLock(stateMutex_);
+        stateMachine_.OnFrameReceived(GetTimestampInMicroseconds());
+    }
+
+    auto access = surface.as<IDirect3DDxgiInterfaceAccess>();
+    com_ptr<ID3D11Texture2D> texture;
+    const auto hr = access->GetInterface(guid_of<ID3D11Texture2D>(), texture.put_void());
+    if (FAILED(hr)) return {};
+
+    const auto size = frame_.ContentSize();
+    const bool hasSizeChanged = 
+        (size_.Width != size.Width) || 
+        (size_.Height != size.Height);
+
+    RecordLatency(frame_);
+
+    return { texture.get(), size.Width, size.Height, hasSizeChanged };
+}
+
+
+void WindowsGraphicsCapture::ReleaseLatestResult()
+{
+    std::scoped_lock lock(sessionAndPoolMutex_);
+
+    if (frame_)
+    {
+        frame_ = nullptr;
+    }
+}
+
+
+void WindowsGraphicsCapture::ChangePoolSize(int width, int height)
+{
+    std::scoped_lock lock(sessionAndPoolMutex_);
+
+    if (!pool_) return;
+
+    const auto& manager = WindowManager::GetWindowsGraphicsCaptureManager();
+    if (!manager) return;
+
+    auto &device = manager->GetDevice();
+    size_ = { width, height };
+
+    pool_.Recreate(
+        device, 
+        ToDirectXPixelFormat(options_.pixelFormat),
+        options_.poolDepth,
+        size_);
+}
+
+
+void WindowsGraphicsCapture::SetOptions(const Options& options)
+{
+    std::scoped_lock lock(sessionAndPoolMutex_);
+
+    if (options_.poolDepth == options.poolDepth &&
+        options_.pixelFormat == options.pixelFormat &&
+        options_.frameArrivalMode == options.frameArrivalMode)
+    {
+        return;
+    }
+
+    options_ = options;
+
+    // A running pool and session are recreated with the new options.
+    {
+        std::scoped_lock stateLock(stateMutex_);
+        stateMachine_.RequestRestart();
+    }
+
+    if (!isUpdateRequested_.exchange(true))
+    {
+        if (const auto& manager = WindowManager::GetWindowsGraphicsCaptureManager())
+        {
+            manager->RequestUpdate(shared_from_this());
+        }
+    }
+}
+
+
+void WindowsGraphicsCapture::OnFrameArrived(const Direct3D11CaptureFramePool& pool)
+{
+    // Run this scope in a worker thread of the free-threaded frame pool.
+
+    UWC_SCOPE_TIMER(OnFrameArrived)
+
+    Direct3D11CaptureFrame frame = nullptr;
+    CallWinRtApiWithExceptionCheck([&]
+    {
+        while (const auto nextFrame = pool.TryGetNextFrame())
+        {
+            ++arrivedFrameCount_;
+            if (frame) ++droppedFrameCount_;
+            frame = nextFrame;
+        }
+    }, "WindowsGraphicsCapture::OnFrameArrived()");
+
+    if (!frame) return;
+
+    // Keep only the newest frame so that older ones go back to the pool.
+    std::scoped_lock lock(mailboxMutex_);
+    if (mailboxFrame_) ++droppedFrameCount_;
+    mailboxFrame_ = frame;
+}
+
+
+void WindowsGraphicsCapture::RecordLatency(const Direct3D11CaptureFrame& frame)
+{
+    // SystemRelativeTime is based on QueryPerformanceCounter() in 100 ns units.
+    LARGE_INTEGER counter, frequency;
+    ::QueryPerformanceCounter(&counter);
+    ::QueryPerformanceFrequency(&frequency);
+    const INT64 now = 
+        (counter.QuadPart / frequency.QuadPart) * 10'000'000 + 
+        (counter.QuadPart % frequency.QuadPart) * 10'000'000 / frequency.QuadPart;
+
+    const INT64 latency = std::max<INT64>(now - frame.SystemRelativeTime().count(), 0) / 10; // [us]
+    ++uploadedFrameCount_;
+    totalLatency_ += latency;
+    lastLatency_ = latency;
+}
+
+
+CaptureFrameStats WindowsGraphicsCapture::GetFrameStats() const
+{
+    CaptureFrameStats stats;
+    stats.arrivedFrameCount = arrivedFrameCount_;
+    stats.droppedFrameCount = droppedFrameCount_;
+    stats.uploadedFrameCount = uploadedFrameCount_;
+    stats.totalLatency = totalLatency_;
+    stats.lastLatency = lastLatency_;
+    return stats;
+}
+
+
+const wchar_t * WindowsGraphicsCapture::GetDisplayName() const
+{
+    std::scoped_lock lock(itemMutex_);
+
+    static const wchar_t invalid[] = L"";
+    if (!item_) return invalid;
+
+    if (!CallWinRtApiWithExceptionCheck([&]
+    {
+        const auto displayName = item_.DisplayName();
+    }, "WindowsGraphicsCapture::GetDisplayName()"))
+    {
+        return invalid;
+    }
+
+    return item_.DisplayName().c_str();
+}
+
+
+// ---
+
+
+IDirect3DDevice & WindowsGraphicsCaptureManager::GetDevice()
+{
+    if (!deviceWinRt_)
+    {
+        const auto& uploader = WindowManager::GetUploadManager();
+        while (!uploader->IsReady())
+        {
+            const std::chrono::microseconds waitTime(100);
+            std::this_thread::sleep_for(waitTime);
+        }
+
+        if (auto device = uploader->GetDevice())
+        {
+            com_ptr<IDXGIDevice> dxgiDevice;
+            const auto hr = device->QueryInterface<IDXGIDevice>(dxgiDevice.put());
+            if (SUCCEEDED(hr))
+            {
+                com_ptr<::IInspectable> deviceWinRt;
+                ::CreateDirect3D11DeviceFromDXGIDevice(dxgiDevice.get(), deviceWinRt.put());
+                deviceWinRt_ = deviceWinRt.as<IDirect3DDevice>();
+            }
+        }
+    }
+
+    return deviceWinRt_;
+}
+
+
+std::shared_ptr<WindowsGraphicsCapture> WindowsGraphicsCaptureManager::Create(HWND hWnd)
+{
+    auto instance = std::make_shared<WindowsGraphicsCapture>(hWnd);
+    if (!instance->IsAvailable()) return nullptr;
+
+    Add(instance);
+
+    return instance;
+}
+
+
+std::shared_ptr<WindowsGraphicsCapture> WindowsGraphicsCaptureManager::Create(HMONITOR hMonitor)
+{
+    auto instance = std::make_shared<WindowsGraphicsCapture>(hMonitor);
+    if (!instance->IsAvailable()) return nullptr;
+
+    Add(instance);
+
+    return instance;
+}
+
+
+void WindowsGraphicsCaptureManager::Add(const Ptr& instance)
+{
+    std::scoped_lock lock(instancesMutex_);
+    allInstances_.emplace(instance.get(), instance);
+}
+
+
+void WindowsGraphicsCaptureManager::Destroy(const std::shared_ptr<WindowsGraphicsCapture> &instance)
+{
+    instance->Stop();
+
+    std::scoped_lock lock(instancesMutex_);
+    allInstances_.erase(instance.get());
+    runningInstances_.erase(instance.get());
+}
+
+
+void WindowsGraphicsCaptureManager::SetSessionTimeouts(const CaptureSessionTimeouts& timeouts)
+{
+    std::scoped_lock lock(settingsMutex_);
+    timeouts_ = timeouts;
+}
+
+
+void WindowsGraphicsCaptureManager::SetWarmSessionCapacity(int capacity)
+{
+    std::scoped_lock lock(settingsMutex_);
+    warmSessionCapacity_ = static_cast<size_t>((std::max)(capacity, 0));
+}
+
+
+void WindowsGraphicsCaptureManager::RequestUpdate(const std::shared_ptr<WindowsGraphicsCapture>& instance)
+{
+    requestedInstances_.Post(instance);
+}
+
+
+void WindowsGraphicsCaptureManager::UpdateFromCaptureThread()
+{
+    // Run this scope in the thread loop managed by CaptureManager.
+
+    // All timeouts are in the order of seconds, so running sessions
+    // do not have to be checked on every iteration of the capture loop.
+    constexpr INT64 kRunningCheckInterval = 50 * 1000;
+
+    std::vector<std::weak_ptr<WindowsGraphicsCapture>> requestedInstances;
+    const bool hasRequestedInstances = requestedInstances_.TakeAll(requestedInstances);
+    const auto now = GetTimestampInMicroseconds();
+    const bool shouldCheckRunningInstances = now - lastRunningCheckTime_ >= kRunningCheckInterval;
+    if (!hasRequestedInstances && !shouldCheckRunningInstances) return;
+
+    UWC_SCOPE_TIMER(UpdateWindowsGraphicsCaptureSessions)
+
+    CaptureSessionTimeouts timeouts;
+    size_t warmSessionCapacity;
+    {
+        std::scoped_lock lock(settingsMutex_);
+        timeouts = timeouts_;
+        warmSessionCapacity = warmSessionCapacity_;
+    }
+
+    if (hasRequestedInstances)
+    {
+        ProcessRequestedInstances(requestedInstances, now, timeouts);
+    }
+
+    if (shouldCheckRunningInstances)
+    {
+        lastRunningCheckTime_ = now;
+        CheckRunningInstances(now, timeouts);
+        EvictWarmInstances(warmSessionCapacity);
+    }
+}
+
+
+void WindowsGraphicsCaptureManager::UpdateInstance(const Ptr& instance, INT64 now, const CaptureSessionTimeouts& timeouts)
+{
+    instance->UpdateState(now, timeouts);
+
+    if (instance->IsStarted())
+    {
+        runningInstances_.emplace(instance.get(), instance);
+    }
+    else
+    {
+        runningInstances_.erase(instance.get());
+    }
+}
+
+
+void WindowsGraphicsCaptureManager::ProcessRequestedInstances(
+    const std::vector<std::weak_ptr<WindowsGraphicsCapture>>& requestedInstances,
+    INT64 now,
+    const CaptureSessionTimeouts& timeouts)
+{
+    std::scoped_lock lock(instancesMutex_);
+
+    for (const auto& weakInstance : requestedInstances)
+    {
+        const auto instance = weakInstance.lock();
+        if (!instance) continue;
+
+        // Clear the flag first so that a request posted during the update is not lost.
+        instance->isUpdateRequested_ = false;
+
+        // Skip instances destroyed after posting the request.
+        if (allInstances_.find(instance.get()) == allInstances_.end()) continue;
+
+        UpdateInstance(instance, now, timeouts);
+    }
+}
+
+
+void WindowsGraphicsCaptureManager::CheckRunningInstances(INT64 now, const CaptureSessionTimeouts& timeouts)
+{
+    std::scoped_lock lock(instancesMutex_);
+
+    for (auto it = runningInstances_.begin(); it != runningInstances_.end();)
+    {
+        const auto instance = it->second;
+        instance->UpdateState(now, timeouts);
+
+        if (instance->IsStarted())
+        {
+            ++it;
+        }
+        else
+        {
+            it = runningInstances_.erase(it);
+        }
+    }
+}
+
+
+void WindowsGraphicsCaptureManager::EvictWarmInstances(size_t capacity)
+{
+    std::scoped_lock lock(instancesMutex_);
+
+    std::vector<Ptr> instances;
+    for (const auto& [key, instance] : runningInstances_)
+    {
+        instances.push_back(instance);
+    }
+
+    for (const auto& instance : SelectWarmSessionsToEvict(instances, capacity))
+    {
+        instance->Stop();
+        runningInstances_.erase(instance.get());
+    }
+}
+
+
+void WindowsGraphicsCaptureManager::StopAllInstances()
+{
+    std::scoped_lock lock(instancesMutex_);
+
+    for (const auto& [key, instance] : runningInstances_)
+    {
+        instance->Stop();
+    }
+    runningInstances_.clear();
+}
\ No newline at end of file